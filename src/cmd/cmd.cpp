@@ -15,6 +15,7 @@
  */
 
 #include "account.h"
+#include "cmddaemon.h"
 #include "common/syncjournaldb.h"
 #include "common/version.h"
 #include "configfile.h" // ONLY ACCESS THE STATIC FUNCTIONS!
@@ -65,6 +66,9 @@ struct CmdOptions
     bool ignoreHiddenFiles = true;
     QString exclude;
     QString unsyncedfolders;
+    QString daemonConfig;
+    bool plan = false;
+    bool planItems = false;
     int restartTimes = 3;
     int downlimit = 0;
     int uplimit = 0;
@@ -106,6 +110,38 @@ void selectiveSyncFixup(OCC::SyncJournalDb *journal, const QStringList &newList)
 }
 
 
+void setupEngine(const SyncCTX &ctx, SyncEngine *engine)
+{
+    SyncOptions opt { QSharedPointer<Vfs>(createVfsFromPlugin(Vfs::Off).release()) };
+    opt.fillFromEnvironmentVariables();
+    opt.verifyChunkSizes();
+    engine->setSyncOptions(opt);
+
+    QObject::connect(engine, &SyncEngine::syncError, engine,
+        [](const QString &error) { qWarning() << "Sync error:" << error; });
+    engine->setIgnoreHiddenFiles(ctx.options.ignoreHiddenFiles);
+    engine->setNetworkLimits(ctx.options.uplimit, ctx.options.downlimit);
+
+
+    // Exclude lists
+
+    bool hasUserExcludeFile = !ctx.options.exclude.isEmpty();
+    QString systemExcludeFile = ConfigFile::excludeFileFromSystem();
+
+    // Always try to load the user-provided exclude list if one is specified
+    if (hasUserExcludeFile) {
+        engine->excludedFiles().addExcludeFilePath(ctx.options.exclude);
+    }
+    // Load the system list if available, or if there's no user-provided list
+    if (!hasUserExcludeFile || QFile::exists(systemExcludeFile)) {
+        engine->excludedFiles().addExcludeFilePath(systemExcludeFile);
+    }
+
+    if (!engine->excludedFiles().reloadExcludeFiles()) {
+        qFatal("Cannot load system exclude list or list supplied via --exclude");
+    }
+}
+
 void sync(const SyncCTX &ctx)
 {
     QStringList selectiveSyncList;
@@ -131,14 +167,25 @@ void sync(const SyncCTX &ctx)
         selectiveSyncFixup(db, selectiveSyncList);
     }
 
-    SyncOptions opt { QSharedPointer<Vfs>(createVfsFromPlugin(Vfs::Off).release()) };
-    opt.fillFromEnvironmentVariables();
-    opt.verifyChunkSizes();
     auto engine = new SyncEngine(
         ctx.account, ctx.options.target_url, ctx.options.source_dir, ctx.options.remoteFolder, db);
-    engine->setSyncOptions(opt);
+    setupEngine(ctx, engine);
     engine->setParent(db);
 
+    if (ctx.options.plan) {
+        engine->setPlanOnly(true);
+        QObject::connect(engine, &SyncEngine::syncPlanReady, engine, [ctx](const SyncPlan &plan, const SyncFileItemSet &items) {
+            if (ctx.options.planItems) {
+                for (const auto &item : items) {
+                    if (SyncPlan::isPlanned(*item)) {
+                        std::cout << SyncPlan::itemToJson(*item).constData() << '\n';
+                    }
+                }
+            }
+            std::cout << QJsonDocument(plan.toJson()).toJson(QJsonDocument::Compact).constData() << std::endl;
+        });
+    }
+
     QObject::connect(engine, &SyncEngine::finished, engine, [engine, ctx, restartCount = std::make_shared<int>(0)](bool result) {
         if (!result) {
             qWarning() << "Failed to sync";
@@ -192,30 +239,21 @@ void sync(const SyncCTX &ctx)
             }
         }
     });
-    QObject::connect(engine, &SyncEngine::syncError, engine,
-        [](const QString &error) { qWarning() << "Sync error:" << error; });
-    engine->setIgnoreHiddenFiles(ctx.options.ignoreHiddenFiles);
-    engine->setNetworkLimits(ctx.options.uplimit, ctx.options.downlimit);
-
-
-    // Exclude lists
-
-    bool hasUserExcludeFile = !ctx.options.exclude.isEmpty();
-    QString systemExcludeFile = ConfigFile::excludeFileFromSystem();
+    engine->startSync();
+}
 
-    // Always try to load the user-provided exclude list if one is specified
-    if (hasUserExcludeFile) {
-        engine->excludedFiles().addExcludeFilePath(ctx.options.exclude);
-    }
-    // Load the system list if available, or if there's no user-provided list
-    if (!hasUserExcludeFile || QFile::exists(systemExcludeFile)) {
-        engine->excludedFiles().addExcludeFilePath(systemExcludeFile);
+void startDaemon(const SyncCTX &ctx)
+{
+    const auto loaded = CmdDaemon::loadSettings(ctx.options.daemonConfig);
+    if (!loaded) {
+        qFatal("%s", qPrintable(loaded.error()));
     }
-
-    if (!engine->excludedFiles().reloadExcludeFiles()) {
-        qFatal("Cannot load system exclude list or list supplied via --exclude");
+    auto settings = *loaded;
+    settings.maxFollowUpSyncs = ctx.options.restartTimes;
+    auto daemon = new CmdDaemon(ctx.account, ctx.options.target_url, settings, [ctx](SyncEngine *engine) { setupEngine(ctx, engine); }, qApp);
+    if (!daemon->start()) {
+        qApp->exit(EXIT_FAILURE);
     }
-    engine->startSync();
 }
 
 void setupCredentials(SyncCTX &ctx)
@@ -333,6 +371,9 @@ CmdOptions parseOptions(const QStringList &app_args)
     auto downloadLimitption = addOption({ { QStringLiteral("downlimit") }, QStringLiteral("Limit the download speed of files to n KB/s"), QStringLiteral("n") });
     auto syncHiddenFilesOption = addOption({ { QStringLiteral("sync-hidden-files") }, QStringLiteral("Enables synchronization of hidden files") });
 
+    auto planOption = addOption({ { QStringLiteral("plan") }, QStringLiteral("Don't sync, print a JSON summary of what the sync would do") });
+    auto planItemsOption = addOption({ { QStringLiteral("plan-items") }, QStringLiteral("With --plan, print a JSON line for every planned item before the summary") });
+    auto daemonOption = addOption({ { QStringLiteral("daemon") }, QStringLiteral("Keep the folders listed in [config] in sync until terminated, source_dir is omitted"), QStringLiteral("config") });
     auto logdebugOption = addOption({ { QStringLiteral("logdebug") }, QStringLiteral("More verbose logging") });
 
     parser.addHelpOption();
@@ -346,26 +387,33 @@ CmdOptions parseOptions(const QStringList &app_args)
 
 
     const QStringList args = parser.positionalArguments();
-    if (args.size() < 2 || args.size() > 3) {
-        parser.showHelp();
-        exit(1);
-    }
-
-    options.source_dir = [arg = args[0]] {
-        QFileInfo fi(arg);
-        if (!fi.exists()) {
-            std::cerr << "Source dir '" << qPrintable(arg) << "' does not exist." << std::endl;
+    if (parser.isSet(daemonOption)) {
+        if (args.size() != 1) {
+            parser.showHelp();
             exit(1);
         }
-        QString sourceDir = fi.absoluteFilePath();
-        if (!sourceDir.endsWith(QLatin1Char('/'))) {
-            sourceDir.append(QLatin1Char('/'));
+        options.daemonConfig = parser.value(daemonOption);
+        options.target_url = QUrl::fromUserInput(args[0]);
+    } else if (args.size() < 2 || args.size() > 3) {
+        parser.showHelp();
+        exit(1);
+    } else {
+        options.source_dir = [arg = args[0]] {
+            QFileInfo fi(arg);
+            if (!fi.exists()) {
+                std::cerr << "Source dir '" << qPrintable(arg) << "' does not exist." << std::endl;
+                exit(1);
+            }
+            QString sourceDir = fi.absoluteFilePath();
+            if (!sourceDir.endsWith(QLatin1Char('/'))) {
+                sourceDir.append(QLatin1Char('/'));
+            }
+            return sourceDir;
+        }();
+        options.target_url = QUrl::fromUserInput(args[1]);
+        if (args.size() == 3) {
+            options.remoteFolder = args[2];
         }
-        return sourceDir;
-    }();
-    options.target_url = QUrl::fromUserInput(args[1]);
-    if (args.size() == 3) {
-        options.remoteFolder = args[2];
     }
 
     if (parser.isSet(httpproxyOption)) {
@@ -410,6 +458,10 @@ CmdOptions parseOptions(const QStringList &app_args)
     if (parser.isSet(syncHiddenFilesOption)) {
         options.ignoreHiddenFiles = false;
     }
+    if (parser.isSet(planOption)) {
+        options.plan = true;
+        options.planItems = parser.isSet(planItemsOption);
+    }
     if (parser.isSet(logdebugOption)) {
         Logger::instance()->setLogFile(QStringLiteral("-"));
         Logger::instance()->setLogDebug(true);
@@ -499,6 +551,10 @@ int main(int argc, char **argv)
                     ctx.account->setDavUser(data.value(QStringLiteral("id")).toString());
                     ctx.account->setDavDisplayName(data.value(QStringLiteral("display-name")).toString());
 
+                    if (!ctx.options.daemonConfig.isEmpty()) {
+                        startDaemon(ctx);
+                        return;
+                    }
                     // much lower age than the default since this utility is usually made to be run right after a change in the tests
                     SyncEngine::minimumFileAgeForUpload = std::chrono::milliseconds(0);
                     sync(ctx);
@@ -0,0 +1,496 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "cmddaemon.h"
+
+#include "account.h"
+#include "common/asserts.h"
+#include "common/syncjournaldb.h"
+#include "networkjobs.h"
+#include "syncengine.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QLoggingCategory>
+#include <QPointer>
+
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+namespace {
+Q_LOGGING_CATEGORY(lcCmdDaemon, "cmd.daemon", QtInfoMsg)
+
+// Local changes are collected for this long before they are processed
+constexpr auto changeCollectionDelay = 1s;
+
+// Longer lines received on the status socket are not a command
+constexpr qint64 maxCommandSize = 1024;
+
+bool isJournalFile(const QString &name)
+{
+    return name.startsWith(QLatin1String(".sync_")) && name.contains(QLatin1String(".db"));
+}
+
+quint64 entryHash(const QFileInfo &info)
+{
+    const quint64 nameHash = qHash(info.fileName());
+    const quint64 stateHash = qHash(qMakePair(info.lastModified().toMSecsSinceEpoch(), info.isDir() ? -1 : info.size()));
+    return (nameHash << 32) | stateHash;
+}
+}
+
+namespace OCC {
+
+struct CmdDaemon::Folder
+{
+    FolderDefinition definition;
+    QString localPath; // absolute, with a trailing slash
+    // the engine must be destroyed before the journal
+    std::unique_ptr<SyncJournalDb> journal;
+    std::unique_ptr<SyncEngine> engine;
+
+    bool queued = false;
+    QString queueReason;
+    int followUpSyncs = 0;
+    std::set<QString> changedPaths;
+    // paths that were changed by the running sync
+    QSet<QString> syncedPaths;
+    QDateTime lastFullLocalDiscovery;
+    QString lastEtag;
+    QPointer<RequestEtagJob> etagJob;
+
+    // statistics
+    qint64 syncCount = 0;
+    qint64 failedSyncCount = 0;
+    qint64 syncedItems = 0;
+    qint64 failedItems = 0;
+    QDateTime lastSyncStart;
+    qint64 lastSyncDuration = 0;
+    bool lastSyncSuccess = false;
+    QString lastError;
+};
+
+Result<CmdDaemon::Settings, QString> CmdDaemon::loadSettings(const QString &configFile)
+{
+    QFile file(configFile);
+    if (!file.open(QFile::ReadOnly)) {
+        return QStringLiteral("Could not open %1: %2").arg(configFile, file.errorString());
+    }
+    QJsonParseError error;
+    const auto doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        return QStringLiteral("Could not parse %1: %2").arg(configFile, error.errorString());
+    }
+    const auto obj = doc.object();
+
+    Settings settings;
+    settings.pollInterval = std::chrono::seconds(obj.value(QStringLiteral("pollInterval")).toInt(settings.pollInterval.count()));
+    settings.fullLocalDiscoveryInterval = std::chrono::seconds(
+        obj.value(QStringLiteral("fullLocalDiscoveryInterval")).toInt(settings.fullLocalDiscoveryInterval.count()));
+    settings.socketName = obj.value(QStringLiteral("socket")).toString();
+    for (const auto &value : obj.value(QStringLiteral("folders")).toArray()) {
+        const auto folder = value.toObject();
+        FolderDefinition definition;
+        const QFileInfo info(folder.value(QStringLiteral("localPath")).toString());
+        if (!info.isDir()) {
+            return QStringLiteral("Local folder '%1' does not exist").arg(info.filePath());
+        }
+        definition.localPath = info.absoluteFilePath();
+        definition.remotePath = folder.value(QStringLiteral("remotePath")).toString();
+        if (!definition.remotePath.startsWith(QLatin1Char('/'))) {
+            definition.remotePath.prepend(QLatin1Char('/'));
+        }
+        settings.folders.append(definition);
+    }
+    if (settings.folders.isEmpty()) {
+        return QStringLiteral("No folders configured in %1").arg(configFile);
+    }
+    return settings;
+}
+
+CmdDaemon::CmdDaemon(AccountPtr account, const QUrl &davUrl, const Settings &settings, const EngineSetup &setupEngine, QObject *parent)
+    : QObject(parent)
+    , _account(account)
+    , _davUrl(davUrl)
+    , _settings(settings)
+    , _setupEngine(setupEngine)
+{
+    _changeTimer.setSingleShot(true);
+    _changeTimer.setInterval(changeCollectionDelay);
+    connect(&_changeTimer, &QTimer::timeout, this, &CmdDaemon::processChangedDirectories);
+    connect(&_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path) {
+        _changedDirectories.insert(path);
+        if (!_changeTimer.isActive()) {
+            _changeTimer.start();
+        }
+    });
+
+    _pollTimer.setInterval(_settings.pollInterval);
+    connect(&_pollTimer, &QTimer::timeout, this, &CmdDaemon::pollEtags);
+}
+
+CmdDaemon::~CmdDaemon()
+{
+    for (const auto &folder : _folders) {
+        if (folder->engine->isSyncRunning()) {
+            folder->engine->abort();
+        }
+    }
+}
+
+bool CmdDaemon::start()
+{
+    _startTime = QDateTime::currentDateTimeUtc();
+
+    for (const auto &definition : qAsConst(_settings.folders)) {
+        auto folder = std::make_unique<Folder>();
+        folder->definition = definition;
+        folder->localPath = definition.localPath;
+        if (!folder->localPath.endsWith(QLatin1Char('/'))) {
+            folder->localPath.append(QLatin1Char('/'));
+        }
+        folder->journal.reset(new SyncJournalDb(folder->localPath + SyncJournalDb::makeDbName(folder->localPath)));
+        folder->engine.reset(new SyncEngine(_account, _davUrl, folder->localPath, definition.remotePath, folder->journal.get()));
+        _setupEngine(folder->engine.get());
+
+        auto *f = folder.get();
+        connect(folder->engine.get(), &SyncEngine::finished, this, [this, f](bool success) { slotSyncFinished(f, success); });
+        connect(folder->engine.get(), &SyncEngine::syncError, this, [f](const QString &error) { f->lastError = error; });
+        connect(folder->engine.get(), &SyncEngine::rootEtag, this, [f](const QString &etag) { f->lastEtag = etag; });
+        connect(folder->engine.get(), &SyncEngine::itemCompleted, this, [f](const SyncFileItemPtr &item) {
+            if (item->hasErrorStatus()) {
+                ++f->failedItems;
+            } else if (item->_instruction != CSYNC_INSTRUCTION_NONE) {
+                ++f->syncedItems;
+            }
+            f->syncedPaths.insert(item->_file);
+            f->syncedPaths.insert(item->destination());
+        });
+        connect(folder->engine.get(), &SyncEngine::aboutToRemoveAllFiles, this, [f](SyncFileItem::Direction, const std::function<void(bool)> &abort) {
+            // nobody can confirm this, keep the files
+            qCWarning(lcCmdDaemon) << "All files of" << f->localPath << "would be removed, aborting the sync";
+            abort(true);
+        });
+
+        watchTree(f, f->localPath);
+        _folders.push_back(std::move(folder));
+        scheduleSync(f, QStringLiteral("startup"));
+    }
+    qCInfo(lcCmdDaemon) << "Watching" << _directoryEntries.size() << "directories of" << _folders.size() << "folders";
+
+    if (!_settings.socketName.isEmpty()) {
+        _server = new QLocalServer(this);
+        QLocalServer::removeServer(_settings.socketName);
+        if (!_server->listen(_settings.socketName)) {
+            qCCritical(lcCmdDaemon) << "Could not listen on" << _settings.socketName << _server->errorString();
+            return false;
+        }
+        connect(_server, &QLocalServer::newConnection, this, [this] {
+            while (auto *socket = _server->nextPendingConnection()) {
+                handleClient(socket);
+            }
+        });
+    }
+
+    _pollTimer.start();
+    return true;
+}
+
+void CmdDaemon::scheduleSync(Folder *folder, const QString &reason)
+{
+    if (folder->queued) {
+        return;
+    }
+    qCInfo(lcCmdDaemon) << "Scheduling sync of" << folder->localPath << "because of" << reason;
+    folder->queued = true;
+    folder->queueReason = reason;
+    _queue.push_back(folder);
+    QTimer::singleShot(0, this, &CmdDaemon::startNextSync);
+}
+
+void CmdDaemon::startNextSync()
+{
+    if (_currentSync || _queue.empty()) {
+        return;
+    }
+    auto *folder = _queue.front();
+    _queue.pop_front();
+    folder->queued = false;
+    _currentSync = folder;
+
+    const auto now = QDateTime::currentDateTimeUtc();
+    if (!folder->lastFullLocalDiscovery.isValid()
+        || folder->lastFullLocalDiscovery.secsTo(now) >= _settings.fullLocalDiscoveryInterval.count()) {
+        folder->engine->setLocalDiscoveryOptions(LocalDiscoveryStyle::FilesystemOnly);
+        folder->lastFullLocalDiscovery = now;
+    } else {
+        folder->engine->setLocalDiscoveryOptions(LocalDiscoveryStyle::DatabaseAndFilesystem, std::move(folder->changedPaths));
+    }
+    folder->changedPaths.clear();
+    folder->syncedPaths.clear();
+    folder->lastError.clear();
+    folder->lastSyncStart = now;
+    qCInfo(lcCmdDaemon) << "Starting sync of" << folder->localPath << "because of" << folder->queueReason;
+    folder->engine->startSync();
+}
+
+void CmdDaemon::slotSyncFinished(Folder *folder, bool success)
+{
+    OC_ASSERT(folder == _currentSync);
+    _currentSync = nullptr;
+
+    ++folder->syncCount;
+    folder->lastSyncDuration = folder->lastSyncStart.msecsTo(QDateTime::currentDateTimeUtc());
+    folder->lastSyncSuccess = success;
+    if (!success) {
+        ++folder->failedSyncCount;
+    }
+    qCInfo(lcCmdDaemon) << "Sync of" << folder->localPath << (success ? "succeeded" : "failed") << "after" << folder->lastSyncDuration << "ms";
+
+    // the changes the sync made itself
+    processChangedDirectories();
+    folder->syncedPaths.clear();
+
+    if (success && folder->engine->isAnotherSyncNeeded() != NoFollowUpSync) {
+        if (folder->followUpSyncs < _settings.maxFollowUpSyncs) {
+            ++folder->followUpSyncs;
+            scheduleSync(folder, QStringLiteral("follow-up sync"));
+        } else {
+            qCWarning(lcCmdDaemon) << "Another sync is needed, but not done because restart count is exceeded" << folder->followUpSyncs;
+        }
+    } else {
+        folder->followUpSyncs = 0;
+    }
+    startNextSync();
+}
+
+void CmdDaemon::pollEtags()
+{
+    for (const auto &folder : _folders) {
+        if (folder->queued || folder.get() == _currentSync || folder->etagJob) {
+            continue;
+        }
+        auto *f = folder.get();
+        f->etagJob = new RequestEtagJob(_account, _davUrl, f->definition.remotePath, this);
+        f->etagJob->setTimeout(60s);
+        connect(f->etagJob.data(), &RequestEtagJob::finishedSignal, this, [this, f] {
+            if (f->etagJob->httpStatusCode() == 207 && f->etagJob->etag() != f->lastEtag) {
+                f->lastEtag = f->etagJob->etag();
+                scheduleSync(f, QStringLiteral("remote change"));
+            }
+        });
+        f->etagJob->start();
+    }
+}
+
+CmdDaemon::Folder *CmdDaemon::folderForPath(const QString &path) const
+{
+    for (const auto &folder : _folders) {
+        if (path.startsWith(folder->localPath) || path + QLatin1Char('/') == folder->localPath) {
+            return folder.get();
+        }
+    }
+    return nullptr;
+}
+
+QString CmdDaemon::relativePath(const Folder *folder, const QString &path)
+{
+    return path.size() < folder->localPath.size() ? QString() : path.mid(folder->localPath.size());
+}
+
+void CmdDaemon::watchTree(Folder *folder, const QString &directory)
+{
+    scanDirectory(folder, directory, false);
+}
+
+std::set<QString> CmdDaemon::scanDirectory(Folder *folder, const QString &directory, bool reportChanges)
+{
+    std::set<QString> changes;
+    QString dirPath = directory;
+    if (dirPath.endsWith(QLatin1Char('/')) && dirPath.size() > 1) {
+        dirPath.chop(1);
+    }
+    const QString relativeDir = relativePath(folder, dirPath);
+    // a copy, the recursion inserts into _directoryEntries
+    const bool isNew = !_directoryEntries.contains(dirPath);
+    const QVector<quint64> known = _directoryEntries.value(dirPath);
+    if (isNew && !_watcher.addPath(dirPath)) {
+        qCWarning(lcCmdDaemon) << "Could not watch" << dirPath << ", changes in it are only found by the full local discovery";
+    }
+
+    QVector<quint64> entries;
+    QDirIterator it(dirPath, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    while (it.hasNext()) {
+        it.next();
+        const auto info = it.fileInfo();
+        if (isJournalFile(info.fileName())) {
+            continue;
+        }
+        const auto hash = entryHash(info);
+        entries.append(hash);
+        const QString path = relativeDir.isEmpty() ? info.fileName() : relativeDir + QLatin1Char('/') + info.fileName();
+        if (info.isDir() && !info.isSymLink() && !_directoryEntries.contains(info.filePath())) {
+            scanDirectory(folder, info.filePath(), false);
+        }
+        if (reportChanges && (isNew || !std::binary_search(known.cbegin(), known.cend(), hash)) && !folder->syncedPaths.contains(path)) {
+            changes.insert(path);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    if (reportChanges && !isNew) {
+        // Removed entries can only be found by discovering the directory
+        const bool hasRemovedEntries = std::any_of(known.cbegin(), known.cend(), [&entries](quint64 hash) {
+            return !std::binary_search(entries.cbegin(), entries.cend(), hash);
+        });
+        if (hasRemovedEntries && !std::any_of(folder->syncedPaths.cbegin(), folder->syncedPaths.cend(), [&relativeDir](const QString &path) {
+                return path.startsWith(relativeDir) && path.lastIndexOf(QLatin1Char('/')) == (relativeDir.isEmpty() ? -1 : relativeDir.size());
+            })) {
+            changes.insert(relativeDir);
+        }
+    }
+    _directoryEntries.insert(dirPath, entries);
+    return changes;
+}
+
+void CmdDaemon::processChangedDirectories()
+{
+    const auto changed = std::move(_changedDirectories);
+    _changedDirectories.clear();
+    for (const auto &directory : changed) {
+        auto *folder = folderForPath(directory);
+        if (!folder) {
+            continue;
+        }
+        if (folder == _currentSync) {
+            // processed once the sync is done, to tell its own changes apart
+            _changedDirectories.insert(directory);
+            continue;
+        }
+        std::set<QString> changes;
+        if (!QFileInfo(directory).isDir()) {
+            // the watches of the removed directories are gone
+            const QString prefix = directory + QLatin1Char('/');
+            for (auto it = _directoryEntries.begin(); it != _directoryEntries.end();) {
+                if (it.key() == directory || it.key().startsWith(prefix)) {
+                    it = _directoryEntries.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            changes.insert(relativePath(folder, directory));
+        } else {
+            changes = scanDirectory(folder, directory, true);
+        }
+        if (!changes.empty()) {
+            folder->changedPaths.insert(changes.cbegin(), changes.cend());
+            scheduleSync(folder, QStringLiteral("local change"));
+        }
+    }
+}
+
+void CmdDaemon::handleClient(QLocalSocket *socket)
+{
+    connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    connect(socket, &QLocalSocket::readyRead, this, [this, socket] {
+        // a command can arrive in several parts, only answer complete lines
+        if (!socket->canReadLine()) {
+            if (socket->bytesAvailable() > maxCommandSize) {
+                qCWarning(lcCmdDaemon) << "Dropping a client that sent" << socket->bytesAvailable() << "bytes without a command";
+                socket->disconnectFromServer();
+            }
+            return;
+        }
+        while (socket->canReadLine()) {
+            const auto command = socket->readLine().trimmed();
+            if (command == "status") {
+                socket->write(status());
+            } else if (command == "metrics") {
+                socket->write(metrics());
+            } else {
+                socket->write("unknown command, use status or metrics\n");
+            }
+        }
+        socket->disconnectFromServer();
+    });
+}
+
+QByteArray CmdDaemon::status() const
+{
+    QJsonArray folders;
+    for (const auto &folder : _folders) {
+        QString state = QStringLiteral("idle");
+        if (folder.get() == _currentSync) {
+            state = QStringLiteral("syncing");
+        } else if (folder->queued) {
+            state = QStringLiteral("queued");
+        }
+        folders.append(QJsonObject {
+            { QStringLiteral("localPath"), folder->definition.localPath },
+            { QStringLiteral("remotePath"), folder->definition.remotePath },
+            { QStringLiteral("state"), state },
+            { QStringLiteral("syncCount"), folder->syncCount },
+            { QStringLiteral("failedSyncCount"), folder->failedSyncCount },
+            { QStringLiteral("syncedItems"), folder->syncedItems },
+            { QStringLiteral("failedItems"), folder->failedItems },
+            { QStringLiteral("lastSyncStart"), folder->lastSyncStart.toString(Qt::ISODate) },
+            { QStringLiteral("lastSyncDuration"), folder->lastSyncDuration },
+            { QStringLiteral("lastSyncSuccess"), folder->lastSyncSuccess },
+            { QStringLiteral("lastError"), folder->lastError },
+        });
+    }
+    const QJsonObject status {
+        { QStringLiteral("startTime"), _startTime.toString(Qt::ISODate) },
+        { QStringLiteral("watchedDirectories"), _directoryEntries.size() },
+        { QStringLiteral("folders"), folders },
+    };
+    return QJsonDocument(status).toJson();
+}
+
+QByteArray CmdDaemon::metrics() const
+{
+    QByteArray out;
+    const auto add = [&out](const char *name, const QString &folder, qint64 value) {
+        out += name;
+        if (!folder.isEmpty()) {
+            out += "{folder=\"" + folder.toUtf8().replace('\\', "\\\\").replace('"', "\\\"") + "\"}";
+        }
+        out += ' ' + QByteArray::number(value) + '\n';
+    };
+    for (const auto &folder : _folders) {
+        const auto &path = folder->definition.localPath;
+        add("owncloudcmd_syncs_total", path, folder->syncCount);
+        add("owncloudcmd_failed_syncs_total", path, folder->failedSyncCount);
+        add("owncloudcmd_synced_items_total", path, folder->syncedItems);
+        add("owncloudcmd_failed_items_total", path, folder->failedItems);
+        add("owncloudcmd_last_sync_duration_milliseconds", path, folder->lastSyncDuration);
+        add("owncloudcmd_last_sync_success", path, folder->lastSyncSuccess ? 1 : 0);
+    }
+    add("owncloudcmd_queued_syncs", {}, _queue.size());
+    add("owncloudcmd_request_retries_total", {}, _account->jobQueue()->retries());
+    add("owncloudcmd_denied_request_retries_total", {}, _account->jobQueue()->deniedRetries());
+    add("owncloudcmd_coalesced_requests_total", {}, _account->jobQueue()->coalescedRequests());
+    add("owncloudcmd_watched_directories", {}, _directoryEntries.size());
+    add("owncloudcmd_uptime_seconds", {}, _startTime.secsTo(QDateTime::currentDateTimeUtc()));
+    return out;
+}
+
+} // namespace OCC
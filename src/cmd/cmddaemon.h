@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "accountfwd.h"
+#include "common/result.h"
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <set>
+#include <vector>
+
+class QLocalServer;
+class QLocalSocket;
+
+namespace OCC {
+
+class SyncEngine;
+
+/**
+ * @brief Keeps several folders of one account in sync until it is terminated
+ *
+ * Used by owncloudcmd --daemon. The account, its connections and the
+ * journals of all folders stay open between syncs.
+ *
+ * A folder is synced
+ * - once at startup
+ * - after local changes, reported by a QFileSystemWatcher on all its
+ *   directories. Only the changed entries are discovered locally, with a
+ *   full local discovery after fullLocalDiscoveryInterval
+ * - when the etag of its remote folder changed, polled every pollInterval
+ * - when the previous sync asked for another one
+ *
+ * Only one folder is synced at a time.
+ *
+ * If a socket name is configured, status and metrics are served on a
+ * QLocalServer. A client sends "status" or "metrics" followed by a
+ * newline and receives a JSON document or metrics in the Prometheus text
+ * format. The connection is closed once the line is answered.
+ */
+class CmdDaemon : public QObject
+{
+    Q_OBJECT
+public:
+    struct FolderDefinition
+    {
+        QString localPath;
+        QString remotePath;
+    };
+
+    struct Settings
+    {
+        QVector<FolderDefinition> folders;
+        std::chrono::seconds pollInterval = std::chrono::seconds(30);
+        std::chrono::seconds fullLocalDiscoveryInterval = std::chrono::hours(1);
+        QString socketName;
+        int maxFollowUpSyncs = 3;
+    };
+
+    /** Reads the settings from a JSON file
+     *
+     * {
+     *     "folders": [ { "localPath": "/srv/data", "remotePath": "/data" } ],
+     *     "pollInterval": 30,
+     *     "fullLocalDiscoveryInterval": 3600,
+     *     "socket": "/run/owncloudcmd.sock"
+     * }
+     */
+    static Result<Settings, QString> loadSettings(const QString &configFile);
+
+    /// Applies the command line options to a new engine
+    using EngineSetup = std::function<void(SyncEngine *)>;
+
+    CmdDaemon(AccountPtr account, const QUrl &davUrl, const Settings &settings, const EngineSetup &setupEngine, QObject *parent = nullptr);
+    ~CmdDaemon() override;
+
+    /** Opens the journals and starts the first syncs, returns false on errors */
+    bool start();
+
+private:
+    struct Folder;
+
+    void scheduleSync(Folder *folder, const QString &reason);
+    void startNextSync();
+    void slotSyncFinished(Folder *folder, bool success);
+    void pollEtags();
+
+    Folder *folderForPath(const QString &path) const;
+    static QString relativePath(const Folder *folder, const QString &path);
+    void watchTree(Folder *folder, const QString &directory);
+    /// Lists the directory and returns the relative paths of the entries that changed since the last time
+    std::set<QString> scanDirectory(Folder *folder, const QString &directory, bool reportChanges);
+    void processChangedDirectories();
+
+    void handleClient(QLocalSocket *socket);
+    QByteArray status() const;
+    QByteArray metrics() const;
+
+    AccountPtr _account;
+    QUrl _davUrl;
+    Settings _settings;
+    EngineSetup _setupEngine;
+
+    std::vector<std::unique_ptr<Folder>> _folders;
+    std::deque<Folder *> _queue;
+    Folder *_currentSync = nullptr;
+
+    QFileSystemWatcher _watcher;
+    /// Sorted hashes of the entries of every watched directory
+    QHash<QString, QVector<quint64>> _directoryEntries;
+    QSet<QString> _changedDirectories;
+    QTimer _changeTimer;
+    QTimer _pollTimer;
+
+    QLocalServer *_server = nullptr;
+    QDateTime _startTime;
+};
+
+} // namespace OCC
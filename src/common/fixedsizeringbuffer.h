@@ -15,6 +15,7 @@
 
 #include <QtGlobal>
 
+#include <algorithm>
 #include <array>
 #include <functional>
 #include <vector>
@@ -77,9 +78,9 @@ public:
 
     void pop_front()
     {
+        Q_ASSERT(!empty());
         // move the windows without changing the underlying data
         _start++;
-        Q_ASSERT(_start < _end);
         // adjust offset to prevent overflow
         const auto s = size();
         _start %= _data.size();
@@ -89,7 +90,7 @@ public:
     void push_back(TYPE &&data)
     {
         Q_ASSERT(!isFull());
-        _data[convertToIndex(size())] = data;
+        _data[convertToIndex(size())] = std::move(data);
         _end++;
     }
 
@@ -100,24 +101,71 @@ public:
 
     /*
      * Remove items if f returns true
-     * The filtered result is unordered
+     * The remaining items keep their order
      */
     void remove_if(const std::function<bool(const TYPE &)> &f)
     {
-        // filter and sort the data
-        FixedSizeRingBuffer<TYPE> tmp(_data.size());
-        const auto start = convertToIndex(0);
-        for (auto it = begin() + start; it != end(); ++it) {
-            if (!f(*it)) {
-                tmp.push_back(std::move(*it));
+        const auto s = size();
+        size_t write = 0;
+        for (size_t read = 0; read < s; ++read) {
+            auto &value = _data[convertToIndex(read)];
+            if (!f(value)) {
+                if (write != read) {
+                    _data[convertToIndex(write)] = std::move(value);
+                }
+                ++write;
+            }
+        }
+        _end = _start + write;
+    }
+
+    /*
+     * Remove count items starting at index first
+     * Only the shorter side of the window is moved, removing items close to the front is cheap
+     */
+    void erase(size_t first, size_t count)
+    {
+        Q_ASSERT(first + count <= size());
+        if (count == 0) {
+            return;
+        }
+        const auto s = size();
+        const auto tail = s - first - count;
+        if (first < tail) {
+            // move the leading items back and advance the window
+            for (size_t i = first; i > 0; --i) {
+                _data[convertToIndex(i - 1 + count)] = std::move(_data[convertToIndex(i - 1)]);
+            }
+            _start = (_start + count) % _data.size();
+        } else {
+            for (size_t i = first; i < first + tail; ++i) {
+                _data[convertToIndex(i)] = std::move(_data[convertToIndex(i + count)]);
             }
         }
-        for (auto it = begin(); it != begin() + start; ++it) {
-            if (!f(*it)) {
-                tmp.push_back(std::move(*it));
+        _end = _start + s - count;
+    }
+
+    /*
+     * Remove the items at the given ascending indices in a single pass
+     */
+    void erase(const std::vector<size_t> &indices)
+    {
+        if (indices.empty()) {
+            return;
+        }
+        Q_ASSERT(std::is_sorted(indices.cbegin(), indices.cend()));
+        Q_ASSERT(indices.back() < size());
+        const auto s = size();
+        auto next = indices.cbegin();
+        size_t write = *next;
+        for (size_t read = write; read < s; ++read) {
+            if (next != indices.cend() && *next == read) {
+                ++next;
+                continue;
             }
+            _data[convertToIndex(write++)] = std::move(_data[convertToIndex(read)]);
         }
-        *this = std::move(tmp);
+        _end = _start + write;
     }
 
     void reset(std::vector<TYPE> &&data)
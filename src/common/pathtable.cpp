@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#include "pathtable.h"
+
+#include "asserts.h"
+
+#include <QVarLengthArray>
+
+namespace {
+
+template <typename Key, typename T>
+qint64 hashUsage(const QHash<Key, T> &hash)
+{
+    // the bucket array and one node per entry
+    return hash.capacity() * qint64(sizeof(void *)) + hash.size() * qint64(sizeof(QHashNode<Key, T>));
+}
+}
+
+namespace OCC {
+
+PathTable::PathTable()
+{
+    // the root has the empty name and is its own parent
+    _names.append({ QString(), QByteArray() });
+    _nameIds.insert(QString(), 0);
+    _utf8NameIds.insert(QByteArray(), 0);
+    _nodes.append({ root, 0 });
+}
+
+PathTable::Handle PathTable::intern(const QString &path)
+{
+    Handle handle = root;
+    int start = 0;
+    while (start < path.size()) {
+        int end = path.indexOf(QLatin1Char('/'), start);
+        if (end < 0) {
+            end = path.size();
+        }
+        if (end > start) {
+            handle = child(handle, internName(path.mid(start, end - start)));
+        }
+        start = end + 1;
+    }
+    return handle;
+}
+
+PathTable::Handle PathTable::intern(const QByteArray &utf8Path)
+{
+    Handle handle = root;
+    int start = 0;
+    while (start < utf8Path.size()) {
+        int end = utf8Path.indexOf('/', start);
+        if (end < 0) {
+            end = utf8Path.size();
+        }
+        if (end > start) {
+            handle = child(handle, internName(utf8Path.mid(start, end - start)));
+        }
+        start = end + 1;
+    }
+    return handle;
+}
+
+PathTable::Handle PathTable::child(Handle parent, const QString &name)
+{
+    OC_ASSERT(!name.contains(QLatin1Char('/')));
+    return child(parent, internName(name));
+}
+
+PathTable::Handle PathTable::child(Handle parent, const QByteArray &utf8Name)
+{
+    OC_ASSERT(!utf8Name.contains('/'));
+    return child(parent, internName(utf8Name));
+}
+
+PathTable::Handle PathTable::find(const QString &path) const
+{
+    Handle handle = root;
+    int start = 0;
+    while (start < path.size()) {
+        int end = path.indexOf(QLatin1Char('/'), start);
+        if (end < 0) {
+            end = path.size();
+        }
+        if (end > start) {
+            const auto nameIt = _nameIds.constFind(path.mid(start, end - start));
+            if (nameIt == _nameIds.cend()) {
+                return invalid;
+            }
+            const auto childIt = _children.constFind(childKey(handle, *nameIt));
+            if (childIt == _children.cend()) {
+                return invalid;
+            }
+            handle = *childIt;
+        }
+        start = end + 1;
+    }
+    return handle;
+}
+
+QString PathTable::path(Handle handle) const
+{
+    QVarLengthArray<Handle, 32> components;
+    int length = 0;
+    for (; handle != root; handle = parent(handle)) {
+        components.append(handle);
+        length += name(handle).size() + 1;
+    }
+    QString out;
+    out.reserve(qMax(0, length - 1));
+    for (auto it = components.crbegin(); it != components.crend(); ++it) {
+        if (!out.isEmpty()) {
+            out.append(QLatin1Char('/'));
+        }
+        out.append(name(*it));
+    }
+    return out;
+}
+
+QByteArray PathTable::pathUtf8(Handle handle) const
+{
+    QVarLengthArray<Handle, 32> components;
+    int length = 0;
+    for (; handle != root; handle = parent(handle)) {
+        components.append(handle);
+        length += nameUtf8(handle).size() + 1;
+    }
+    QByteArray out;
+    out.reserve(qMax(0, length - 1));
+    for (auto it = components.crbegin(); it != components.crend(); ++it) {
+        if (!out.isEmpty()) {
+            out.append('/');
+        }
+        out.append(nameUtf8(*it));
+    }
+    return out;
+}
+
+bool PathTable::isBelow(Handle handle, Handle ancestor) const
+{
+    while (handle != root) {
+        handle = parent(handle);
+        if (handle == ancestor) {
+            return true;
+        }
+    }
+    return false;
+}
+
+qint64 PathTable::memoryUsage() const
+{
+    qint64 usage = _nodes.capacity() * qint64(sizeof(Node)) + _names.capacity() * qint64(sizeof(Name));
+    // the keys of the name ids share the data of the names
+    for (const auto &n : _names) {
+        usage += qint64(sizeof(QArrayData)) * 2 + (n.name.capacity() + 1) * qint64(sizeof(QChar)) + n.utf8.capacity() + 1;
+    }
+    usage += hashUsage(_nameIds);
+    usage += hashUsage(_utf8NameIds);
+    usage += hashUsage(_children);
+    return usage;
+}
+
+quint32 PathTable::internName(const QString &name)
+{
+    auto it = _nameIds.constFind(name);
+    if (it != _nameIds.cend()) {
+        return *it;
+    }
+    const quint32 id = _names.size();
+    const QByteArray utf8 = name.toUtf8();
+    _names.append({ name, utf8 });
+    _nameIds.insert(name, id);
+    _utf8NameIds.insert(utf8, id);
+    return id;
+}
+
+quint32 PathTable::internName(const QByteArray &utf8Name)
+{
+    auto it = _utf8NameIds.constFind(utf8Name);
+    if (it != _utf8NameIds.cend()) {
+        return *it;
+    }
+    const quint32 id = _names.size();
+    const QString name = QString::fromUtf8(utf8Name);
+    // utf8Name might be raw data
+    const QByteArray utf8(utf8Name.constData(), utf8Name.size());
+    _names.append({ name, utf8 });
+    _nameIds.insert(name, id);
+    _utf8NameIds.insert(utf8, id);
+    return id;
+}
+
+PathTable::Handle PathTable::child(Handle parent, quint32 name)
+{
+    const auto key = childKey(parent, name);
+    auto it = _children.constFind(key);
+    if (it != _children.cend()) {
+        return *it;
+    }
+    OC_ENFORCE(_nodes.size() < int(invalid));
+    const Handle handle = _nodes.size();
+    _nodes.append({ parent, name });
+    _children.insert(key, handle);
+    return handle;
+}
+
+} // namespace OCC
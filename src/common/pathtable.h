@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#pragma once
+
+#include "ocsynclib.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include <limits>
+
+namespace OCC {
+
+/**
+ * @brief A table of interned relative paths
+ *
+ * Every path is stored as a node with a pointer to its parent directory and
+ * the id of its name. Paths in the same directory share the parent, equal
+ * names share their storage. A path is referenced by a 32 bit handle.
+ *
+ * Each name is kept as QString and in UTF-8, so the QString paths used
+ * during discovery and propagation and the UTF-8 paths of the journal can
+ * be created from a handle without converting the complete path.
+ *
+ * The root is the empty path, the table only grows and handles stay valid
+ * for its lifetime.
+ */
+class OCSYNC_EXPORT PathTable
+{
+public:
+    using Handle = quint32;
+    static constexpr Handle root = 0;
+    static constexpr Handle invalid = std::numeric_limits<Handle>::max();
+
+    PathTable();
+
+    /** Returns the handle of the path, adding it and its parents if needed */
+    Handle intern(const QString &path);
+    Handle intern(const QByteArray &utf8Path);
+    Handle child(Handle parent, const QString &name);
+    Handle child(Handle parent, const QByteArray &utf8Name);
+
+    /** Returns the handle of an already interned path or invalid */
+    Handle find(const QString &path) const;
+
+    Handle parent(Handle handle) const { return _nodes[handle].parent; }
+    const QString &name(Handle handle) const { return _names[_nodes[handle].name].name; }
+    const QByteArray &nameUtf8(Handle handle) const { return _names[_nodes[handle].name].utf8; }
+
+    QString path(Handle handle) const;
+    QByteArray pathUtf8(Handle handle) const;
+
+    /** Whether handle is below ancestor, a path is not below itself */
+    bool isBelow(Handle handle, Handle ancestor) const;
+
+    /** The number of interned paths, including the root */
+    int size() const { return _nodes.size(); }
+
+    /** The number of distinct names */
+    int nameCount() const { return _names.size(); }
+
+    /** An estimate of the heap memory used by the table, in bytes */
+    qint64 memoryUsage() const;
+
+private:
+    struct Node
+    {
+        Handle parent;
+        quint32 name;
+    };
+    struct Name
+    {
+        QString name;
+        QByteArray utf8;
+    };
+
+    static quint64 childKey(Handle parent, quint32 name) { return (quint64(parent) << 32) | name; }
+    quint32 internName(const QString &name);
+    quint32 internName(const QByteArray &utf8Name);
+    Handle child(Handle parent, quint32 name);
+
+    QVector<Node> _nodes;
+    QVector<Name> _names;
+    QHash<QString, quint32> _nameIds;
+    QHash<QByteArray, quint32> _utf8NameIds;
+    QHash<quint64, Handle> _children;
+};
+
+} // namespace OCC
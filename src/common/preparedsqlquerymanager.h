@@ -62,6 +62,7 @@ public:
         GetFileRecordQuery,
         GetFileRecordQueryByInode,
         GetFileRecordQueryByFileId,
+        GetFileRecordsQueryBySizeAndModTime,
         GetFilesBelowPathQuery,
         GetAllFilesQuery,
         ListFilesInPathQuery,
@@ -85,6 +86,9 @@ public:
         GetDataFingerprintQuery,
         SetDataFingerprintQuery1,
         SetDataFingerprintQuery2,
+        GetSyncTokenQuery,
+        SetSyncTokenQuery1,
+        SetSyncTokenQuery2,
         GetConflictRecordQuery,
         SetConflictRecordQuery,
         DeleteConflictRecordQuery,
@@ -475,6 +475,14 @@ bool SyncJournalDb::checkConnect()
         return sqlFail(QStringLiteral("Create table datafingerprint"), createQuery);
     }
 
+    // create the synctoken table.
+    createQuery.prepare("CREATE TABLE IF NOT EXISTS synctoken("
+                        "token TEXT UNIQUE"
+                        ");");
+    if (!createQuery.exec()) {
+        return sqlFail(QStringLiteral("Create table synctoken"), createQuery);
+    }
+
     // create the flags table.
     createQuery.prepare("CREATE TABLE IF NOT EXISTS flags ("
                         "path TEXT PRIMARY KEY,"
@@ -622,6 +630,8 @@ void SyncJournalDb::close()
     _db.close();
     clearEtagStorageFilter();
     _metadataTableIsEmpty = false;
+    _errorBlacklistPaths.reset();
+    _errorBlacklistQueriesSaved = 0;
     _closed = true;
 }
 
@@ -714,6 +724,16 @@ bool SyncJournalDb::updateMetadataTableStructure()
         commitInternal(QStringLiteral("update database structure: add parent index"));
     }
 
+    if (1) {
+        SqlQuery query(_db);
+        query.prepare("CREATE INDEX IF NOT EXISTS metadata_filesize_modtime ON metadata(filesize, modtime);");
+        if (!query.exec()) {
+            sqlFail(QStringLiteral("updateMetadataTableStructure: create index filesize and modtime"), query);
+            re = false;
+        }
+        commitInternal(QStringLiteral("update database structure: add filesize and modtime index"));
+    }
+
     if (columns.indexOf("ignoredChildrenRemote") == -1) {
         SqlQuery query(_db);
         query.prepare("ALTER TABLE metadata ADD COLUMN ignoredChildrenRemote INT;");
@@ -1084,6 +1104,44 @@ bool SyncJournalDb::getFileRecordsByFileId(const QByteArray &fileId, const std::
     return true;
 }
 
+bool SyncJournalDb::getFileRecordsBySizeAndModTime(qint64 size, qint64 modtime, const std::function<void(const SyncJournalFileRecord &)> &rowCallback)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (_metadataTableIsEmpty)
+        return true; // no error, yet nothing found
+
+    if (!checkConnect())
+        return false;
+
+    const auto query = _queryManager.get(PreparedSqlQueryManager::GetFileRecordsQueryBySizeAndModTime,
+        QByteArrayLiteral(GET_FILE_RECORD_QUERY " WHERE filesize=?1 AND modtime=?2 AND type=?3 AND contentChecksum IS NOT NULL"), _db);
+    if (!query) {
+        return false;
+    }
+
+    query->bindValue(1, size);
+    query->bindValue(2, modtime);
+    query->bindValue(3, ItemTypeFile);
+
+    if (!query->exec())
+        return false;
+
+    forever {
+        auto next = query->next();
+        if (!next.ok)
+            return false;
+        if (!next.hasData)
+            break;
+
+        SyncJournalFileRecord rec;
+        fillFileRecordFromGetQuery(rec, *query);
+        rowCallback(rec);
+    }
+
+    return true;
+}
+
 bool SyncJournalDb::getFilesBelowPath(const QByteArray &path, const std::function<void(const SyncJournalFileRecord&)> &rowCallback)
 {
     QMutexLocker locker(&_mutex);
@@ -1182,6 +1240,18 @@ bool SyncJournalDb::listFilesInPath(const QByteArray& path,
     return true;
 }
 
+bool SyncJournalDb::listFilesInPath(PathTable &paths, PathTable::Handle dir,
+    const std::function<void(PathTable::Handle, const SyncJournalFileRecord &)> &rowCallback)
+{
+    const QByteArray path = paths.pathUtf8(dir);
+    const int nameStart = path.isEmpty() ? 0 : path.size() + 1;
+    return listFilesInPath(path, [&](const SyncJournalFileRecord &rec) {
+        // only copied if the table doesn't know the name yet
+        const auto name = QByteArray::fromRawData(rec._path.constData() + nameStart, rec._path.size() - nameStart);
+        rowCallback(paths.child(dir, name), rec);
+    });
+}
+
 int SyncJournalDb::getFileRecordCount()
 {
     QMutexLocker locker(&_mutex);
@@ -1538,6 +1608,12 @@ QVector<uint> SyncJournalDb::deleteStaleUploadInfos(const QSet<QString> &keep)
     return ids;
 }
 
+/// The key of file in _errorBlacklistPaths, matches the collation of the blacklist lookup
+static QString errorBlacklistKey(const QString &file)
+{
+    return Utility::fsCasePreserving() ? file.toCaseFolded() : file;
+}
+
 SyncJournalErrorBlacklistRecord SyncJournalDb::errorBlacklistEntry(const QString &file)
 {
     QMutexLocker locker(&_mutex);
@@ -1547,6 +1623,22 @@ SyncJournalErrorBlacklistRecord SyncJournalDb::errorBlacklistEntry(const QString
         return entry;
 
     if (checkConnect()) {
+        if (!_errorBlacklistPaths) {
+            SqlQuery pathsQuery("SELECT path FROM blacklist", _db);
+            if (pathsQuery.exec()) {
+                _errorBlacklistPaths.emplace();
+                while (pathsQuery.next().hasData) {
+                    _errorBlacklistPaths->insert(errorBlacklistKey(pathsQuery.stringValue(0)));
+                }
+            } else {
+                sqlFail(QStringLiteral("Read the paths of the blacklist"), pathsQuery);
+            }
+        }
+        if (_errorBlacklistPaths && !_errorBlacklistPaths->contains(errorBlacklistKey(file))) {
+            ++_errorBlacklistQueriesSaved;
+            return entry;
+        }
+
         const auto query = _queryManager.get(PreparedSqlQueryManager::GetErrorBlacklistQuery);
         query->bindValue(1, file);
         if (query->exec()) {
@@ -1569,6 +1661,19 @@ SyncJournalErrorBlacklistRecord SyncJournalDb::errorBlacklistEntry(const QString
     return entry;
 }
 
+qint64 SyncJournalDb::errorBlacklistQueriesSaved()
+{
+    QMutexLocker locker(&_mutex);
+    return _errorBlacklistQueriesSaved;
+}
+
+void SyncJournalDb::clearErrorBlacklistCache()
+{
+    QMutexLocker locker(&_mutex);
+    _errorBlacklistPaths.reset();
+    _errorBlacklistQueriesSaved = 0;
+}
+
 bool SyncJournalDb::deleteStaleErrorBlacklistEntries(const QSet<QString> &keep)
 {
     QMutexLocker locker(&_mutex);
@@ -1638,6 +1743,9 @@ int SyncJournalDb::wipeErrorBlacklist()
             sqlFail(QStringLiteral("Deletion of whole blacklist failed"), query);
             return -1;
         }
+        if (_errorBlacklistPaths) {
+            _errorBlacklistPaths->clear();
+        }
         return query.numRowsAffected();
     }
     return -1;
@@ -1727,7 +1835,9 @@ void SyncJournalDb::setErrorBlacklistEntry(const SyncJournalErrorBlacklistRecord
     query->bindValue(8, item._renameTarget);
     query->bindValue(9, item._errorCategory);
     query->bindValue(10, item._requestId);
-    query->exec();
+    if (query->exec() && _errorBlacklistPaths) {
+        _errorBlacklistPaths->insert(errorBlacklistKey(item._file));
+    }
 }
 
 QStringList SyncJournalDb::getSelectiveSyncList(SyncJournalDb::SelectiveSyncListType type, bool *ok)
@@ -1839,6 +1949,12 @@ void SyncJournalDb::schedulePathForRemoteDiscovery(const QByteArray &fileName)
     query.bindValue(1, argument);
     query.exec();
 
+    // The root folder has no etag we could invalidate, entries directly below
+    // it can only be rediscovered by listing it
+    if (!argument.contains('/')) {
+        deleteSyncTokenLocked();
+    }
+
     // Prevent future overwrite of the etags of this folder and all
     // parent folders for this sync
     argument.append('/');
@@ -1867,6 +1983,7 @@ void SyncJournalDb::forceRemoteDiscoveryNextSyncLocked()
     SqlQuery deleteRemoteFolderEtagsQuery(_db);
     deleteRemoteFolderEtagsQuery.prepare("UPDATE metadata SET md5='_invalid_' WHERE type=2;");
     deleteRemoteFolderEtagsQuery.exec();
+    deleteSyncTokenLocked();
 }
 
 
@@ -1981,6 +2098,57 @@ void SyncJournalDb::setDataFingerprint(const QByteArray &dataFingerprint)
     setDataFingerprintQuery2->exec();
 }
 
+QByteArray SyncJournalDb::syncToken()
+{
+    QMutexLocker locker(&_mutex);
+    if (!checkConnect()) {
+        return QByteArray();
+    }
+
+    const auto query = _queryManager.get(PreparedSqlQueryManager::GetSyncTokenQuery, QByteArrayLiteral("SELECT token FROM synctoken"), _db);
+    if (!query) {
+        return QByteArray();
+    }
+
+    if (!query->exec()) {
+        return QByteArray();
+    }
+
+    if (!query->next().hasData) {
+        return QByteArray();
+    }
+    return query->baValue(0);
+}
+
+void SyncJournalDb::setSyncToken(const QByteArray &syncToken)
+{
+    QMutexLocker locker(&_mutex);
+    if (!checkConnect()) {
+        return;
+    }
+
+    const auto setSyncTokenQuery1 = _queryManager.get(PreparedSqlQueryManager::SetSyncTokenQuery1, QByteArrayLiteral("DELETE FROM synctoken;"), _db);
+    const auto setSyncTokenQuery2 = _queryManager.get(PreparedSqlQueryManager::SetSyncTokenQuery2, QByteArrayLiteral("INSERT INTO synctoken (token) VALUES (?1);"), _db);
+    if (!setSyncTokenQuery1 || !setSyncTokenQuery2) {
+        return;
+    }
+
+    setSyncTokenQuery1->exec();
+
+    if (!syncToken.isEmpty()) {
+        setSyncTokenQuery2->bindValue(1, syncToken);
+        setSyncTokenQuery2->exec();
+    }
+}
+
+void SyncJournalDb::deleteSyncTokenLocked()
+{
+    qCInfo(lcDb) << "Deleting the sync token, the next sync will list the whole remote tree";
+    SqlQuery deleteSyncTokenQuery(_db);
+    deleteSyncTokenQuery.prepare("DELETE FROM synctoken;");
+    deleteSyncTokenQuery.exec();
+}
+
 void SyncJournalDb::setConflictRecord(const ConflictRecord &record)
 {
     QMutexLocker locker(&_mutex);
@@ -23,10 +23,13 @@
 #include <qmutex.h>
 #include <QDateTime>
 #include <QHash>
+#include <QSet>
 #include <functional>
+#include <optional>
 
 #include "common/checksumalgorithms.h"
 #include "common/ownsql.h"
+#include "common/pathtable.h"
 #include "common/pinstate.h"
 #include "common/preparedsqlquerymanager.h"
 #include "common/result.h"
@@ -61,8 +64,16 @@ public:
     bool getFileRecord(const QByteArray &filename, SyncJournalFileRecord *rec);
     bool getFileRecordByInode(quint64 inode, SyncJournalFileRecord *rec);
     bool getFileRecordsByFileId(const QByteArray &fileId, const std::function<void(const SyncJournalFileRecord &)> &rowCallback);
+    /// The files with the given size and mtime that have a content checksum
+    bool getFileRecordsBySizeAndModTime(qint64 size, qint64 modtime, const std::function<void(const SyncJournalFileRecord &)> &rowCallback);
     bool getFilesBelowPath(const QByteArray &path, const std::function<void(const SyncJournalFileRecord&)> &rowCallback);
     bool listFilesInPath(const QByteArray &path, const std::function<void(const SyncJournalFileRecord&)> &rowCallback);
+    /** Like listFilesInPath(), for a directory of a PathTable
+     *
+     * The entries are interned as children of dir and passed with their handle,
+     * their names are only converted from UTF-8 the first time the table sees them.
+     */
+    bool listFilesInPath(PathTable &paths, PathTable::Handle dir, const std::function<void(PathTable::Handle, const SyncJournalFileRecord &)> &rowCallback);
     Result<void, QString> setFileRecord(const SyncJournalFileRecord &record);
 
     bool deleteFileRecord(const QString &filename, bool recursively = false);
@@ -138,6 +149,13 @@ public:
 
     SyncJournalErrorBlacklistRecord errorBlacklistEntry(const QString &);
     bool deleteStaleErrorBlacklistEntries(const QSet<QString> &keep);
+    /// The number of errorBlacklistEntry() calls that were answered without a query since clearErrorBlacklistCache()
+    qint64 errorBlacklistQueriesSaved();
+    /**
+     * Drops the cached paths of the blacklist entries and resets errorBlacklistQueriesSaved().
+     * Done at the start of a sync run, and implicitly on close().
+     */
+    void clearErrorBlacklistCache();
 
     /// Delete flags table entries that have no metadata correspondent
     void deleteStaleFlagsEntries();
@@ -234,6 +252,16 @@ public:
     void setDataFingerprint(const QByteArray &dataFingerprint);
     QByteArray dataFingerprint();
 
+    /**
+     * The server's sync token at the time of the last successful sync
+     *
+     * Used to ask the server for the changes since then instead of
+     * listing the remote tree. An empty token means the next sync
+     * has to list the remote tree.
+     */
+    void setSyncToken(const QByteArray &syncToken);
+    QByteArray syncToken();
+
 
     // Conflict record functions
 
@@ -382,6 +410,9 @@ private:
     // Same as forceRemoteDiscoveryNextSync but without acquiring the lock
     void forceRemoteDiscoveryNextSyncLocked();
 
+    // Forget the sync token, expects the lock to be held
+    void deleteSyncTokenLocked();
+
     // Returns the integer id of the checksum type
     //
     // Returns 0 on failure and for empty checksum types.
@@ -409,6 +440,16 @@ private:
      */
     QList<QByteArray> _etagStorageFilter;
 
+    /* The paths in the blacklist table, used to skip the query for paths without an entry.
+     *
+     * The paths are case folded if the blacklist is checked case insensitively.
+     * Removed entries are kept, so the set may contain paths that are no longer
+     * in the table. It is read on the first lookup and dropped with
+     * clearErrorBlacklistCache() (start of sync run).
+     */
+    std::optional<QSet<QString>> _errorBlacklistPaths;
+    qint64 _errorBlacklistQueriesSaved = 0;
+
     /** The journal mode to use for the db.
      *
      * Typically WAL initially, but may be set to other modes via environment
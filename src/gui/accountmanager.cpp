@@ -13,6 +13,7 @@
  */
 
 #include "accountmanager.h"
+#include "activitystore.h"
 #include "configfile.h"
 #include "creds/credentialmanager.h"
 #include "proxyauthhandler.h"
@@ -80,6 +81,16 @@ auto capabilitesC()
     return QStringLiteral("capabilities");
 }
 
+auto capabilitiesEtagC()
+{
+    return QStringLiteral("capabilitiesEtag");
+}
+
+auto userInfoEtagC()
+{
+    return QStringLiteral("userInfoEtag");
+}
+
 // The maximum versions that this client can read
 static const int maxAccountsVersion = 2;
 static const int maxAccountVersion = 1;
@@ -272,7 +283,9 @@ void AccountManager::saveAccountHelper(Account *acc, QSettings &settings, bool s
     settings.setValue(userUUIDC(), acc->uuid());
     if (acc->hasCapabilities()) {
         settings.setValue(capabilitesC(), acc->capabilities().raw());
+        settings.setValue(capabilitiesEtagC(), acc->_capabilitiesEtag);
     }
+    settings.setValue(userInfoEtagC(), acc->_userInfoEtag);
     if (acc->hasDefaultSyncRoot()) {
         settings.setValue(defaultSyncRootC(), acc->defaultSyncRoot());
     }
@@ -325,6 +338,8 @@ AccountPtr AccountManager::loadAccountHelper(QSettings &settings)
     acc->_displayName = settings.value(davUserDisplyNameC()).toString();
     acc->_uuid = settings.value(userUUIDC(), acc->_uuid).toUuid();
     acc->setCapabilities(settings.value(capabilitesC()).value<QVariantMap>());
+    acc->_capabilitiesEtag = settings.value(capabilitiesEtagC()).toByteArray();
+    acc->_userInfoEtag = settings.value(userInfoEtagC()).toByteArray();
     acc->setDefaultSyncRoot(settings.value(defaultSyncRootC()).toString());
 
     // We want to only restore settings for that auth type and the user value
@@ -391,6 +406,7 @@ void AccountManager::deleteAccount(AccountStatePtr account)
 
     auto settings = ConfigFile::settingsWithGroup(accountsC());
     settings->remove(account->account()->id());
+    ActivityStore::remove(account->account());
 
     emit accountRemoved(account);
 }
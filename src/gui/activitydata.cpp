@@ -13,6 +13,7 @@
  */
 
 #include <QtCore>
+#include <QJsonObject>
 
 #include "activitydata.h"
 
@@ -33,6 +34,30 @@ Activity::Activity(Activity::Type type, qlonglong id, AccountPtr acc, const QStr
 {
 }
 
+Activity Activity::fromJson(const QJsonObject &json, AccountPtr acc)
+{
+    return Activity { Activity::ActivityType,
+        json.value(QStringLiteral("id")).toVariant().value<Activity::Identifier>(),
+        acc,
+        json.value(QStringLiteral("subject")).toString(),
+        json.value(QStringLiteral("message")).toString(),
+        json.value(QStringLiteral("file")).toString(),
+        QUrl(json.value(QStringLiteral("link")).toString()),
+        QDateTime::fromString(json.value(QStringLiteral("date")).toString(), Qt::ISODate) };
+}
+
+QJsonObject Activity::toJson() const
+{
+    return {
+        { QStringLiteral("id"), _id },
+        { QStringLiteral("subject"), _subject },
+        { QStringLiteral("message"), _message },
+        { QStringLiteral("file"), _file },
+        { QStringLiteral("link"), _link.toString() },
+        { QStringLiteral("date"), _dateTime.toString(Qt::ISODate) },
+    };
+}
+
 Activity::Type Activity::type() const
 {
     return _type;
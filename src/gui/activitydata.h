@@ -54,6 +54,15 @@ public:
     Activity() = default;
     explicit Activity(Type type, Identifier id, AccountPtr acc, const QString &subject, const QString &message, const QString &file, const QUrl &link, const QDateTime &dateTime, const QVector<ActivityLink> &&links = {});
 
+    /**
+     * Creates an activity from an entry of the activity API
+     */
+    static Activity fromJson(const QJsonObject &json, AccountPtr acc);
+    /**
+     * The activity in the format of the activity API, links are not included
+     */
+    QJsonObject toJson() const;
+
     Type type() const;
 
     Identifier id() const;
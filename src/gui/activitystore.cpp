@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "activitystore.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcActivityStore, "gui.activity.store", QtInfoMsg)
+
+QString ActivityStore::path(const AccountPtr &account)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/activity/") + account->uuid().toString(QUuid::WithoutBraces) + QStringLiteral(".json");
+}
+
+ActivityList ActivityStore::load(const AccountPtr &account)
+{
+    QFile file(path(account));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QJsonParseError error;
+    const auto doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(lcActivityStore) << "Failed to parse" << file.fileName() << error.errorString();
+        return {};
+    }
+    const auto array = doc.array();
+    ActivityList out;
+    out.reserve(std::min(array.size(), MaxActivities));
+    for (const auto &json : array) {
+        if (out.size() == MaxActivities) {
+            break;
+        }
+        out.append(Activity::fromJson(json.toObject(), account));
+    }
+    qCDebug(lcActivityStore) << "Loaded" << out.size() << "activities of" << account->displayName();
+    return out;
+}
+
+void ActivityStore::save(const AccountPtr &account, const ActivityList &activities)
+{
+    const QString fileName = path(account);
+    if (!QDir().mkpath(QFileInfo(fileName).path())) {
+        qCWarning(lcActivityStore) << "Failed to create the directory of" << fileName;
+        return;
+    }
+    QJsonArray array;
+    for (const auto &activity : activities.mid(0, MaxActivities)) {
+        array.append(activity.toJson());
+    }
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcActivityStore) << "Failed to open" << fileName << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(array).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qCWarning(lcActivityStore) << "Failed to write" << fileName << file.errorString();
+    }
+}
+
+void ActivityStore::remove(const AccountPtr &account)
+{
+    QFile::remove(path(account));
+}
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#pragma once
+
+#include "activitydata.h"
+
+namespace OCC {
+
+/**
+ * @brief Keeps the server activities of the accounts across restarts
+ * @ingroup gui
+ *
+ * The activities of an account are stored as json in a file named after the
+ * account uuid in the cache location. Only the newest MaxActivities are kept.
+ */
+class ActivityStore
+{
+public:
+    static constexpr int MaxActivities = 500;
+
+    /** The stored activities of the account, newest first */
+    static ActivityList load(const AccountPtr &account);
+    /** Replaces the stored activities of the account */
+    static void save(const AccountPtr &account, const ActivityList &activities);
+    /** Removes the stored activities of a deleted account */
+    static void remove(const AccountPtr &account);
+
+private:
+    static QString path(const AccountPtr &account);
+};
+}
@@ -207,6 +207,8 @@ bool Application::configVersionMigration()
         // Wipe confusing keys from the future, ignore the others
         for (const auto &badKey : qAsConst(deleteKeys))
             settings->remove(badKey);
+        settings->sync();
+        ConfigFile::reload();
     }
 
     configFile.setClientVersionString(OCC::Version::version().toString());
@@ -234,75 +234,120 @@ void ConnectionValidator::slotAuthSuccess()
     reportResult(Connected);
 }
 
+namespace {
+    QNetworkRequest conditionalRequest(const QByteArray &etag)
+    {
+        QNetworkRequest request;
+        if (!etag.isEmpty()) {
+            request.setRawHeader(QByteArrayLiteral("If-None-Match"), etag);
+        }
+        return request;
+    }
+}
+
 void ConnectionValidator::checkServerCapabilities()
 {
-    // The main flow now needs the capabilities
-    auto *job = new JsonApiJob(_account, QStringLiteral("ocs/v2.php/cloud/capabilities"), {}, {}, this);
-    job->setAuthenticationJob(true);
-    job->setTimeout(timeoutToUse);
-
-    QObject::connect(job, &JsonApiJob::finishedSignal, this, [job, this] {
-        auto caps = job->data().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toObject().value(QStringLiteral("capabilities")).toObject();
-        qCInfo(lcConnectionValidator) << "Server capabilities" << caps;
-        _account->setCapabilities(caps.toVariantMap());
+    // The capabilities and the user info don't depend on each other, fetch them in parallel.
+    // If both were cached, they only need to be revalidated and we can report the connection right away.
+    const QByteArray capabilitiesEtag = _account->hasCapabilities() ? _account->capabilitiesEtag() : QByteArray();
+    const QByteArray userInfoEtag = _account->userInfoEtag();
+    if (!capabilitiesEtag.isEmpty() && !userInfoEtag.isEmpty()) {
         if (!checkServerInfo()) {
             return;
         }
+        qCInfo(lcConnectionValidator) << "Connected with the cached capabilities after" << _timer.duration();
+        _reportedConnected = true;
+        emit connectionResult(Connected, _errors);
+    }
 
-        fetchUser();
+    _pendingJobs = 2;
+    auto *capabilitiesJob = new JsonApiJob(_account, QStringLiteral("ocs/v2.php/cloud/capabilities"), {}, conditionalRequest(capabilitiesEtag), this);
+    capabilitiesJob->setAuthenticationJob(true);
+    capabilitiesJob->setTimeout(timeoutToUse);
+    QObject::connect(capabilitiesJob, &JsonApiJob::finishedSignal, this, [capabilitiesJob, this] {
+        if (capabilitiesJob->httpStatusCode() == 304) {
+            qCInfo(lcConnectionValidator) << "Server capabilities unchanged";
+        } else if (capabilitiesJob->reply()->error() == QNetworkReply::NoError) {
+            auto caps = capabilitiesJob->data().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toObject().value(QStringLiteral("capabilities")).toObject();
+            qCInfo(lcConnectionValidator) << "Server capabilities" << caps;
+            _account->setCapabilities(caps.toVariantMap());
+            _account->setCapabilitiesEtag(capabilitiesJob->reply()->rawHeader(QByteArrayLiteral("ETag")));
+        }
+        // Record that the server supports HTTP/2
+        // Actual decision if we should use HTTP/2 is done in AccessManager::createRequest
+        _account->setHttp2Supported(capabilitiesJob->reply()->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool());
+        serverInfoJobFinished();
     });
-    job->start();
+    capabilitiesJob->start();
+
+    auto *userJob = new JsonApiJob(_account, QStringLiteral("ocs/v2.php/cloud/user"), {}, conditionalRequest(userInfoEtag), this);
+    userJob->setTimeout(timeoutToUse);
+    userJob->setAuthenticationJob(true);
+    QObject::connect(userJob, &JsonApiJob::finishedSignal, this, [userJob, this] {
+        if (userJob->httpStatusCode() == 304) {
+            qCInfo(lcConnectionValidator) << "User info unchanged";
+        } else if (userJob->reply()->error() == QNetworkReply::NoError) {
+            const auto data = userJob->data().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toObject();
+            const QString user = data.value(QStringLiteral("id")).toString();
+            if (!user.isEmpty()) {
+                _account->setDavUser(user);
+            }
+            const QString displayName = data.value(QStringLiteral("display-name")).toString();
+            if (!displayName.isEmpty()) {
+                _account->setDavDisplayName(displayName);
+            }
+            _account->setUserInfoEtag(user.isEmpty() ? QByteArray() : userJob->reply()->rawHeader(QByteArrayLiteral("ETag")));
+        }
+        serverInfoJobFinished();
+    });
+    userJob->start();
 }
 
-void ConnectionValidator::fetchUser()
+void ConnectionValidator::serverInfoJobFinished()
 {
-    auto *job = new JsonApiJob(_account, QStringLiteral("ocs/v2.php/cloud/user"), {}, {}, this);
-    job->setTimeout(timeoutToUse);
-    job->setAuthenticationJob(true);
-    QObject::connect(job, &JsonApiJob::finishedSignal, this, [job, this] {
-        const QString user = job->data().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toObject().value(QStringLiteral("id")).toString();
-        if (!user.isEmpty()) {
-            _account->setDavUser(user);
-        }
-        const QString displayName = job->data().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toObject().value(QStringLiteral("display-name")).toString();
-        if (!displayName.isEmpty()) {
-            _account->setDavDisplayName(displayName);
-        }
+    if (--_pendingJobs > 0) {
+        return;
+    }
+    if (!checkServerInfo()) {
+        return;
+    }
+    fetchUserDetails();
+}
 
-        auto capabilities = _account->capabilities();
-        // We should have received the capabilities by now. Check that assumption in a debug build. If
-        // it's not the case, the code below will assume that they are not available.
-        Q_ASSERT(capabilities.isValid());
-
-        auto *group = new JobGroup(this);
-        if (capabilities.isValid()) {
-            if (capabilities.avatarsAvailable()) {
-                auto *avatarJob = group->createJob<AvatarJob>(_account, _account->davUser(), 128, this);
-                avatarJob->setAuthenticationJob(true);
-                avatarJob->setTimeout(20s);
-                connect(avatarJob, &AvatarJob::avatarPixmap, this, [this](const QPixmap &img) {
-                    _account->setAvatar(img);
-                });
-                avatarJob->start();
-            }
-            if (capabilities.appProviders().enabled) {
-                auto *jsonJob = group->createJob<JsonJob>(_account, _account->url(), capabilities.appProviders().appsUrl, "GET");
-                connect(jsonJob, &JsonApiJob::finishedSignal, this, [jsonJob, this] {
-                    _account->setAppProvider(AppProvider { jsonJob->data() });
-                });
-                jsonJob->start();
-            }
+void ConnectionValidator::fetchUserDetails()
+{
+    auto capabilities = _account->capabilities();
+    // We should have received the capabilities by now. Check that assumption in a debug build. If
+    // it's not the case, the code below will assume that they are not available.
+    Q_ASSERT(capabilities.isValid());
+
+    auto *group = new JobGroup(this);
+    if (capabilities.isValid()) {
+        if (capabilities.avatarsAvailable()) {
+            auto *avatarJob = group->createJob<AvatarJob>(_account, _account->davUser(), 128, this);
+            avatarJob->setAuthenticationJob(true);
+            avatarJob->setTimeout(20s);
+            connect(avatarJob, &AvatarJob::avatarPixmap, this, [this](const QPixmap &img) {
+                _account->setAvatar(img);
+            });
+            avatarJob->start();
         }
-        connect(group, &JobGroup::finishedSignal, this, [group, this] {
-            group->deleteLater();
-            reportResult(Connected);
-        });
-
-        if (group->isEmpty()) {
-            Q_EMIT group->finishedSignal();
+        if (capabilities.appProviders().enabled) {
+            auto *jsonJob = group->createJob<JsonJob>(_account, _account->url(), capabilities.appProviders().appsUrl, "GET");
+            connect(jsonJob, &JsonApiJob::finishedSignal, this, [jsonJob, this] {
+                _account->setAppProvider(AppProvider { jsonJob->data() });
+            });
+            jsonJob->start();
         }
+    }
+    connect(group, &JobGroup::finishedSignal, this, [group, this] {
+        group->deleteLater();
+        reportResult(Connected);
     });
-    job->start();
+
+    if (group->isEmpty()) {
+        Q_EMIT group->finishedSignal();
+    }
 }
 
 bool ConnectionValidator::checkServerInfo()
@@ -323,22 +368,16 @@ bool ConnectionValidator::checkServerInfo()
     }
     // We attempt to work with servers >= 7.0.0 but warn users.
     // Check usages of Account::serverVersionUnsupported() for details.
-
-    // Record that the server supports HTTP/2
-    // Actual decision if we should use HTTP/2 is done in AccessManager::createRequest
-    if (auto job = qobject_cast<AbstractNetworkJob *>(sender())) {
-        if (auto reply = job->reply()) {
-            _account->setHttp2Supported(
-                reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool());
-        }
-    }
     return true;
 }
 
 void ConnectionValidator::reportResult(Status status)
 {
-    qCDebug(lcConnectionValidator) << status;
-    emit connectionResult(status, _errors);
+    qCInfo(lcConnectionValidator) << "Connection check finished with" << status << "after" << _timer.duration();
+    // don't report the connection twice if the cached capabilities were confirmed
+    if (!(_reportedConnected && status == Connected)) {
+        emit connectionResult(status, _errors);
+    }
     deleteLater();
 }
 
@@ -16,6 +16,7 @@
 #define CONNECTIONVALIDATOR_H
 
 #include "accountfwd.h"
+#include "common/chronoelapsedtimer.h"
 #include "owncloudlib.h"
 
 #include <QNetworkReply>
@@ -60,16 +61,20 @@ namespace OCC {
                               |
   +---------------------------+
   |
-  +-> checkServerCapabilities
-        JsonApiJob (cloud/capabilities) -> slotCapabilitiesRecieved -+
-                                                                     |
-  +------------------------------------------------------------------+
+  +-> checkServerCapabilities --> connectionResult(Connected) (if capabilities and user info are cached)
+        JsonApiJob (cloud/capabilities) -+
+        JsonApiJob (cloud/user) ---------+-> serverInfoJobFinished
+                                                 |
+  +----------------------------------------------+
   |
-  +-> fetchUser -+
-                 |
-                 +-> AvatarJob
-                            |
-                            +-> slotAvatarImage --> reportResult()
+  +-> fetchUserDetails -+
+                        |
+                        +-> AvatarJob
+                                   |
+                                   +-> slotAvatarImage --> reportResult()
+
+The capabilities and the user info are requested with the ETags of the cached
+values, the server answers with 304 if they are still valid.
 
     \endcode
  */
@@ -134,7 +139,8 @@ protected slots:
 private:
     void reportResult(Status status);
     void checkServerCapabilities();
-    void fetchUser();
+    void serverInfoJobFinished();
+    void fetchUserDetails();
 
     /** Sets the account's server version
      *
@@ -146,6 +152,12 @@ private:
     AccountPtr _account;
     bool _clearCookies = false;
 
+    /// The number of running capabilities and user info jobs
+    int _pendingJobs = 0;
+    /// Connected was already reported based on the cached capabilities
+    bool _reportedConnected = false;
+    Utility::ChronoElapsedTimer _timer;
+
     ConnectionValidator::ValidationMode _mode = ConnectionValidator::ValidationMode::ValidateAuthAndUpdate;
 };
 }
@@ -42,7 +42,9 @@
 #include <QTimer>
 #include <QUrl>
 #include <QDir>
+#include <QFutureWatcher>
 #include <QSettings>
+#include <QtConcurrentRun>
 
 #include <QMessageBox>
 #include <QPushButton>
@@ -114,8 +116,6 @@ Folder::Folder(const FolderDefinition &definition,
     // check if the local path exists
     if (checkLocalPath()) {
         prepareFolder(path());
-        // those errors should not persist over sessions
-        _journal.wipeErrorBlacklistCategory(SyncJournalErrorBlacklistRecord::Category::LocalSoftError);
         _engine.reset(new SyncEngine(_accountState->account(), webDavUrl(), path(), remotePath(), &_journal));
         // pass the setting if hidden files are to be ignored, will be read in csync_update
         _engine->setIgnoreHiddenFiles(_definition.ignoreHiddenFiles);
@@ -137,8 +137,11 @@ Folder::Folder(const FolderDefinition &definition,
 
         connect(_engine.data(), &SyncEngine::aboutToRemoveAllFiles,
             this, &Folder::slotAboutToRemoveAllFiles);
-        connect(_engine.data(), &SyncEngine::transmissionProgress, this, [this](const ProgressInfo &pi) {
-            emit ProgressDispatcher::instance()->progressInfo(this, pi);
+        // the aggregator is owned by the engine, it references the engines progress info
+        auto progressAggregator = new ProgressAggregator(_engine.data());
+        connect(_engine.data(), &SyncEngine::transmissionProgress, progressAggregator, &ProgressAggregator::updateProgress);
+        connect(progressAggregator, &ProgressAggregator::snapshotPublished, this, [this](const ProgressSnapshot &progress) {
+            emit ProgressDispatcher::instance()->progressInfo(this, progress);
         });
         connect(_engine.data(), &SyncEngine::itemCompleted,
             this, &Folder::slotItemCompleted);
@@ -150,9 +153,14 @@ Folder::Folder(const FolderDefinition &definition,
         connect(_engine.data(), &SyncEngine::syncError, this, &Folder::slotSyncError);
 
         _scheduleSelfTimer.setSingleShot(true);
-        _scheduleSelfTimer.setInterval(SyncEngine::minimumFileAgeForUpload);
-        connect(&_scheduleSelfTimer, &QTimer::timeout,
-            this, &Folder::slotScheduleThisFolder);
+        connect(&_scheduleSelfTimer, &QTimer::timeout, this, [this] {
+            // don't queue a follow-up while we are still syncing, slotSyncFinished() picks it up
+            if (isSyncRunning()) {
+                return;
+            }
+            _schedulingPolicy.syncScheduled();
+            slotScheduleThisFolder();
+        });
 
         connect(ProgressDispatcher::instance(), &ProgressDispatcher::folderConflicts,
             this, &Folder::slotFolderConflicts);
@@ -166,8 +174,28 @@ Folder::Folder(const FolderDefinition &definition,
         connect(_engine.data(), &SyncEngine::itemCompleted,
             _localDiscoveryTracker.data(), &LocalDiscoveryTracker::slotItemCompleted);
 
-        // Potentially upgrade suffix vfs to windows vfs
         OC_ENFORCE(_vfs);
+        initialize();
+    }
+}
+
+void Folder::initialize()
+{
+    // Opening the journal might create or migrate the database, with many folders
+    // this would block the startup. Open it in the background and finish the setup
+    // once it is done, the folder becomes ready when the vfs started.
+    _initializationTimer.reset();
+    auto *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, this] {
+        watcher->deleteLater();
+        if (watcher->result()) {
+            qCInfo(lcFolder) << "Opened the journal of" << path() << "after" << _initializationTimer.duration();
+        } else {
+            // the sync will report the error
+            qCWarning(lcFolder) << "Failed to open the journal of" << path();
+        }
+
+        // Potentially upgrade suffix vfs to windows vfs
         if (_definition.virtualFilesMode == Vfs::WithSuffix
             && _definition.upgradeVfsMode) {
             if (isVfsPluginAvailable(Vfs::WindowsCfApi)) {
@@ -184,11 +212,23 @@ Folder::Folder(const FolderDefinition &definition,
         }
         // Initialize the vfs plugin
         startVfs();
-    }
+    });
+    _journalInitialization = QtConcurrent::run([journal = &_journal] {
+        if (!journal->open()) {
+            return false;
+        }
+        // those errors should not persist over sessions
+        journal->wipeErrorBlacklistCategory(SyncJournalErrorBlacklistRecord::Category::LocalSoftError);
+        return true;
+    });
+    watcher->setFuture(_journalInitialization);
 }
 
 Folder::~Folder()
 {
+    // the journal must not be used by the initialization after it was destroyed
+    _journalInitialization.waitForFinished();
+
     // If wipeForRemoval() was called the vfs has already shut down.
     if (_vfs)
         _vfs->stop();
@@ -253,6 +293,10 @@ SyncOptions Folder::loadSyncOptions()
     opt._moveFilesToTrash = cfgFile.moveToTrash();
     opt._vfs = _vfs;
     opt._parallelNetworkJobs = _accountState->account()->isHttp2Supported() ? 20 : 6;
+    if (auto *folderMan = FolderMan::instance()) {
+        opt._transferBudget = folderMan->transferBudget();
+    }
+    opt._transferWeight = transferWeight();
 
     opt._initialChunkSize = cfgFile.chunkSize();
     opt._minChunkSize = cfgFile.minChunkSize();
@@ -623,12 +667,15 @@ void Folder::startVfs()
         _vfs->fileStatusChanged(stateDbFile + QStringLiteral("-shm"), SyncFileStatus::StatusExcluded);
         _engine->setSyncOptions(loadSyncOptions());
         _vfsIsReady = true;
+        registerFolderWatcher();
+        Q_EMIT isReadyChanged();
         slotScheduleThisFolder();
     });
     connect(_vfs.data(), &Vfs::error, this, [this](const QString &error) {
         _syncResult.appendErrorString(error);
         _syncResult.setStatus(SyncResult::SetupError);
         _vfsIsReady = false;
+        Q_EMIT isReadyChanged();
     });
 
     _vfs->start(vfsParams);
@@ -742,6 +789,8 @@ void Folder::slotWatchedPathChanged(const QString &path, ChangeReason reason)
 
     // Also schedule this folder for a sync, but only after some delay:
     // The sync will not upload files that were changed too recently.
+    // The delay grows while the folder keeps changing.
+    _schedulingPolicy.addChange(SyncSchedulingPolicy::Clock::now());
     scheduleThisFolderSoon();
 }
 
@@ -904,6 +953,7 @@ void Folder::wipeForRemoval()
         return;
     }
     // prevent interaction with the db etc
+    _journalInitialization.waitForFinished();
     _vfsIsReady = false;
 
     // stop reacting to changes
@@ -977,6 +1027,16 @@ void Folder::startSync()
 
     setDirtyNetworkLimits();
 
+    if (!_pinChangePaths.empty()) {
+        // the transfers start without a discovery, local changes are left to the next sync
+        qCInfo(lcFolder) << "Applying the changed pin states without a discovery";
+        _engine->setPinChangePaths(std::exchange(_pinChangePaths, {}));
+        _pinChangeSyncRunning = true;
+        QMetaObject::invokeMethod(_engine.data(), &SyncEngine::startSync, Qt::QueuedConnection);
+        emit syncStarted();
+        return;
+    }
+
     static std::chrono::milliseconds fullLocalDiscoveryInterval = []() {
         auto interval = ConfigFile().fullLocalDiscoveryInterval();
         QByteArray env = qgetenv("OWNCLOUD_FULL_LOCAL_DISCOVERY_INTERVAL");
@@ -985,10 +1045,24 @@ void Folder::startSync()
         }
         return interval;
     }();
+    const auto now = SyncSchedulingPolicy::Clock::now();
+    // a sync that was scheduled by the watcher is covered by this run
+    _scheduleSelfTimer.stop();
+    _schedulingPolicy.syncStarted(now);
+    qCInfo(lcFolder) << "Local change rate" << _schedulingPolicy.changeRate(now) << "/s,"
+                     << _schedulingPolicy.avoidedSyncs() << "sync requests were coalesced so far";
+
     bool hasDoneFullLocalDiscovery = _timeSinceLastFullLocalDiscovery.isValid();
     bool periodicFullLocalDiscoveryNow =
         fullLocalDiscoveryInterval.count() >= 0 // negative means we don't require periodic full runs
         && _timeSinceLastFullLocalDiscovery.hasExpired(fullLocalDiscoveryInterval.count());
+    if (periodicFullLocalDiscoveryNow && _schedulingPolicy.isBusy(now)
+        && !_timeSinceLastFullLocalDiscovery.hasExpired(2 * fullLocalDiscoveryInterval.count())) {
+        // The folder is changing constantly, a full run would be repeated by the next sync anyway.
+        // Postpone it, but not indefinitely.
+        qCInfo(lcFolder) << "Postponing periodic full local discovery, the folder is busy";
+        periodicFullLocalDiscoveryNow = false;
+    }
     if (_folderWatcher && _folderWatcher->isReliable()
         && hasDoneFullLocalDiscovery
         && !periodicFullLocalDiscoveryNow) {
@@ -1010,6 +1084,11 @@ void Folder::startSync()
     emit syncStarted();
 }
 
+int Folder::transferWeight() const
+{
+    return 1 + static_cast<int>(qMin<uint32_t>(_definition.priority() / 50, 2));
+}
+
 void Folder::setDirtyNetworkLimits()
 {
     Q_ASSERT(isReady());
@@ -1030,6 +1109,18 @@ void Folder::setDirtyNetworkLimits()
         uploadLimit = 0;
     }
 
+    // the absolute limits apply to all running syncs together, each gets its weighted share
+    if (auto *folderMan = FolderMan::instance()) {
+        const qint64 weight = transferWeight();
+        const qint64 runningWeight = qMax<qint64>(weight, folderMan->runningSyncWeight());
+        if (downloadLimit > 0) {
+            downloadLimit = static_cast<int>(qMax<qint64>(1, downloadLimit * weight / runningWeight));
+        }
+        if (uploadLimit > 0) {
+            uploadLimit = static_cast<int>(qMax<qint64>(1, uploadLimit * weight / runningWeight));
+        }
+    }
+
     _engine->setNetworkLimits(uploadLimit, downloadLimit);
 }
 
@@ -1064,6 +1155,8 @@ void Folder::slotSyncFinished(bool success)
     showSyncResultPopup();
 
     auto anotherSyncNeeded = _engine->isAnotherSyncNeeded();
+    // a pin change sync doesn't tell anything about the state of the other files
+    const bool pinChangeSync = std::exchange(_pinChangeSyncRunning, false);
 
     if (syncError) {
         _syncResult.setStatus(SyncResult::Error);
@@ -1085,14 +1178,14 @@ void Folder::slotSyncFinished(bool success)
         qCInfo(lcFolder) << "the last" << _consecutiveFailingSyncs << "syncs failed";
     }
 
-    if (_syncResult.status() == SyncResult::Success && success) {
+    if (_syncResult.status() == SyncResult::Success && success && !pinChangeSync) {
         // Clear the white list as all the folders that should be on that list are sync-ed
         journalDb()->setSelectiveSyncList(SyncJournalDb::SelectiveSyncWhiteList, QStringList());
     }
 
     if ((_syncResult.status() == SyncResult::Success
             || _syncResult.status() == SyncResult::Problem)
-        && success) {
+        && success && !pinChangeSync) {
         if (_engine->lastLocalDiscoveryStyle() == LocalDiscoveryStyle::FilesystemOnly) {
             _timeSinceLastFullLocalDiscovery.start();
         }
@@ -1127,6 +1220,12 @@ void Folder::slotSyncFinished(bool success)
         // changing, so wait at least a small amount of time before syncing
         // the folder again.
         scheduleThisFolderSoon();
+    } else if (pinChangeSync && !_localDiscoveryTracker->localDiscoveryPaths().empty()) {
+        // the regular sync the pin change went ahead of
+        scheduleThisFolderSoon();
+    } else if (_schedulingPolicy.hasPendingSync() && !_scheduleSelfTimer.isActive()) {
+        // local changes arrived while we were syncing
+        _scheduleSelfTimer.start(_schedulingPolicy.delay(SyncSchedulingPolicy::Clock::now()));
     }
 }
 
@@ -1216,6 +1315,12 @@ void Folder::schedulePathForLocalDiscovery(const QString &relativePath)
     _localDiscoveryTracker->addTouchedPath(relativePath);
 }
 
+void Folder::schedulePinChange(const QString &relativePath)
+{
+    _pinChangePaths.insert(relativePath);
+    scheduleThisFolderSoon();
+}
+
 void Folder::slotFolderConflicts(Folder *folder, const QStringList &conflictPaths)
 {
     if (folder != this)
@@ -1275,9 +1380,14 @@ void Folder::slotWatcherUnreliable(const QString &message)
 
 void Folder::scheduleThisFolderSoon()
 {
-    if (!_scheduleSelfTimer.isActive()) {
-        _scheduleSelfTimer.start();
+    const auto now = SyncSchedulingPolicy::Clock::now();
+    _schedulingPolicy.requestSync(now);
+    if (isSyncRunning()) {
+        // the delay is computed again once the sync is done
+        return;
     }
+    // restarts a running timer, the policy bounds the total delay
+    _scheduleSelfTimer.start(_schedulingPolicy.delay(now));
 }
 
 void Folder::setSaveBackwardsCompatible(bool save)
@@ -18,13 +18,16 @@
 #define MIRALL_FOLDER_H
 
 #include "accountstate.h"
+#include "common/chronoelapsedtimer.h"
 #include "common/syncjournaldb.h"
 #include "networkjobs.h"
 #include "progressdispatcher.h"
 #include "syncoptions.h"
 #include "syncresult.h"
+#include "syncschedulingpolicy.h"
 
 #include <QDateTime>
+#include <QFuture>
 #include <QObject>
 #include <QStringList>
 #include <QUuid>
@@ -323,10 +326,14 @@ public:
       * modified too recently, and this delay ensures the modification is
       * far enough in the past.
       *
-      * The delay doesn't reset with subsequent calls.
+      * The delay is determined by the schedulingPolicy(), it grows with the
+      * rate of local changes but is bounded by the time of the first call.
       */
     void scheduleThisFolderSoon();
 
+    /** Decides when local changes trigger a sync, also provides statistics */
+    const SyncSchedulingPolicy &schedulingPolicy() const { return _schedulingPolicy; }
+
     /**
       * Migration: When this flag is true, this folder will save to
       * the backwards-compatible 'Folders' section in the config file.
@@ -383,6 +390,13 @@ public:
         return _definition.setPriority(p);
     }
 
+    /**
+     * The share of the transfer slots and bandwidth this folder gets
+     * while other folders are syncing, derived from the priority.
+     * The personal space gets 3, the shares 2 and other spaces 1.
+     */
+    int transferWeight() const;
+
 signals:
     void syncStateChange();
     void syncStarted();
@@ -390,6 +404,8 @@ signals:
     void newBigFolderDiscovered(const QString &); // A new folder bigger than the threshold was discovered
     void syncPausedChanged(Folder *, bool paused);
     void canSyncChanged();
+    /// Emitted when the folder became ready after it was set up or the vfs mode changed, or when the vfs failed to start
+    void isReadyChanged();
 
     /**
      * Fires for each change inside this folder that wasn't caused
@@ -456,6 +472,12 @@ public slots:
      */
     void schedulePathForLocalDiscovery(const QString &relativePath);
 
+    /**
+     * Hydrates or dehydrates the files below relativePath according to
+     * their pin state with the next sync, see SyncEngine::setPinChangePaths().
+     */
+    void schedulePinChange(const QString &relativePath);
+
     /// Reloads the excludes, used when changing the user-defined excludes after saving them to disk.
     bool reloadExcludes();
 
@@ -514,6 +536,8 @@ private:
     void createGuiLog(const QString &filename, LogStatus status, int count,
         const QString &renameTarget = QString());
 
+    /// Opens the journal in the background and starts the vfs afterwards
+    void initialize();
     void startVfs();
 
     AccountStatePtr _accountState;
@@ -543,6 +567,7 @@ private:
     QScopedPointer<SyncRunFileLog> _fileLog;
 
     QTimer _scheduleSelfTimer;
+    SyncSchedulingPolicy _schedulingPolicy;
 
     /**
      * When the same local path is synced to multiple accounts, only one
@@ -576,6 +601,9 @@ private:
      */
     bool _vfsIsReady = false;
 
+    QFuture<bool> _journalInitialization;
+    Utility::ChronoElapsedTimer _initializationTimer;
+
     /**
      * Watches this folder's local directory for changes.
      *
@@ -588,6 +616,12 @@ private:
      */
     QScopedPointer<LocalDiscoveryTracker> _localDiscoveryTracker;
 
+    /// The paths whose pin state changed since the last sync
+    std::set<QString> _pinChangePaths;
+
+    /// Whether the running sync only applies pin changes, it doesn't discover anything
+    bool _pinChangeSyncRunning = false;
+
     /**
      * The vfs mode instance (created by plugin) to use. Never null.
      */
@@ -26,6 +26,7 @@
 #include "socketapi/socketapi.h"
 #include "syncresult.h"
 #include "theme.h"
+#include "transferbudget.h"
 #include <syncengine.h>
 
 #include <QMessageBox>
@@ -38,6 +39,9 @@ using namespace std::chrono;
 using namespace std::chrono_literals;
 
 namespace {
+// a folder that was passed over this often is started before any other scheduled folder
+constexpr int maxSchedulingSkips = 5;
+
 /*
  * [Accounts]
  * 0\version=1
@@ -133,7 +137,6 @@ FolderMan *FolderMan::_instance = nullptr;
 
 FolderMan::FolderMan(QObject *parent)
     : QObject(parent)
-    , _currentSyncFolder(nullptr)
     , _syncEnabled(true)
     , _lockWatcher(new LockWatcher)
 #ifdef Q_OS_WIN
@@ -146,6 +149,10 @@ FolderMan::FolderMan(QObject *parent)
 
     _socketApi.reset(new SocketApi);
 
+    _transferBudget = QSharedPointer<TransferBudget>::create(ConfigFile().maxTotalTransferJobs());
+    _transferBudget->setMaximumActiveJobsPerHost(ConfigFile().maxTransferJobsPerHost());
+    connect(ConfigFileNotifier::instance(), &ConfigFileNotifier::networkLimitsChanged, this, &FolderMan::setDirtyNetworkLimits);
+
     // Set the remote poll interval fixed to 10 seconds.
     // That does not mean that it polls every 10 seconds, but it checks every 10 seconds
     // if one of the folders is due to sync. This means that if the server advertises a
@@ -209,9 +216,11 @@ void FolderMan::unloadFolder(Folder *f)
             _socketApi.data(), &SocketApi::broadcastStatusPushMessage);
         disconnect(f, &Folder::watchedFileChangedExternally,
             &f->syncEngine().syncFileStatusTracker(), &SyncFileStatusTracker::slotPathTouched);
+        disconnect(f, &Folder::isReadyChanged, this, nullptr);
 
         f->syncEngine().disconnect(f);
     }
+    _initializingFolders.remove(f);
 }
 
 void FolderMan::unloadAndDeleteAllFolders()
@@ -223,8 +232,9 @@ void FolderMan::unloadAndDeleteAllFolders()
         folder->deleteLater();
     }
     _lastSyncFolder = nullptr;
-    _currentSyncFolder = nullptr;
+    _currentSyncFolders.clear();
     _scheduledFolders.clear();
+    _schedulingSkips.clear();
     emit folderListChanged();
     emit scheduleQueueChanged();
 }
@@ -244,6 +254,7 @@ void FolderMan::registerFolderWithSocketApi(Folder *folder)
 int FolderMan::setupFolders()
 {
     unloadAndDeleteAllFolders();
+    _startupTimer.reset();
 
     QStringList skipSettingsKeys, deleteSettingsKeys;
     backwardMigrationSettingsKeys(&deleteSettingsKeys, &skipSettingsKeys);
@@ -285,11 +296,28 @@ int FolderMan::setupFolders()
         settings->endGroup(); // <account>
     }
 
+    for (auto *folder : qAsConst(_folders)) {
+        if (!folder->isReady() && !folder->hasSetupError()) {
+            _initializingFolders.insert(folder);
+        }
+    }
+    qCInfo(lcFolderMan) << "Created" << _folders.size() << "folders in" << _startupTimer.duration() << "of which" << _initializingFolders.size() << "are still initializing";
+
     emit folderListChanged();
 
     return _folders.size();
 }
 
+void FolderMan::slotFolderReady(Folder *folder)
+{
+    registerFolderWithSocketApi(folder);
+    // a folder whose vfs failed to start is done initializing as well
+    if (_initializingFolders.remove(folder) && _initializingFolders.isEmpty()) {
+        qCInfo(lcFolderMan) << "All folders are initialized after" << _startupTimer.duration();
+    }
+    emit folderSyncStateChange(folder);
+}
+
 void FolderMan::setupFoldersHelper(QSettings &settings, AccountStatePtr account, const QStringList &ignoreKeys, bool backwardsCompatible, bool foldersWithPlaceholders)
 {
     const auto &childGroups = settings.childGroups();
@@ -529,6 +557,8 @@ void FolderMan::scheduleFolderNext(Folder *f)
     f->prepareToSync();
     emit folderSyncStateChange(f);
     _scheduledFolders.prepend(f);
+    // ignore the priorities
+    _schedulingSkips.insert(f, maxSchedulingSkips);
     emit scheduleQueueChanged();
 
     startScheduledSyncSoon();
@@ -608,6 +638,7 @@ void FolderMan::slotAccountStateChanged()
         while (it.hasNext()) {
             Folder *f = it.next();
             if (f->accountState() == accountState) {
+                _schedulingSkips.remove(f);
                 it.remove();
             }
         }
@@ -637,7 +668,7 @@ void FolderMan::startScheduledSyncSoon()
     if (_scheduledFolders.empty()) {
         return;
     }
-    if (isAnySyncRunning()) {
+    if (runningSyncCount() >= maxParallelSyncs()) {
         return;
     }
 
@@ -672,7 +703,8 @@ void FolderMan::startScheduledSyncSoon()
   */
 void FolderMan::slotStartScheduledFolderSync()
 {
-    if (isAnySyncRunning()) {
+    const int maxParallel = maxParallelSyncs();
+    if (runningSyncCount() >= maxParallel) {
         for (auto *f : qAsConst(_folders)) {
             if (f->isSyncRunning())
                 qCInfo(lcFolderMan) << "Currently folder " << f->remoteUrl().toString() << " is running, wait for finish!";
@@ -690,29 +722,75 @@ void FolderMan::slotStartScheduledFolderSync()
         return;
     }
 
-    // Find the first folder in the queue that can be synced.
-    Folder *folder = nullptr;
-    while (!_scheduledFolders.isEmpty()) {
-        Folder *g = _scheduledFolders.dequeue();
-        if (g->canSync()) {
-            folder = g;
-            break;
+    // Drop the folders that can't be synced.
+    QMutableListIterator<Folder *> it(_scheduledFolders);
+    while (it.hasNext()) {
+        Folder *f = it.next();
+        if (!f->canSync()) {
+            _schedulingSkips.remove(f);
+            it.remove();
         }
     }
 
-    emit scheduleQueueChanged();
+    // Fill the free slots in the order of the priorities
+    const QVector<Folder *> queueOrder(_scheduledFolders.cbegin(), _scheduledFolders.cend());
+    const auto candidates = schedulingOrder();
+    int lastStartedQueueIndex = -1;
+    for (auto *folder : candidates) {
+        if (runningSyncCount() >= maxParallel) {
+            break;
+        }
+        // an externally managed sync is running, try again when it finished
+        if (folder->isSyncRunning()) {
+            continue;
+        }
+        _scheduledFolders.removeAll(folder);
+        _schedulingSkips.remove(folder);
 
-    // Start syncing this folder!
-    if (folder) {
         // Safe to call several times, and necessary to try again if
         // the folder path didn't exist previously.
         folder->registerFolderWatcher();
         registerFolderWithSocketApi(folder);
 
-        _currentSyncFolder = folder;
-        qCInfo(lcFolderMan) << "Start scheduled sync of" << folder->path();
+        _currentSyncFolders.append(folder);
+        lastStartedQueueIndex = qMax(lastStartedQueueIndex, queueOrder.indexOf(folder));
+        qCInfo(lcFolderMan) << "Start scheduled sync of" << folder->path() << "priority:" << folder->priority()
+                            << "running syncs:" << runningSyncCount() << "queued:" << _scheduledFolders.size();
         folder->startSync();
     }
+
+    if (lastStartedQueueIndex != -1) {
+        // count how often the remaining folders were passed over by folders queued after them
+        for (int i = 0; i < lastStartedQueueIndex; ++i) {
+            Folder *folder = queueOrder.at(i);
+            if (_scheduledFolders.contains(folder)) {
+                auto &skips = _schedulingSkips[folder];
+                skips = qMin(skips + 1, maxSchedulingSkips);
+            }
+        }
+        // the share of the bandwidth limit changed
+        setDirtyNetworkLimits();
+    }
+
+    emit scheduleQueueChanged();
+}
+
+QVector<Folder *> FolderMan::schedulingOrder() const
+{
+    QVector<Folder *> out(_scheduledFolders.cbegin(), _scheduledFolders.cend());
+    // stable to keep the queue order for equal priorities
+    std::stable_sort(out.begin(), out.end(), [this](Folder *a, Folder *b) {
+        const bool aStarved = _schedulingSkips.value(a) >= maxSchedulingSkips;
+        const bool bStarved = _schedulingSkips.value(b) >= maxSchedulingSkips;
+        if (aStarved != bStarved) {
+            return aStarved;
+        }
+        if (aStarved) {
+            return false;
+        }
+        return a->priority() > b->priority();
+    });
+    return out;
 }
 
 void FolderMan::slotEtagPollTimerTimeout()
@@ -792,6 +870,10 @@ void FolderMan::slotScheduleFolderByTime()
         // Possibly it's just time for a new sync run
         const auto pta = f->accountState()->account()->capabilities().remotePollInterval();
         bool forceSyncIntervalExpired = msecsSinceSync > ConfigFile().forceSyncInterval(pta);
+        if (forceSyncIntervalExpired && f->schedulingPolicy().hasPendingSync()) {
+            // local changes already triggered a sync that is waiting for the folder to settle
+            continue;
+        }
         if (forceSyncIntervalExpired) {
             qCInfo(lcFolderMan) << "Scheduling folder" << f->path()
                                 << "because it has been" << msecsSinceSync.count() << "ms "
@@ -825,14 +907,34 @@ void FolderMan::slotScheduleFolderByTime()
 
 bool FolderMan::isAnySyncRunning() const
 {
-    if (_currentSyncFolder)
-        return true;
+    return runningSyncCount() > 0;
+}
 
+int FolderMan::runningSyncCount() const
+{
+    int out = 0;
     for (auto f : _folders) {
-        if (f->isSyncRunning())
-            return true;
+        if (f->isSyncRunning() || _currentSyncFolders.contains(f)) {
+            ++out;
+        }
+    }
+    return out;
+}
+
+int FolderMan::runningSyncWeight() const
+{
+    int out = 0;
+    for (auto f : _folders) {
+        if (f->isSyncRunning() || _currentSyncFolders.contains(f)) {
+            out += f->transferWeight();
+        }
     }
-    return false;
+    return out;
+}
+
+int FolderMan::maxParallelSyncs() const
+{
+    return ConfigFile().maxParallelFolderSyncs();
 }
 
 void FolderMan::slotFolderSyncStarted()
@@ -871,12 +973,12 @@ void FolderMan::slotFolderSyncFinished(const SyncResult &)
                         << "] with remote ["
                         << f->remoteUrl().toDisplayString()
                         << "]";
-    if (f == _currentSyncFolder) {
-        _lastSyncFolder = _currentSyncFolder;
-        _currentSyncFolder = nullptr;
+    if (_currentSyncFolders.removeAll(f) > 0) {
+        _lastSyncFolder = f;
+        // the remaining syncs get a bigger share of the bandwidth limit
+        setDirtyNetworkLimits();
     }
-    if (!isAnySyncRunning())
-        startScheduledSyncSoon();
+    startScheduledSyncSoon();
 }
 
 Folder *FolderMan::addFolder(const AccountStatePtr &accountState, const FolderDefinition &folderDefinition)
@@ -949,6 +1051,7 @@ Folder *FolderMan::addFolderInternal(
             _socketApi.data(), &SocketApi::broadcastStatusPushMessage);
         connect(folder, &Folder::watchedFileChangedExternally,
             &folder->syncEngine().syncFileStatusTracker(), &SyncFileStatusTracker::slotPathTouched);
+        connect(folder, &Folder::isReadyChanged, this, [folder, this] { slotFolderReady(folder); });
 
         folder->registerFolderWatcher();
         registerFolderWithSocketApi(folder);
@@ -1016,6 +1119,8 @@ void FolderMan::removeFolder(Folder *f)
         f->slotTerminateSync();
     }
 
+    _currentSyncFolders.removeAll(f);
+    _schedulingSkips.remove(f);
     if (_scheduledFolders.removeAll(f) > 0) {
         emit scheduleQueueChanged();
     }
@@ -1327,9 +1432,26 @@ QQueue<Folder *> FolderMan::scheduleQueue() const
     return _scheduledFolders;
 }
 
-Folder *FolderMan::currentSyncFolder() const
+int FolderMan::queuePosition(Folder *folder) const
+{
+    return schedulingOrder().indexOf(folder);
+}
+
+QVector<Folder *> FolderMan::currentSyncFolders() const
+{
+    QVector<Folder *> out;
+    out.reserve(_currentSyncFolders.size());
+    for (const auto &f : _currentSyncFolders) {
+        if (f) {
+            out.append(f);
+        }
+    }
+    return out;
+}
+
+QSharedPointer<TransferBudget> FolderMan::transferBudget() const
 {
-    return _currentSyncFolder;
+    return _transferBudget;
 }
 
 void FolderMan::restartApplication()
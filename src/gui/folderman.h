@@ -41,6 +41,7 @@ class Application;
 class SyncResult;
 class SocketApi;
 class LockWatcher;
+class TransferBudget;
 
 /**
  * @brief Return object for Folder::trayOverallStatus.
@@ -81,6 +82,11 @@ private:
  * - There was a sync error or a follow-up sync is requested
  *   (_timeScheduler and slotScheduleFolderByTime()
  *    and Folder::slotSyncFinished())
+ *
+ * Up to ConfigFile::maxParallelFolderSyncs() folders are synced at the same time.
+ * Scheduled folders with a higher priority are started first, a folder that was
+ * passed over several times is started before any other.
+ * The network jobs of all running syncs share the transferBudget().
  */
 class FolderMan : public QObject
 {
@@ -213,14 +219,39 @@ public:
     QQueue<Folder *> scheduleQueue() const;
 
     /**
-     * Access to the currently syncing folder.
+     * Returns the position of a scheduled folder in the order the folders
+     * will be started, -1 if the folder is not scheduled.
+     */
+    int queuePosition(Folder *folder) const;
+
+    /**
+     * Access to the currently syncing folders.
      *
-     * Note: This is only the folder that's currently syncing *as-scheduled*. There
+     * Note: These are only the folders that are currently syncing *as-scheduled*. There
      * may be externally-managed syncs such as from placeholder hydrations.
      *
      * See also isAnySyncRunning()
      */
-    Folder *currentSyncFolder() const;
+    QVector<Folder *> currentSyncFolders() const;
+
+    /**
+     * The number of folders that are currently syncing, including
+     * externally managed syncs.
+     */
+    int runningSyncCount() const;
+
+    /// The sum of the transfer weights of the folders that are currently syncing
+    int runningSyncWeight() const;
+
+    /**
+     * The maximal number of folders that are synced at the same time
+     */
+    int maxParallelSyncs() const;
+
+    /**
+     * Limits the active network jobs of all running syncs
+     */
+    QSharedPointer<TransferBudget> transferBudget() const;
 
     /**
      * Returns true if any folder is currently syncing.
@@ -346,9 +377,15 @@ private:
     /* unloads a folder object, does not delete it */
     void unloadFolder(Folder *);
 
+    /** The folder finished its initialization, see Folder::isReady() */
+    void slotFolderReady(Folder *folder);
+
     /** Will start a sync after a bit of delay. */
     void startScheduledSyncSoon();
 
+    /** The scheduled folders in the order they will be started */
+    QVector<Folder *> schedulingOrder() const;
+
     // finds all folder configuration files
     // and create the folders
     QString getBackupName(QString fullPathName) const;
@@ -364,13 +401,17 @@ private:
     QSet<Folder *> _disabledFolders;
     QVector<Folder *> _folders;
     QString _folderConfigPath;
-    QPointer<Folder> _currentSyncFolder;
+    QVector<QPointer<Folder>> _currentSyncFolders;
     QPointer<Folder> _lastSyncFolder;
     bool _syncEnabled;
 
     /// Folder aliases from the settings that weren't read
     QSet<QString> _additionalBlockedFolderAliases;
 
+    /// Folders created by setupFolders() whose vfs didn't start or fail yet
+    QSet<Folder *> _initializingFolders;
+    Utility::ChronoElapsedTimer _startupTimer;
+
     /// Starts regular etag query jobs
     QTimer _etagPollTimer;
     /// The currently running etag query
@@ -385,6 +426,11 @@ private:
     /// Scheduled folders that should be synced as soon as possible
     QQueue<Folder *> _scheduledFolders;
 
+    /// How often a scheduled folder was passed over in favour of a folder with a higher priority
+    QHash<Folder *, int> _schedulingSkips;
+
+    QSharedPointer<TransferBudget> _transferBudget;
+
     /// Picks the next scheduled folder and starts the sync
     QTimer _startScheduledSyncTimer;
 
@@ -79,7 +79,7 @@ void FolderStatusModel::setAccountState(const AccountStatePtr &accountState)
         info._checked = Qt::PartiallyChecked;
         _folders << info;
 
-        connect(ProgressDispatcher::instance(), &ProgressDispatcher::progressInfo, this, [f, this](Folder *folder, const ProgressInfo &progress) {
+        connect(ProgressDispatcher::instance(), &ProgressDispatcher::progressInfo, this, [f, this](Folder *folder, const ProgressSnapshot &progress) {
             if (folder == f) {
                 slotSetProgress(progress, f);
             }
@@ -898,7 +898,7 @@ void FolderStatusModel::slotApplySelectiveSync()
     resetFolders();
 }
 
-void FolderStatusModel::slotSetProgress(const ProgressInfo &progress, Folder *f)
+void FolderStatusModel::slotSetProgress(const ProgressSnapshot &progress, Folder *f)
 {
     if (!qobject_cast<QWidget *>(QObject::parent())->isVisible()) {
         return; // for https://github.com/owncloud/client/issues/2648#issuecomment-71377909
@@ -912,11 +912,7 @@ void FolderStatusModel::slotSetProgress(const ProgressInfo &progress, Folder *f)
 
     auto *pi = &folder._progress;
 
-    if (progress.status() == ProgressInfo::Done && !progress._lastCompletedItem.isEmpty()
-        && Progress::isWarningKind(progress._lastCompletedItem._status)) {
-        pi->_warningCount++;
-    }
-    // depending on the use of virtual files or small files this slot might be called very often.
+    // the snapshots are already rate limited, but the model does not need to be updated that often.
     // throttle the model updates to prevent an needlessly high cpu usage used on ui updates.
     if (folder._lastProgressUpdateStatus != progress.status() || (std::chrono::steady_clock::now() - folder._lastProgressUpdated > progressUpdateTimeOutC)) {
         folder._lastProgressUpdateStatus = progress.status();
@@ -926,10 +922,10 @@ void FolderStatusModel::slotSetProgress(const ProgressInfo &progress, Folder *f)
             Q_UNREACHABLE();
             break;
         case ProgressInfo::Discovery:
-            if (!progress._currentDiscoveredRemoteFolder.isEmpty()) {
-                pi->_overallSyncString = tr("Checking for changes in remote '%1'").arg(progress._currentDiscoveredRemoteFolder);
-            } else if (!progress._currentDiscoveredLocalFolder.isEmpty()) {
-                pi->_overallSyncString = tr("Checking for changes in local '%1'").arg(progress._currentDiscoveredLocalFolder);
+            if (!progress.currentDiscoveredRemoteFolder().isEmpty()) {
+                pi->_overallSyncString = tr("Checking for changes in remote '%1'").arg(progress.currentDiscoveredRemoteFolder());
+            } else if (!progress.currentDiscoveredLocalFolder().isEmpty()) {
+                pi->_overallSyncString = tr("Checking for changes in local '%1'").arg(progress.currentDiscoveredLocalFolder());
             }
             break;
         case ProgressInfo::Reconcile:
@@ -945,49 +941,23 @@ void FolderStatusModel::slotSetProgress(const ProgressInfo &progress, Folder *f)
     }
 }
 
-void FolderStatusModel::computeProgress(const ProgressInfo &progress, SubFolderInfo::Progress *pi)
+void FolderStatusModel::computeProgress(const ProgressSnapshot &progress, SubFolderInfo::Progress *pi)
 {
-    // find the single item to display:  This is going to be the bigger item, or the last completed
-    // item if no items are in progress.
-    SyncFileItem curItem = progress._lastCompletedItem;
-    qint64 curItemProgress = -1; // -1 means finished
-    qint64 biggerItemSize = 0;
-    quint64 estimatedUpBw = 0;
-    quint64 estimatedDownBw = 0;
-    QStringList allFilenames;
-    for (const auto &citm : progress._currentItems) {
-        if (curItemProgress == -1 || (ProgressInfo::isSizeDependent(citm._item)
-                                         && biggerItemSize < citm._item._size)) {
-            curItemProgress = citm._progress.completed();
-            curItem = citm._item;
-            biggerItemSize = citm._item._size;
-        }
-        if (citm._item._direction != SyncFileItem::Up) {
-            estimatedDownBw += progress.fileProgress(citm._item).estimatedBandwidth;
-        } else {
-            estimatedUpBw += progress.fileProgress(citm._item).estimatedBandwidth;
-        }
-        auto fileName = QFileInfo(citm._item._file).fileName();
-        allFilenames.append(tr("'%1'").arg(fileName));
-    }
-    if (curItemProgress == -1) {
-        curItemProgress = curItem._size;
-    }
+    const auto &curItem = progress.currentItem();
+    const quint64 estimatedUpBw = progress.estimatedUploadBandwidth();
+    const quint64 estimatedDownBw = progress.estimatedDownloadBandwidth();
 
-    const QString itemFileName = curItem._file;
-    const QString kindString = Progress::asActionString(curItem);
+    const QString &itemFileName = curItem.file;
+    const QString &kindString = curItem.actionString;
 
     QString fileProgressString;
-    if (ProgressInfo::isSizeDependent(curItem)) {
-        //quint64 estimatedBw = progress.fileProgress(curItem).estimatedBandwidth;
+    if (curItem.isSizeDependent) {
         if (estimatedUpBw || estimatedDownBw) {
-            /*
-            //: Example text: "uploading foobar.png (1MB of 2MB) time left 2 minutes at a rate of 24Kb/s"
-            fileProgressString = tr("%1 %2 (%3 of %4) %5 left at a rate of %6/s")
-                .arg(kindString, itemFileName, s1, s2,
-                    Utility::durationToDescriptiveString(progress.fileProgress(curItem).estimatedEta),
-                    Utility::octetsToString(estimatedBw) );
-            */
+            QStringList allFilenames;
+            allFilenames.reserve(progress.currentFileNames().size());
+            for (const auto &fileName : progress.currentFileNames()) {
+                allFilenames.append(tr("'%1'").arg(fileName));
+            }
             //: Example text: "Syncing 'foo.txt', 'bar.txt'"
             fileProgressString = tr("Syncing %1").arg(allFilenames.join(QStringLiteral(", ")));
             if (estimatedDownBw > 0) {
@@ -1013,7 +983,7 @@ void FolderStatusModel::computeProgress(const ProgressInfo &progress, SubFolderI
             }
         } else {
             //: Example text: "uploading foobar.png (2MB of 2MB)"
-            fileProgressString = tr("%1 %2 (%3 of %4)").arg(kindString, itemFileName, Utility::octetsToString(curItemProgress), Utility::octetsToString(curItem._size));
+            fileProgressString = tr("%1 %2 (%3 of %4)").arg(kindString, itemFileName, Utility::octetsToString(curItem.completed), Utility::octetsToString(curItem.size));
         }
     } else if (!kindString.isEmpty()) {
         //: Example text: "uploading foobar.png"
@@ -1038,7 +1008,7 @@ void FolderStatusModel::computeProgress(const ProgressInfo &progress, SubFolderI
                                     .arg(s1, s2)
                                     .arg(currentFile)
                                     .arg(totalFileCount)
-                                    .arg(Utility::durationToDescriptiveString1(progress.totalProgress().estimatedEta));
+                                    .arg(Utility::durationToDescriptiveString1(progress.estimatedEta()));
 
         } else {
             //: Example text: "12 MB of 345 MB, file 6 of 7"
@@ -1091,16 +1061,17 @@ void FolderStatusModel::slotFolderSyncStateChange(Folder *f)
         // Reset progress info.
         pi = SubFolderInfo::Progress();
     } else if (state == SyncResult::NotYetStarted) {
+        pi = SubFolderInfo::Progress();
         FolderMan *folderMan = FolderMan::instance();
-        int pos = folderMan->scheduleQueue().indexOf(f);
-        for (auto other : folderMan->folders()) {
-            if (other != f && other->isSyncRunning())
-                pos += 1;
-        }
-        if (pos > 0) {
-            pi._overallSyncString = tr("Waiting for %n other folder(s)...", "", pos);
+        const int queuePosition = folderMan->queuePosition(f);
+        if (queuePosition >= 0) {
+            // the folders queued before us take the free slots first
+            const int freeSlots = qMax(0, folderMan->maxParallelSyncs() - folderMan->runningSyncCount());
+            const int pos = queuePosition >= freeSlots ? queuePosition - freeSlots + 1 : 0;
+            if (pos > 0) {
+                pi._overallSyncString = tr("Waiting for %n other folder(s)...", "", pos);
+            }
         }
-        pi = SubFolderInfo::Progress();
     } else if (state == SyncResult::SyncPrepare) {
         pi = SubFolderInfo::Progress();
         pi._overallSyncString = Theme::instance()->statusHeaderText(SyncResult::SyncPrepare);
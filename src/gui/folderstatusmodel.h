@@ -177,7 +177,7 @@ public slots:
     void resetFolders();
     void slotSyncAllPendingBigFolders();
     void slotSyncNoPendingBigFolders();
-    void slotSetProgress(const ProgressInfo &progress, Folder *f);
+    void slotSetProgress(const ProgressSnapshot &progress, Folder *f);
 
 private slots:
     void slotUpdateDirectories(const QStringList &);
@@ -196,7 +196,7 @@ private slots:
 private:
     QStringList createBlackList(const OCC::FolderStatusModel::SubFolderInfo &root,
         const QStringList &oldBlackList) const;
-    void computeProgress(const ProgressInfo &progress, SubFolderInfo::Progress *pi);
+    void computeProgress(const ProgressSnapshot &progress, SubFolderInfo::Progress *pi);
     int indexOf(Folder *f) const;
 
     ItemType classify(const QModelIndex &index) const;
@@ -162,7 +162,7 @@ IssuesWidget::IssuesWidget(QWidget *parent)
             auto item = SyncFileItemPtr::create();
             item->_status = SyncFileItem::NormalError;
             item->_errorString = message;
-            _model->addProtocolItem(ProtocolItem { folder, item });
+            addItem(ProtocolItem { folder, item });
         });
 
     connect(ProgressDispatcher::instance(), &ProgressDispatcher::excluded, this, [this](Folder *f, const QString &file, CSYNC_EXCLUDE_TYPE reason) {
@@ -176,7 +176,7 @@ IssuesWidget::IssuesWidget(QWidget *parent)
         default:
             Q_UNREACHABLE();
         }
-        _model->addProtocolItem(ProtocolItem { f, item });
+        addItem(ProtocolItem { f, item });
     });
 
     _model = new ProtocolItemModel(20000, true, this);
@@ -209,14 +209,13 @@ IssuesWidget::IssuesWidget(QWidget *parent)
     });
 
     _ui->_tooManyIssuesWarning->hide();
-    connect(_model, &ProtocolItemModel::rowsInserted, this, [this] {
+    const auto updateIssueCount = [this] {
         Q_EMIT issueCountUpdated(_model->rowCount());
         _ui->_tooManyIssuesWarning->setVisible(_model->isModelFull());
-    });
-    connect(_model, &ProtocolItemModel::modelReset, this, [this] {
-        Q_EMIT issueCountUpdated(_model->rowCount());
-        _ui->_tooManyIssuesWarning->setVisible(_model->isModelFull());
-    });
+    };
+    connect(_model, &ProtocolItemModel::rowsInserted, this, updateIssueCount);
+    connect(_model, &ProtocolItemModel::rowsRemoved, this, updateIssueCount);
+    connect(_model, &ProtocolItemModel::modelReset, this, updateIssueCount);
 
     _ui->_conflictHelp->hide();
     _ui->_conflictHelp->setText(
@@ -224,8 +223,8 @@ IssuesWidget::IssuesWidget(QWidget *parent)
             .arg(Theme::instance()->conflictHelpUrl()));
 
     connect(FolderMan::instance(), &FolderMan::folderRemoved, this, [this](Folder *f) {
-        _model->remove_if([f](const ProtocolItem &item) {
-            return item.folder() == f;
+        _model->remove_if(f, [](const ProtocolItem &) {
+            return true;
         });
     });
 }
@@ -262,17 +261,18 @@ void IssuesWidget::addResetFiltersAction(QMenu *menu, const QList<std::function<
     });
 }
 
-void IssuesWidget::slotProgressInfo(Folder *folder, const ProgressInfo &progress)
+void IssuesWidget::slotProgressInfo(Folder *folder, const ProgressSnapshot &progress)
 {
+    if (progress.status() == ProgressInfo::Done) {
+        // the conflicts below are collected from the model
+        _model->flushQueuedItems();
+    }
     if (progress.status() == ProgressInfo::Reconcile) {
         // Wipe all non-persistent entries - as well as the persistent ones
         // in cases where a local discovery was done.
         const auto &engine = folder->syncEngine();
         const auto style = engine.lastLocalDiscoveryStyle();
-        _model->remove_if([&](const ProtocolItem &item) {
-            if (item.folder() != folder) {
-                return false;
-            }
+        _model->remove_if(folder, [&](const ProtocolItem &item) {
             if (item.direction() == SyncFileItem::None && item.status() != SyncFileItem::Excluded) {
                 // TODO: don't clear syncErrors and excludes for now.
                 // make them either unique or remove them on the next sync?
@@ -300,12 +300,11 @@ void IssuesWidget::slotProgressInfo(Folder *folder, const ProgressInfo &progress
         // We keep track very well of pending conflicts.
         // Inform other components about them.
         QStringList conflicts;
-        for (const auto &data : _model->rawData()) {
-            if (data.folder() == folder
-                && data.status() == SyncFileItem::Conflict) {
+        _model->forEachItem(folder, [&conflicts](const ProtocolItem &data) {
+            if (data.status() == SyncFileItem::Conflict) {
                 conflicts.append(data.path());
             }
-        }
+        });
         emit ProgressDispatcher::instance()->folderConflicts(folder, conflicts);
 
         _ui->_conflictHelp->setHidden(Theme::instance()->conflictHelpUrl().isEmpty() || conflicts.isEmpty());
@@ -316,7 +315,12 @@ void IssuesWidget::slotItemCompleted(Folder *folder, const SyncFileItemPtr &item
 {
     if (!item->showInIssuesTab())
         return;
-    _model->addProtocolItem(ProtocolItem { folder, item });
+    addItem(ProtocolItem { folder, item });
+}
+
+void IssuesWidget::addItem(ProtocolItem &&item)
+{
+    _model->queueProtocolItem(std::move(item));
 }
 
 void IssuesWidget::filterDidChange()
@@ -51,7 +51,7 @@ public:
     ~IssuesWidget() override;
 
 public slots:
-    void slotProgressInfo(Folder *folder, const ProgressInfo &progress);
+    void slotProgressInfo(Folder *folder, const ProgressSnapshot &progress);
     void slotItemCompleted(Folder *folder, const SyncFileItemPtr &item);
     void filterDidChange();
 
@@ -66,6 +66,8 @@ private:
     static void addResetFiltersAction(QMenu *menu, const QList<std::function<void()>> &resetFunctions);
     std::function<void()> addStatusFilter(QMenu *menu);
 
+    void addItem(ProtocolItem &&item);
+
     ProtocolItemModel *_model;
     Models::SignalledQSortFilterProxyModel *_sortModel;
     SyncFileItemStatusSetSortFilterProxyModel *_statusSortModel;
@@ -23,6 +23,7 @@
 #include "account.h"
 #include "accountmanager.h"
 #include "accountstate.h"
+#include "activitystore.h"
 #include "folderman.h"
 #include "guiutility.h"
 #include "models.h"
@@ -185,14 +186,27 @@ bool ActivityListModel::canFetchMore(const QModelIndex &) const
 
 void ActivityListModel::startFetchJob(AccountStatePtr ast)
 {
-    if (!ast || !ast->isConnected()) {
+    if (!ast || !ast->isConnected() || _currentlyFetching.contains(ast)) {
         return;
     }
-    auto *job = new JsonApiJob(ast->account(), QStringLiteral("ocs/v2.php/cloud/activity"), { { QStringLiteral("page"), QStringLiteral("0") }, { QStringLiteral("pagesize"), QStringLiteral("100") } }, {}, this);
+    ensureLoaded(ast);
+    _currentlyFetching.insert(ast);
+    qCInfo(lcActivity) << "Start fetching activities for " << ast->account()->displayName();
+    fetchPage(ast, 0, {}, {});
+}
+
+void ActivityListModel::fetchPage(const AccountStatePtr &ast, int page, ActivityList &&fetched, const Utility::ChronoElapsedTimer &timer)
+{
+    const int pageSize = 100;
+    auto *job = new JsonApiJob(ast->account(), QStringLiteral("ocs/v2.php/cloud/activity"),
+        { { QStringLiteral("page"), QString::number(page) }, { QStringLiteral("pagesize"), QString::number(pageSize) } }, {}, this);
 
     QObject::connect(job, &JsonApiJob::finishedSignal,
-        this, [job, ast, this] {
-            _currentlyFetching.remove(ast);
+        this, [job, ast, page, fetched = std::move(fetched), timer, this]() mutable {
+            if (!_currentlyFetching.contains(ast)) {
+                // the account was removed in the meantime
+                return;
+            }
             const auto activities = job->data().value(QStringLiteral("ocs")).toObject().value(QStringLiteral("data")).toArray();
 
             /*
@@ -202,44 +216,70 @@ void ActivityListModel::startFetchJob(AccountStatePtr ast)
              * to support this new behavior, we have to fake the expected status code
              */
             if (job->reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
+                _currentlyFetching.remove(ast);
                 emit activityJobStatusCode(ast, 999);
                 return;
             }
 
-            ActivityList list;
-            list.reserve(activities.size());
+            // the activities are sorted newest first, stop at the first one we already know
+            const auto &known = _activityLists[ast];
+            const Activity::Identifier newestKnownId = known.isEmpty() ? -1 : known.first().id();
+            bool reachedKnown = false;
             for (const auto &activ : activities) {
-                const auto json = activ.toObject();
-                list.append(Activity { Activity::ActivityType,
-                    json.value(QStringLiteral("id")).toVariant().value<Activity::Identifier>(),
-                    ast->account(),
-                    json.value(QStringLiteral("subject")).toString(),
-                    json.value(QStringLiteral("message")).toString(),
-                    json.value(QStringLiteral("file")).toString(),
-                    QUrl(json.value(QStringLiteral("link")).toString()),
-                    QDateTime::fromString(json.value(QStringLiteral("date")).toString(), Qt::ISODate) });
+                auto activity = Activity::fromJson(activ.toObject(), ast->account());
+                if (activity.id() <= newestKnownId) {
+                    reachedKnown = true;
+                    break;
+                }
+                fetched.append(std::move(activity));
             }
 
-            _activityLists[ast] = std::move(list);
+            if (!reachedKnown && activities.size() == pageSize && fetched.size() < ActivityStore::MaxActivities) {
+                fetchPage(ast, page + 1, std::move(fetched), timer);
+                return;
+            }
 
-            emit activityJobStatusCode(ast, job->ocsStatus());
+            _currentlyFetching.remove(ast);
+            const auto newActivities = fetched.size();
+            mergeActivities(ast, fetched);
+            if (newActivities > 0) {
+                ActivityStore::save(ast->account(), _activityLists[ast]);
+            }
+            qCInfo(lcActivity) << "Fetched" << newActivities << "new activities in" << page + 1 << "pages for" << ast->account()->displayName() << "in" << timer.duration();
 
-            combineActivityLists();
+            emit activityJobStatusCode(ast, job->ocsStatus());
         });
-
-    _currentlyFetching.insert(ast);
-    qCInfo(lcActivity) << "Start fetching activities for " << ast->account()->displayName();
     job->start();
 }
 
+void ActivityListModel::ensureLoaded(const AccountStatePtr &ast)
+{
+    if (!ast || _activityLists.contains(ast)) {
+        return;
+    }
+    _activityLists.insert(ast, {});
+    mergeActivities(ast, ActivityStore::load(ast->account()));
+}
 
-void ActivityListModel::combineActivityLists()
+void ActivityListModel::mergeActivities(const AccountStatePtr &ast, const ActivityList &newActivities)
 {
-    ActivityList resultList;
-    for (const ActivityList &list : qAsConst(_activityLists)) {
-        resultList.append(list);
+    auto &list = _activityLists[ast];
+    if (!newActivities.isEmpty()) {
+        // the rows are sorted by the view, new ones are simply prepended
+        beginInsertRows(QModelIndex(), 0, newActivities.size() - 1);
+        _finalList = newActivities + _finalList;
+        endInsertRows();
+        list = newActivities + list;
+    }
+
+    while (list.size() > ActivityStore::MaxActivities) {
+        const int row = _finalList.lastIndexOf(list.takeLast());
+        if (row != -1) {
+            beginRemoveRows(QModelIndex(), row, row);
+            _finalList.removeAt(row);
+            endRemoveRows();
+        }
     }
-    setActivityList(std::move(resultList));
 }
 
 void ActivityListModel::setActivityList(const ActivityList &&resultList)
@@ -253,7 +293,6 @@ void ActivityListModel::fetchMore(const QModelIndex &)
 {
     for (const AccountStatePtr &asp : AccountManager::instance()->accounts()) {
         if (!_activityLists.contains(asp) && asp->isConnected()) {
-            _activityLists[asp] = ActivityList();
             startFetchJob(asp);
         }
     }
@@ -261,9 +300,8 @@ void ActivityListModel::fetchMore(const QModelIndex &)
 
 void ActivityListModel::slotRefreshActivity(const AccountStatePtr &ast)
 {
-    if (ast && _activityLists.contains(ast)) {
-        _activityLists.remove(ast);
-    }
+    // show the stored activities while we are offline
+    ensureLoaded(ast);
     startFetchJob(ast);
 }
 
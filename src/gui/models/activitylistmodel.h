@@ -19,6 +19,7 @@
 
 #include "accountstate.h"
 #include "activitydata.h"
+#include "common/chronoelapsedtimer.h"
 
 class QJsonDocument;
 
@@ -31,6 +32,10 @@ Q_DECLARE_LOGGING_CATEGORY(lcActivity)
  * @ingroup gui
  *
  * Simple list model to provide the list view with data.
+ *
+ * The activities of an account are kept in the ActivityStore. A refresh
+ * only fetches the pages with activities newer than the ones we already
+ * know and inserts them into the model.
  */
 
 class ActivityListModel : public QAbstractTableModel
@@ -71,7 +76,12 @@ signals:
 private:
     void setActivityList(const ActivityList &&resultList);
     void startFetchJob(AccountStatePtr s);
-    void combineActivityLists();
+    /// Fetches the page of the activity API, fetched are the new activities of the previous pages
+    void fetchPage(const AccountStatePtr &ast, int page, ActivityList &&fetched, const Utility::ChronoElapsedTimer &timer);
+    /// Loads the stored activities of the account if that didn't happen yet
+    void ensureLoaded(const AccountStatePtr &ast);
+    /// Inserts the new activities, newest first, and drops the oldest ones of the account
+    void mergeActivities(const AccountStatePtr &ast, const ActivityList &newActivities);
 
     QMap<AccountStatePtr, ActivityList> _activityLists;
     ActivityList _finalList;
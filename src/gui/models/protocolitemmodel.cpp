@@ -24,11 +24,20 @@
 
 using namespace OCC;
 
+namespace {
+// if a removal is split in more ranges than this, a single reset is cheaper than notifying each range
+constexpr size_t maxRemoveRangeNotifications = 32;
+}
+
 ProtocolItemModel::ProtocolItemModel(size_t size, bool issueMode, QObject *parent)
     : QAbstractTableModel(parent)
     , _data(size)
+    , _sequence(size)
     , _issueMode(issueMode)
 {
+    _queuedItemsTimer.setSingleShot(true);
+    _queuedItemsTimer.setInterval(100);
+    connect(&_queuedItemsTimer, &QTimer::timeout, this, &ProtocolItemModel::flushQueuedItems);
 }
 
 int ProtocolItemModel::rowCount(const QModelIndex &parent) const
@@ -173,15 +182,57 @@ void ProtocolItemModel::addProtocolItem(ProtocolItem &&item)
 {
     if (_data.isFull()) {
         beginRemoveRows(QModelIndex(), 0, 0);
-        _data.pop_front();
+        popFront();
         endRemoveRows();
     }
     const auto size = static_cast<int>(_data.size());
     beginInsertRows(QModelIndex(), size, size);
-    _data.push_back(std::move(item));
+    pushBack(std::move(item));
     endInsertRows();
 }
 
+void ProtocolItemModel::addProtocolItems(std::vector<ProtocolItem> &&items)
+{
+    if (items.empty()) {
+        return;
+    }
+    // only the newest items fit into the buffer
+    auto first = items.begin();
+    if (items.size() > _data.capacity()) {
+        first = items.end() - static_cast<std::ptrdiff_t>(_data.capacity());
+    }
+    const auto incoming = static_cast<size_t>(std::distance(first, items.end()));
+    if (_data.size() + incoming > _data.capacity()) {
+        const auto overflow = _data.size() + incoming - _data.capacity();
+        beginRemoveRows(QModelIndex(), 0, static_cast<int>(overflow) - 1);
+        for (size_t i = 0; i < overflow; ++i) {
+            popFront();
+        }
+        endRemoveRows();
+    }
+    const auto size = static_cast<int>(_data.size());
+    beginInsertRows(QModelIndex(), size, size + static_cast<int>(incoming) - 1);
+    for (; first != items.end(); ++first) {
+        pushBack(std::move(*first));
+    }
+    endInsertRows();
+}
+
+void ProtocolItemModel::queueProtocolItem(ProtocolItem &&item)
+{
+    _queuedItems.push_back(std::move(item));
+    if (!_queuedItemsTimer.isActive()) {
+        _queuedItemsTimer.start();
+    }
+}
+
+void ProtocolItemModel::flushQueuedItems()
+{
+    _queuedItemsTimer.stop();
+    addProtocolItems(std::move(_queuedItems));
+    _queuedItems.clear();
+}
+
 const ProtocolItem &ProtocolItemModel::protocolItem(const QModelIndex &index) const
 {
     Q_ASSERT(checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid));
@@ -191,16 +242,152 @@ const ProtocolItem &ProtocolItemModel::protocolItem(const QModelIndex &index) co
 void ProtocolItemModel::reset(std::vector<ProtocolItem> &&data)
 {
     beginResetModel();
+    std::vector<quint64> sequence;
+    sequence.reserve(data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        sequence.push_back(_nextSequence++);
+    }
     _data.reset(std::move(data));
+    _sequence.reset(std::move(sequence));
+    rebuildFolderIndex();
     endResetModel();
 }
 
 void ProtocolItemModel::remove_if(const std::function<bool(const ProtocolItem &)> &filter)
 {
-    if (_data.empty()) {
+    flushQueuedItems();
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < _data.size(); ++i) {
+        if (filter(_data.at(i))) {
+            rows.push_back(i);
+        }
+    }
+    removeSortedRows(rows);
+}
+
+void ProtocolItemModel::remove_if(Folder *folder, const std::function<bool(const ProtocolItem &)> &filter)
+{
+    flushQueuedItems();
+    const auto it = _folderIndex.constFind(folder);
+    if (it == _folderIndex.cend()) {
         return;
     }
-    beginResetModel();
-    _data.remove_if(filter);
-    endResetModel();
+    std::vector<size_t> rows;
+    for (const auto sequence : *it) {
+        const auto row = rowForSequence(sequence);
+        if (filter(_data.at(row))) {
+            rows.push_back(row);
+        }
+    }
+    removeSortedRows(rows);
+}
+
+void ProtocolItemModel::forEachItem(Folder *folder, const std::function<void(const ProtocolItem &)> &f) const
+{
+    const auto it = _folderIndex.constFind(folder);
+    if (it == _folderIndex.cend()) {
+        return;
+    }
+    for (const auto sequence : *it) {
+        f(_data.at(rowForSequence(sequence)));
+    }
+}
+
+void ProtocolItemModel::pushBack(ProtocolItem &&item)
+{
+    const quint64 sequence = _nextSequence++;
+    _folderIndex[item.folder()].push_back(sequence);
+    _sequence.push_back(quint64(sequence));
+    _data.push_back(std::move(item));
+}
+
+void ProtocolItemModel::popFront()
+{
+    auto it = _folderIndex.find(_data.at(0).folder());
+    Q_ASSERT(it != _folderIndex.end() && it->front() == _sequence.at(0));
+    it->pop_front();
+    if (it->empty()) {
+        _folderIndex.erase(it);
+    }
+    _data.pop_front();
+    _sequence.pop_front();
+}
+
+void ProtocolItemModel::removeSortedRows(const std::vector<size_t> &rows)
+{
+    if (rows.empty()) {
+        return;
+    }
+    Q_ASSERT(std::is_sorted(rows.cbegin(), rows.cend()));
+
+    // the rows are ascending, so are the sequences removed per folder
+    QHash<Folder *, std::vector<quint64>> removed;
+    for (const auto row : rows) {
+        removed[_data.at(row).folder()].push_back(_sequence.at(row));
+    }
+    for (auto it = removed.cbegin(); it != removed.cend(); ++it) {
+        auto &index = _folderIndex[it.key()];
+        auto next = it->cbegin();
+        index.erase(std::remove_if(index.begin(), index.end(), [&next, end = it->cend()](quint64 sequence) {
+            if (next != end && *next == sequence) {
+                ++next;
+                return true;
+            }
+            return false;
+        }),
+            index.end());
+        if (index.empty()) {
+            _folderIndex.remove(it.key());
+        }
+    }
+
+    // group the rows into contiguous ranges of [first, count]
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (const auto row : rows) {
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == row) {
+            ++ranges.back().second;
+        } else {
+            ranges.emplace_back(row, 1);
+        }
+    }
+
+    if (ranges.size() > maxRemoveRangeNotifications) {
+        beginResetModel();
+        _data.erase(rows);
+        _sequence.erase(rows);
+        endResetModel();
+        return;
+    }
+    // remove from the back so the rows of the remaining ranges stay valid
+    for (auto it = ranges.crbegin(); it != ranges.crend(); ++it) {
+        beginRemoveRows(QModelIndex(), static_cast<int>(it->first), static_cast<int>(it->first + it->second) - 1);
+        _data.erase(it->first, it->second);
+        _sequence.erase(it->first, it->second);
+        endRemoveRows();
+    }
+}
+
+size_t ProtocolItemModel::rowForSequence(quint64 sequence) const
+{
+    // _sequence is ascending in row order
+    size_t low = 0;
+    size_t high = _sequence.size();
+    while (low < high) {
+        const auto mid = low + (high - low) / 2;
+        if (_sequence.at(mid) < sequence) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    Q_ASSERT(low < _sequence.size() && _sequence.at(low) == sequence);
+    return low;
+}
+
+void ProtocolItemModel::rebuildFolderIndex()
+{
+    _folderIndex.clear();
+    for (size_t i = 0; i < _data.size(); ++i) {
+        _folderIndex[_data.at(i).folder()].push_back(_sequence.at(i));
+    }
 }
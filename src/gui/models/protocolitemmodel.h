@@ -14,11 +14,14 @@
 #pragma once
 
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QTimer>
 
 #include "protocolitem.h"
 
 #include "common/fixedsizeringbuffer.h"
 
+#include <deque>
 
 namespace OCC {
 
@@ -52,6 +55,23 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 
     void addProtocolItem(ProtocolItem &&item);
+
+    /**
+     * Append multiple items with a single insert notification.
+     * If the buffer overflows the oldest items are removed with a single remove notification.
+     */
+    void addProtocolItems(std::vector<ProtocolItem> &&items);
+
+    /**
+     * Completed items arrive in bursts, queued items are added in a batch after a short delay.
+     */
+    void queueProtocolItem(ProtocolItem &&item);
+
+    /**
+     * Add the queued items now.
+     */
+    void flushQueuedItems();
+
     const ProtocolItem &protocolItem(const QModelIndex &index) const;
 
     bool isModelFull() const
@@ -62,17 +82,47 @@ public:
     /**
      * Return underlying unordered raw data
      */
-    auto rawData() const
+    const auto &rawData() const
     {
         return _data;
     }
 
     void reset(std::vector<ProtocolItem> &&data);
 
+    /**
+     * Remove all items matching filter, the queued items are added first.
+     * Contiguous rows are removed with one notification per range,
+     * only if the removal is very fragmented the model is reset.
+     */
     void remove_if(const std::function<bool(const ProtocolItem &)> &filter);
 
+    /**
+     * Like remove_if but only the items of folder are passed to filter.
+     * The cost depends on the number of items of folder, not on the size of the model.
+     */
+    void remove_if(Folder *folder, const std::function<bool(const ProtocolItem &)> &filter);
+
+    /**
+     * Call f for every item of folder, in the order they were added.
+     */
+    void forEachItem(Folder *folder, const std::function<void(const ProtocolItem &)> &f) const;
+
 private:
+    void pushBack(ProtocolItem &&item);
+    void popFront();
+    void removeSortedRows(const std::vector<size_t> &rows);
+    size_t rowForSequence(quint64 sequence) const;
+    void rebuildFolderIndex();
+
     FixedSizeRingBuffer<ProtocolItem> _data;
+    // a stable, ascending id for each entry in _data, used to locate the rows of a folder
+    FixedSizeRingBuffer<quint64> _sequence;
+    quint64 _nextSequence = 0;
+    QHash<Folder *, std::deque<quint64>> _folderIndex;
+
+    std::vector<ProtocolItem> _queuedItems;
+    QTimer _queuedItemsTimer;
+
     bool _issueMode;
     int _maxLogSize;
 
@@ -0,0 +1,635 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#include "remotefoldertreemodel.h"
+
+#include "account.h"
+#include "common/syncjournaldb.h"
+#include "common/utility.h"
+#include "configfile.h"
+#include "folderman.h"
+#include "networkjobs.h"
+#include "theme.h"
+
+#include <QCollator>
+#include <QFileIconProvider>
+#include <QFutureWatcher>
+#include <QLoggingCategory>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+QString chopTrailingSlash(QString path)
+{
+    if (path.endsWith(QLatin1Char('/'))) {
+        path.chop(1);
+    }
+    return path;
+}
+
+QString withTrailingSlash(const QString &path)
+{
+    return path.endsWith(QLatin1Char('/')) ? path : path + QLatin1Char('/');
+}
+}
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcRemoteFolderTreeModel, "gui.models.remotefoldertree", QtInfoMsg)
+
+struct RemoteFolderTreeModel::Node
+{
+    QString name;
+    // relative to the sync root, including the trailing /, empty for the root
+    QString path;
+    Node *parent = nullptr;
+    int row = 0;
+
+    // the rows known to the view, the first children.size() entries of listing
+    std::vector<std::unique_ptr<Node>> children;
+    // the sorted listing of the folder
+    std::vector<Entry> listing;
+
+    enum class State {
+        NotFetched,
+        Fetching,
+        Fetched
+    };
+    State state = State::NotFetched;
+    // whether listing was provided by the server or by the journal
+    bool fromServer = false;
+    // identifies the latest listing request, results of older requests are dropped
+    quint64 generation = 0;
+
+    bool hasPendingRows() const { return children.size() < listing.size(); }
+};
+
+RemoteFolderTreeModel::RemoteFolderTreeModel(const AccountPtr &account, const QString &folderPath, const QString &rootName, const QStringList &oldBlackList, SyncJournalDb *journal, QObject *parent)
+    : QAbstractItemModel(parent)
+    , _account(account)
+    , _folderPath(withTrailingSlash(folderPath))
+    , _rootName(rootName)
+    , _oldBlackList(oldBlackList)
+    , _journal(journal)
+    , _root(new Node)
+    , _folderIcon(QFileIconProvider().icon(QFileIconProvider::Folder))
+{
+    _nodes.insert(QString(), _root.get());
+
+    ConfigFile::setupDefaultExcludeFilePaths(_excludedFiles);
+    _excludedFiles.reloadExcludeFiles();
+
+    // Since / cannot be in the blacklist, it is expanded to the actual
+    // list of top-level folders as soon as we know them.
+    if (_oldBlackList.size() == 1 && _oldBlackList.contains(QStringLiteral("/"))) {
+        _expandRootBlackList = true;
+    } else {
+        // only keep the top most entries, the check states are derived from them
+        QStringList sorted = _oldBlackList;
+        std::sort(sorted.begin(), sorted.end());
+        for (const auto &path : qAsConst(sorted)) {
+            if (path.isEmpty() || path == QLatin1Char('/')) {
+                continue;
+            }
+            const auto normalized = withTrailingSlash(path);
+            if (!isBlackListed(normalized)) {
+                _blackList.insert(normalized);
+            }
+        }
+    }
+}
+
+RemoteFolderTreeModel::~RemoteFolderTreeModel() = default;
+
+void RemoteFolderTreeModel::load()
+{
+    startListing(_root.get());
+}
+
+RemoteFolderTreeModel::Node *RemoteFolderTreeModel::nodeForIndex(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return nullptr;
+    }
+    return static_cast<Node *>(index.internalPointer());
+}
+
+QModelIndex RemoteFolderTreeModel::indexForNode(const Node *node, int column) const
+{
+    if (node == _root.get() && !_rootVisible) {
+        return {};
+    }
+    return createIndex(node->row, column, const_cast<Node *>(node));
+}
+
+QModelIndex RemoteFolderTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (row < 0 || column < 0 || column >= static_cast<int>(Column::ColumnCount)) {
+        return {};
+    }
+    const auto *parentNode = nodeForIndex(parent);
+    if (!parentNode) {
+        if (row == 0 && _rootVisible) {
+            return createIndex(0, column, _root.get());
+        }
+        return {};
+    }
+    if (row >= static_cast<int>(parentNode->children.size())) {
+        return {};
+    }
+    return createIndex(row, column, parentNode->children[row].get());
+}
+
+QModelIndex RemoteFolderTreeModel::parent(const QModelIndex &child) const
+{
+    const auto *node = nodeForIndex(child);
+    if (!node || !node->parent) {
+        return {};
+    }
+    return indexForNode(node->parent);
+}
+
+int RemoteFolderTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) {
+        return 0;
+    }
+    const auto *node = nodeForIndex(parent);
+    if (!node) {
+        return _rootVisible ? 1 : 0;
+    }
+    return static_cast<int>(node->children.size());
+}
+
+int RemoteFolderTreeModel::columnCount(const QModelIndex &) const
+{
+    return static_cast<int>(Column::ColumnCount);
+}
+
+bool RemoteFolderTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) {
+        return false;
+    }
+    const auto *node = nodeForIndex(parent);
+    if (!node) {
+        return _rootVisible;
+    }
+    // we don't know yet, show the expander
+    if (node->state != Node::State::Fetched) {
+        return true;
+    }
+    return !node->listing.empty();
+}
+
+bool RemoteFolderTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    const auto *node = nodeForIndex(parent);
+    if (!node) {
+        return false;
+    }
+    return node->state == Node::State::NotFetched || node->hasPendingRows();
+}
+
+void RemoteFolderTreeModel::fetchMore(const QModelIndex &parent)
+{
+    auto *node = nodeForIndex(parent);
+    if (!node) {
+        return;
+    }
+    if (node->state == Node::State::NotFetched) {
+        startListing(node);
+    }
+    publishPage(node);
+}
+
+QVariant RemoteFolderTreeModel::data(const QModelIndex &index, int role) const
+{
+    const auto *node = nodeForIndex(index);
+    if (!node) {
+        return {};
+    }
+    const bool isRoot = node == _root.get();
+    switch (static_cast<Column>(index.column())) {
+    case Column::Name:
+        switch (role) {
+        case Qt::DisplayRole:
+            return isRoot ? _rootName : node->name;
+        case Qt::DecorationRole:
+            return isRoot ? Theme::instance()->applicationIcon() : _folderIcon;
+        case Qt::ToolTipRole:
+            return isRoot ? QVariant() : chopTrailingSlash(node->path);
+        case Qt::CheckStateRole:
+            return checkState(node);
+        }
+        break;
+    case Column::Size:
+        if (role == Qt::DisplayRole) {
+            const auto size = _sizes.value(node->path, -1);
+            if (size >= 0) {
+                return Utility::octetsToString(size);
+            }
+        }
+        break;
+    case Column::ColumnCount:
+        Q_UNREACHABLE();
+    }
+    return {};
+}
+
+bool RemoteFolderTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    auto *node = nodeForIndex(index);
+    if (!node || role != Qt::CheckStateRole || static_cast<Column>(index.column()) != Column::Name) {
+        return false;
+    }
+    return setCheckState(node, static_cast<Qt::CheckState>(value.toInt()));
+}
+
+Qt::ItemFlags RemoteFolderTreeModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    if (static_cast<Column>(index.column()) == Column::Name) {
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsUserCheckable;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+QVariant RemoteFolderTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (static_cast<Column>(section)) {
+        case Column::Name:
+            return tr("Name");
+        case Column::Size:
+            return tr("Size");
+        case Column::ColumnCount:
+            Q_UNREACHABLE();
+        }
+    }
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+void RemoteFolderTreeModel::startListing(Node *node)
+{
+    node->state = Node::State::Fetching;
+    node->generation = ++_nextGeneration;
+    const QString path = node->path;
+    const quint64 generation = node->generation;
+
+    // display what we already know while we wait for the server
+    if (_journal && node != _root.get()) {
+        std::vector<Entry> known;
+        _journal->listFilesInPath(chopTrailingSlash(path).toUtf8(), [&known](const SyncJournalFileRecord &rec) {
+            if (rec.isDirectory()) {
+                const auto name = QString::fromUtf8(rec._path.mid(rec._path.lastIndexOf('/') + 1));
+                if (!name.isEmpty()) {
+                    known.push_back({ name, -1 });
+                }
+            }
+        });
+        if (!known.empty()) {
+            sortInBackground(path, generation, std::move(known), false);
+        }
+    }
+
+    QString requestPath = _folderPath + path;
+    if (requestPath.size() > 1) {
+        requestPath.chop(1);
+    }
+    // TODO: legacy
+    auto *job = new PropfindJob(_account, _account->davUrl(), requestPath, PropfindJob::Depth::One, this);
+    job->setProperties({ QByteArrayLiteral("resourcetype"), QByteArrayLiteral("http://owncloud.org/ns:size") });
+    connect(job, &PropfindJob::directoryListingSubfolders, this, [job, path, generation, this](const QStringList &list) {
+        slotListing(path, generation, list, job->sizes());
+    });
+    connect(job, &PropfindJob::finishedWithError, this, [path, generation, this](QNetworkReply *reply) {
+        auto *node = _nodes.value(path);
+        if (!node || node->generation != generation) {
+            return;
+        }
+        qCWarning(lcRemoteFolderTreeModel) << "Failed to list" << path << reply->errorString();
+        // keep what the journal told us, don't retry on every expansion
+        node->state = Node::State::Fetched;
+        if (node == _root.get() && !_rootVisible) {
+            Q_EMIT loadingFailed(reply);
+        } else if (node->listing.empty()) {
+            // remove the expander
+            const auto idx = indexForNode(node);
+            Q_EMIT dataChanged(idx, idx);
+        }
+    });
+    job->start();
+}
+
+void RemoteFolderTreeModel::slotListing(const QString &path, quint64 generation, const QStringList &hrefs, const QHash<QString, qint64> &sizes)
+{
+    auto *node = _nodes.value(path);
+    if (!node || node->generation != generation) {
+        return;
+    }
+
+    const QString basePath = withTrailingSlash(Utility::concatUrlPath(_account->davUrl(), _folderPath).path());
+    const QString listedPath = basePath + path;
+    const bool ignoreHidden = FolderMan::instance()->ignoreHiddenFiles();
+
+    std::vector<Entry> entries;
+    entries.reserve(hrefs.size());
+    for (const auto &href : hrefs) {
+        if (withTrailingSlash(href) == listedPath) {
+            // the listed folder itself
+            _sizes.insert(path, sizes.value(href, sizes.value(chopTrailingSlash(listedPath), -1)));
+            continue;
+        }
+        if (!href.startsWith(listedPath)) {
+            continue;
+        }
+        const QString name = chopTrailingSlash(href.mid(listedPath.size()));
+        if (name.isEmpty() || name.contains(QLatin1Char('/'))) {
+            continue;
+        }
+        if (_excludedFiles.isExcludedRemote(href, basePath, ignoreHidden, ItemTypeDirectory)) {
+            continue;
+        }
+        const qint64 size = sizes.value(href, -1);
+        _sizes.insert(path + name + QLatin1Char('/'), size);
+        entries.push_back({ name, size });
+    }
+
+    if (node == _root.get() && !_rootVisible) {
+        if (_expandRootBlackList) {
+            _expandRootBlackList = false;
+            _oldBlackList.clear();
+            for (const auto &entry : entries) {
+                const QString childPath = entry.name + QLatin1Char('/');
+                _oldBlackList.append(childPath);
+                _blackList.insert(childPath);
+            }
+        }
+        if (entries.empty()) {
+            node->state = Node::State::Fetched;
+            Q_EMIT loaded(false);
+            return;
+        }
+    }
+
+    sortInBackground(path, generation, std::move(entries), true);
+}
+
+void RemoteFolderTreeModel::sortInBackground(const QString &path, quint64 generation, std::vector<Entry> &&entries, bool fromServer)
+{
+    auto *watcher = new QFutureWatcher<std::vector<Entry>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, path, generation, fromServer, this] {
+        watcher->deleteLater();
+        auto *node = _nodes.value(path);
+        if (!node || node->generation != generation) {
+            return;
+        }
+        applyListing(node, watcher->result(), fromServer);
+    });
+    watcher->setFuture(QtConcurrent::run([entries = std::move(entries)]() mutable {
+        QCollator collator;
+        collator.setNumericMode(true);
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
+        std::sort(entries.begin(), entries.end(), [&collator](const Entry &a, const Entry &b) {
+            return collator.compare(a.name, b.name) < 0;
+        });
+        return std::move(entries);
+    }));
+}
+
+void RemoteFolderTreeModel::applyListing(Node *node, std::vector<Entry> &&entries, bool fromServer)
+{
+    if (!fromServer && node->fromServer) {
+        // the server was faster than the journal
+        return;
+    }
+    if (fromServer) {
+        node->state = Node::State::Fetched;
+        node->fromServer = true;
+    }
+
+    const bool sameFolders = std::equal(node->listing.cbegin(), node->listing.cend(), entries.cbegin(), entries.cend(),
+        [](const Entry &a, const Entry &b) { return a.name == b.name; });
+    if (sameFolders) {
+        // the journal was right, only the sizes changed
+        node->listing = std::move(entries);
+        if (!node->children.empty()) {
+            const auto parent = indexForNode(node);
+            Q_EMIT dataChanged(index(0, static_cast<int>(Column::Size), parent),
+                index(static_cast<int>(node->children.size()) - 1, static_cast<int>(Column::Size), parent));
+        }
+        if (node->listing.empty()) {
+            const auto idx = indexForNode(node);
+            Q_EMIT dataChanged(idx, idx);
+        }
+        return;
+    }
+
+    removeChildren(node);
+    node->listing = std::move(entries);
+
+    const bool showRoot = node == _root.get() && !_rootVisible;
+    if (showRoot) {
+        beginInsertRows({}, 0, 0);
+        _rootVisible = true;
+        endInsertRows();
+    }
+    publishPage(node);
+    if (showRoot) {
+        Q_EMIT loaded(true);
+    }
+}
+
+void RemoteFolderTreeModel::publishPage(Node *node)
+{
+    if (!node->hasPendingRows() || (node == _root.get() && !_rootVisible)) {
+        return;
+    }
+    const int first = static_cast<int>(node->children.size());
+    const int count = static_cast<int>(std::min<size_t>(pageSize, node->listing.size() - node->children.size()));
+    beginInsertRows(indexForNode(node), first, first + count - 1);
+    node->children.reserve(first + count);
+    for (int row = first; row < first + count; ++row) {
+        auto child = std::make_unique<Node>();
+        child->name = node->listing[row].name;
+        child->path = node->path + child->name + QLatin1Char('/');
+        child->parent = node;
+        child->row = row;
+        _nodes.insert(child->path, child.get());
+        node->children.push_back(std::move(child));
+    }
+    endInsertRows();
+}
+
+void RemoteFolderTreeModel::removeChildren(Node *node)
+{
+    if (node->children.empty()) {
+        return;
+    }
+    std::function<void(const Node *)> forget = [&forget, this](const Node *n) {
+        for (const auto &child : n->children) {
+            _nodes.remove(child->path);
+            forget(child.get());
+        }
+    };
+    beginRemoveRows(indexForNode(node), 0, static_cast<int>(node->children.size()) - 1);
+    forget(node);
+    node->children.clear();
+    endRemoveRows();
+}
+
+bool RemoteFolderTreeModel::isBlackListed(const QString &path) const
+{
+    for (int i = path.indexOf(QLatin1Char('/')); i != -1; i = path.indexOf(QLatin1Char('/'), i + 1)) {
+        if (_blackList.count(path.left(i + 1))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Qt::CheckState RemoteFolderTreeModel::checkState(const Node *node) const
+{
+    if (node == _root.get()) {
+        // the root can't be unchecked
+        return _blackList.empty() ? Qt::Checked : Qt::PartiallyChecked;
+    }
+    if (isBlackListed(node->path)) {
+        return Qt::Unchecked;
+    }
+    // the paths below node->path follow it in the sorted set
+    const auto it = _blackList.lower_bound(node->path);
+    if (it != _blackList.cend() && it->startsWith(node->path)) {
+        return Qt::PartiallyChecked;
+    }
+    return Qt::Checked;
+}
+
+void RemoteFolderTreeModel::eraseBlackListBelow(const QString &path)
+{
+    auto it = _blackList.lower_bound(path);
+    auto end = it;
+    while (end != _blackList.end() && end->startsWith(path)) {
+        ++end;
+    }
+    _blackList.erase(it, end);
+}
+
+bool RemoteFolderTreeModel::setCheckState(Node *node, Qt::CheckState state)
+{
+    if (node == _root.get()) {
+        if (state == Qt::Checked) {
+            _blackList.clear();
+        } else {
+            _blackList.clear();
+            for (const auto &entry : node->listing) {
+                _blackList.insert(entry.name + QLatin1Char('/'));
+            }
+        }
+        emitCheckStateChanged(node);
+        return true;
+    }
+
+    switch (state) {
+    case Qt::Unchecked:
+        if (isBlackListed(node->path)) {
+            return false;
+        }
+        eraseBlackListBelow(node->path);
+        _blackList.insert(node->path);
+        break;
+    case Qt::Checked: {
+        eraseBlackListBelow(node->path);
+        // find an excluded ancestor
+        const Node *excluded = node->parent;
+        while (excluded && !_blackList.count(excluded->path)) {
+            excluded = excluded->parent;
+        }
+        if (excluded && excluded != _root.get()) {
+            _blackList.erase(excluded->path);
+            // exclude all the siblings along the way down to node
+            for (const Node *child = node; child != excluded; child = child->parent) {
+                for (const auto &entry : child->parent->listing) {
+                    if (entry.name != child->name) {
+                        _blackList.insert(child->parent->path + entry.name + QLatin1Char('/'));
+                    }
+                }
+            }
+        }
+        break;
+    }
+    case Qt::PartiallyChecked:
+        return false;
+    }
+    emitCheckStateChanged(node);
+    return true;
+}
+
+void RemoteFolderTreeModel::emitCheckStateChanged(const Node *node)
+{
+    const QVector<int> roles { Qt::CheckStateRole };
+    for (const Node *n = node; n; n = n->parent) {
+        const auto idx = indexForNode(n);
+        Q_EMIT dataChanged(idx, idx, roles);
+    }
+    std::function<void(const Node *)> emitChildren = [&emitChildren, &roles, this](const Node *n) {
+        if (n->children.empty()) {
+            return;
+        }
+        const auto parent = indexForNode(n);
+        Q_EMIT dataChanged(index(0, 0, parent), index(static_cast<int>(n->children.size()) - 1, 0, parent), roles);
+        for (const auto &child : n->children) {
+            emitChildren(child.get());
+        }
+    };
+    emitChildren(node);
+}
+
+QStringList RemoteFolderTreeModel::createBlackList() const
+{
+    if (!_rootVisible) {
+        return {};
+    }
+    return QStringList(_blackList.cbegin(), _blackList.cend());
+}
+
+QStringList RemoteFolderTreeModel::oldBlackList() const
+{
+    return _oldBlackList;
+}
+
+qint64 RemoteFolderTreeModel::estimatedSize() const
+{
+    if (!_rootVisible) {
+        return -1;
+    }
+    qint64 result = _sizes.value(QString(), -1);
+    if (result < 0) {
+        return -1;
+    }
+    for (const auto &path : _blackList) {
+        const auto size = _sizes.value(path, -1);
+        if (size < 0) {
+            // We did not load from the server so we have no idea how much we will sync from this branch
+            return -1;
+        }
+        result -= size;
+    }
+    return result;
+}
+}
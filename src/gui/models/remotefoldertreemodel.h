@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#pragma once
+
+#include "accountfwd.h"
+#include "csync_exclude.h"
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QIcon>
+
+#include <memory>
+#include <set>
+#include <vector>
+
+class QNetworkReply;
+
+namespace OCC {
+class SyncJournalDb;
+
+/**
+ * @brief A lazily populated tree of the remote folders below a sync root
+ *
+ * The sub folders of a folder are only listed when the view asks for them.
+ * Folders that are already known to the journal are displayed until the server replied.
+ * Listings are sorted in a background thread and handed to the view in pages of pageSize rows.
+ *
+ * The check states are not stored per item but derived from the sorted blacklist,
+ * changing a check state and creating the blacklist only depend on the number of changes.
+ *
+ * @ingroup gui
+ */
+class RemoteFolderTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    enum class Column {
+        Name,
+        Size,
+
+        ColumnCount
+    };
+    Q_ENUM(Column)
+
+    static constexpr int pageSize = 500;
+
+    /**
+     * @param folderPath The remote path of the sync root
+     * @param rootName The name displayed for the sync root
+     * @param oldBlackList The excluded paths, each including a trailing /. A "/" entry excludes all top-level folders.
+     * @param journal The journal of the sync root, if there is one already
+     */
+    RemoteFolderTreeModel(const AccountPtr &account, const QString &folderPath, const QString &rootName, const QStringList &oldBlackList, SyncJournalDb *journal, QObject *parent = nullptr);
+    ~RemoteFolderTreeModel() override;
+
+    /**
+     * Start listing the sync root, emits loaded() or loadingFailed()
+     */
+    void load();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = {}) const override;
+    int columnCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    bool hasChildren(const QModelIndex &parent = {}) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    /// Returns a list of blacklisted paths, each including the trailing /
+    QStringList createBlackList() const;
+
+    /** Returns the oldBlackList passed to the constructor, except that
+     *  a "/" entry is expanded to all top-level folder names.
+     */
+    QStringList oldBlackList() const;
+
+    /// Estimates the total size of the checked items, -1 if the size of an excluded folder is unknown
+    qint64 estimatedSize() const;
+
+Q_SIGNALS:
+    /// The sync root was listed
+    void loaded(bool hasSubFolders);
+    void loadingFailed(QNetworkReply *reply);
+
+private:
+    struct Entry
+    {
+        QString name;
+        qint64 size;
+    };
+    struct Node;
+
+    Node *nodeForIndex(const QModelIndex &index) const;
+    QModelIndex indexForNode(const Node *node, int column = 0) const;
+
+    void startListing(Node *node);
+    void slotListing(const QString &path, quint64 generation, const QStringList &hrefs, const QHash<QString, qint64> &sizes);
+    void sortInBackground(const QString &path, quint64 generation, std::vector<Entry> &&entries, bool fromServer);
+    void applyListing(Node *node, std::vector<Entry> &&entries, bool fromServer);
+    void publishPage(Node *node);
+    void removeChildren(Node *node);
+
+    Qt::CheckState checkState(const Node *node) const;
+    bool setCheckState(Node *node, Qt::CheckState state);
+    bool isBlackListed(const QString &path) const;
+    void eraseBlackListBelow(const QString &path);
+    void emitCheckStateChanged(const Node *node);
+
+    AccountPtr _account;
+    QString _folderPath;
+    QString _rootName;
+    QStringList _oldBlackList;
+    bool _expandRootBlackList = false;
+    SyncJournalDb *_journal;
+
+    // During account setup we want to filter out excluded folders from the
+    // view without having a Folder.SyncEngine.ExcludedFiles instance.
+    ExcludedFiles _excludedFiles;
+
+    std::unique_ptr<Node> _root;
+    // the root row is only shown once we know it has sub folders
+    bool _rootVisible = false;
+    QHash<QString, Node *> _nodes;
+    QHash<QString, qint64> _sizes;
+    quint64 _nextGeneration = 0;
+
+    // sorted, the paths below a folder form a contiguous range
+    std::set<QString> _blackList;
+
+    QIcon _folderIcon;
+};
+}
@@ -206,8 +206,6 @@ void NetworkSettings::saveBWLimitSettings()
         cfgFile.setUseUploadLimit(-1);
     }
     cfgFile.setUploadLimit(_ui->uploadSpinBox->value());
-
-    FolderMan::instance()->setDirtyNetworkLimits();
 }
 
 void NetworkSettings::checkEmptyProxyHost()
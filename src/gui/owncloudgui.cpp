@@ -137,6 +137,8 @@ ownCloudGui::ownCloudGui(Application *parent)
     ProgressDispatcher *pd = ProgressDispatcher::instance();
     connect(pd, &ProgressDispatcher::progressInfo, this,
         &ownCloudGui::slotUpdateProgress);
+    connect(pd, &ProgressDispatcher::itemCompleted, this,
+        &ownCloudGui::slotItemCompleted);
 
     FolderMan *folderMan = FolderMan::instance();
     connect(folderMan, &FolderMan::folderSyncStateChange,
@@ -336,6 +338,10 @@ void ownCloudGui::slotComputeOverallSyncStatus()
             folder->syncPaused());
         allStatusStrings += tr("Folder %1: %2").arg(folder->shortGuiLocalPath(), folderMessage);
     }
+    const int queuedFolders = FolderMan::instance()->scheduleQueue().size();
+    if (queuedFolders > 0) {
+        allStatusStrings += tr("%n folder(s) waiting to sync", "", queuedFolders);
+    }
     trayMessage = allStatusStrings.join(QLatin1String("\n"));
 #endif
     _tray->setToolTip(trayMessage);
@@ -880,15 +886,16 @@ static bool shouldShowInRecentsMenu(const SyncFileItem &item)
         && item._instruction != CSYNC_INSTRUCTION_NONE;
 }
 
-void ownCloudGui::slotUpdateProgress(Folder *folder, const ProgressInfo &progress)
+void ownCloudGui::slotUpdateProgress(Folder *folder, const ProgressSnapshot &progress)
 {
+    Q_UNUSED(folder);
     if (progress.status() == ProgressInfo::Discovery) {
-        if (!progress._currentDiscoveredRemoteFolder.isEmpty()) {
+        if (!progress.currentDiscoveredRemoteFolder().isEmpty()) {
             _actionStatus->setText(tr("Checking for changes in remote '%1'")
-                                       .arg(progress._currentDiscoveredRemoteFolder));
-        } else if (!progress._currentDiscoveredLocalFolder.isEmpty()) {
+                                       .arg(progress.currentDiscoveredRemoteFolder()));
+        } else if (!progress.currentDiscoveredLocalFolder().isEmpty()) {
             _actionStatus->setText(tr("Checking for changes in local '%1'")
-                                       .arg(progress._currentDiscoveredLocalFolder));
+                                       .arg(progress.currentDiscoveredLocalFolder()));
         }
     } else if (progress.status() == ProgressInfo::Done) {
         QTimer::singleShot(2s, this, &ownCloudGui::slotComputeOverallSyncStatus);
@@ -905,7 +912,7 @@ void ownCloudGui::slotUpdateProgress(Folder *folder, const ProgressInfo &progres
             msg = tr("Syncing %1 of %2  (%3 left)")
                       .arg(currentFile)
                       .arg(totalFileCount)
-                      .arg(Utility::durationToDescriptiveString2(progress.totalProgress().estimatedEta));
+                      .arg(Utility::durationToDescriptiveString2(progress.estimatedEta()));
         } else {
             msg = tr("Syncing %1 of %2")
                       .arg(currentFile)
@@ -917,43 +924,46 @@ void ownCloudGui::slotUpdateProgress(Folder *folder, const ProgressInfo &progres
         QString msg;
         if (progress.trustEta()) {
             msg = tr("Syncing %1 (%2 left)")
-                      .arg(totalSizeStr, Utility::durationToDescriptiveString2(progress.totalProgress().estimatedEta));
+                      .arg(totalSizeStr, Utility::durationToDescriptiveString2(progress.estimatedEta()));
         } else {
             msg = tr("Syncing %1")
                       .arg(totalSizeStr);
         }
         _actionStatus->setText(msg);
     }
+}
 
-    _actionRecent->setIcon(QIcon()); // Fixme: Set a "in-progress"-item eventually.
-
-    if (!progress._lastCompletedItem.isEmpty()
-        && shouldShowInRecentsMenu(progress._lastCompletedItem)) {
-        if (Progress::isWarningKind(progress._lastCompletedItem._status)) {
-            // display a warn icon if warnings happened.
-            _actionRecent->setIcon(Utility::getCoreIcon(QStringLiteral("warning")));
-        }
+void ownCloudGui::slotItemCompleted(Folder *folder, const SyncFileItemPtr &item)
+{
+    if (!shouldShowInRecentsMenu(*item)) {
+        return;
+    }
+    if (Progress::isWarningKind(item->_status)) {
+        // display a warn icon if warnings happened.
+        _actionRecent->setIcon(Utility::getCoreIcon(QStringLiteral("warning")));
+    } else {
+        _actionRecent->setIcon(QIcon()); // Fixme: Set a "in-progress"-item eventually.
+    }
 
-        QString kindStr = Progress::asResultString(progress._lastCompletedItem);
-        QString timeStr = QTime::currentTime().toString(QStringLiteral("hh:mm"));
-        QString actionText = tr("%1 (%2, %3)").arg(progress._lastCompletedItem._file, kindStr, timeStr);
-        QAction *action = new QAction(actionText, this);
-        QString fullPath = folder->path() + QLatin1Char('/') + progress._lastCompletedItem._file;
-        if (QFile(fullPath).exists()) {
-            connect(action, &QAction::triggered, this, [this, fullPath] { this->slotOpenPath(fullPath); });
-        } else {
-            action->setEnabled(false);
-        }
-        if (_recentItemsActions.length() > 5) {
-            _recentItemsActions.takeFirst()->deleteLater();
-        }
-        _recentItemsActions.append(action);
+    QString kindStr = Progress::asResultString(*item);
+    QString timeStr = QTime::currentTime().toString(QStringLiteral("hh:mm"));
+    QString actionText = tr("%1 (%2, %3)").arg(item->_file, kindStr, timeStr);
+    QAction *action = new QAction(actionText, this);
+    QString fullPath = folder->path() + QLatin1Char('/') + item->_file;
+    if (QFile(fullPath).exists()) {
+        connect(action, &QAction::triggered, this, [this, fullPath] { this->slotOpenPath(fullPath); });
+    } else {
+        action->setEnabled(false);
+    }
+    if (_recentItemsActions.length() > 5) {
+        _recentItemsActions.takeFirst()->deleteLater();
+    }
+    _recentItemsActions.append(action);
 
-        // Update the "Recent" menu if the context menu is being shown,
-        // otherwise it'll be updated later, when the context menu is opened.
-        if (updateWhileVisible() && contextMenuVisible()) {
-            slotRebuildRecentMenus();
-        }
+    // Update the "Recent" menu if the context menu is being shown,
+    // otherwise it'll be updated later, when the context menu is opened.
+    if (updateWhileVisible() && contextMenuVisible()) {
+        slotRebuildRecentMenus();
     }
 }
 
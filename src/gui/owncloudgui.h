@@ -85,7 +85,8 @@ public slots:
     void slotShowOptionalTrayMessage(const QString &title, const QString &msg, const QIcon &icon = {});
     void slotFolderOpenAction(Folder *f);
     void slotRebuildRecentMenus();
-    void slotUpdateProgress(Folder *folder, const ProgressInfo &progress);
+    void slotUpdateProgress(Folder *folder, const ProgressSnapshot &progress);
+    void slotItemCompleted(Folder *folder, const SyncFileItemPtr &item);
     void slotShowGuiMessage(const QString &title, const QString &message);
     void slotFoldersChanged();
     void slotShowSettings();
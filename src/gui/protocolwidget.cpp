@@ -75,8 +75,8 @@ ProtocolWidget::ProtocolWidget(QWidget *parent)
     });
 
     connect(FolderMan::instance(), &FolderMan::folderRemoved, this, [this](Folder *f) {
-        _model->remove_if([f](const ProtocolItem &item) {
-            return item.folder() == f;
+        _model->remove_if(f, [](const ProtocolItem &) {
+            return true;
         });
     });
 }
@@ -174,7 +174,7 @@ void ProtocolWidget::slotItemCompleted(Folder *folder, const SyncFileItemPtr &it
 {
     if (!item->showInProtocolTab())
         return;
-    _model->addProtocolItem(ProtocolItem { folder, item });
+    _model->queueProtocolItem(ProtocolItem { folder, item });
 }
 
 void ProtocolWidget::filterDidChange()
@@ -14,18 +14,17 @@
 
 #pragma once
 #include <QDialog>
-#include <QTreeWidget>
 #include "accountfwd.h"
 
-#include "csync_exclude.h"
-
-class QTreeWidgetItem;
-class QTreeWidget;
+class QPushButton;
+class QTreeView;
 class QNetworkReply;
 class QLabel;
 namespace OCC {
 
 class Folder;
+class RemoteFolderTreeModel;
+class SyncJournalDb;
 
 /**
  * @brief The SelectiveSyncWidget contains a folder tree with labels
@@ -38,7 +37,7 @@ public:
     explicit SelectiveSyncWidget(AccountPtr account, QWidget *parent = nullptr);
 
     /// Returns a list of blacklisted paths, each including the trailing /
-    QStringList createBlackList(QTreeWidgetItem *root = nullptr) const;
+    QStringList createBlackList() const;
 
     /** Returns the oldBlackList passed into setFolderInfo(), except that
      *  a "/" entry is expanded to all top-level folder names.
@@ -46,38 +45,26 @@ public:
     QStringList oldBlackList() const;
 
     // Estimates the total size of checked items (recursively)
-    qint64 estimatedSize(QTreeWidgetItem *root = nullptr);
+    qint64 estimatedSize() const;
 
     // oldBlackList is a list of excluded paths, each including a trailing /
+    // journal is used to display the known folders while they are listed on the server
     void setFolderInfo(const QString &folderPath, const QString &rootName,
-        const QStringList &oldBlackList = QStringList());
+        const QStringList &oldBlackList = QStringList(), SyncJournalDb *journal = nullptr);
 
     QSize sizeHint() const override;
 
 private slots:
-    void slotUpdateDirectories(QStringList);
-    void slotItemExpanded(QTreeWidgetItem *);
-    void slotItemChanged(QTreeWidgetItem *, int);
+    void slotLoaded(bool hasSubFolders);
     void slotLscolFinishedWithError(QNetworkReply *);
 
 private:
-    void refreshFolders();
-    void recursiveInsert(QTreeWidgetItem *parent, QStringList pathTrail, QString path, qint64 size);
-
     AccountPtr _account;
 
-    QString _folderPath;
-    QString _rootName;
-    QStringList _oldBlackList;
-
-    bool _inserting; // set to true when we are inserting new items on the list
     QLabel *_loading;
 
-    QTreeWidget *_folderTree;
-
-    // During account setup we want to filter out excluded folders from the
-    // view without having a Folder.SyncEngine.ExcludedFiles instance.
-    ExcludedFiles _excludedFiles;
+    QTreeView *_folderTree;
+    RemoteFolderTreeModel *_model = nullptr;
 };
 
 /**
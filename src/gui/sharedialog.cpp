@@ -21,11 +21,12 @@
 #include "gui/settingsdialog.h"
 #include "gui/sharee.h"
 #include "gui/sharelinkwidget.h"
+#include "gui/folderman.h"
 #include "gui/shareusergroupwidget.h"
-#include "gui/thumbnailjob.h"
 
 #include "account.h"
 #include "configfile.h"
+#include "imagecache.h"
 #include "theme.h"
 
 #include <QFileInfo>
@@ -120,9 +121,7 @@ ShareDialog::ShareDialog(AccountStatePtr accountState,
     }
 
     if (QFileInfo(_localPath).isFile()) {
-        ThumbnailJob *job = new ThumbnailJob(_sharePath, _accountState->account(), this);
-        connect(job, &ThumbnailJob::jobFinished, this, &ShareDialog::slotThumbnailFetched);
-        job->start();
+        fetchThumbnail();
     }
 
     _progressIndicator = new QProgressIndicator(this);
@@ -217,19 +216,29 @@ QSize ShareDialog::minimumSizeHint() const
     return ocApp()->gui()->settingsDialog()->sizeHintForChild();
 }
 
-void ShareDialog::slotThumbnailFetched(const int &statusCode, const QPixmap &reply)
+void ShareDialog::fetchThumbnail()
 {
-    if (statusCode != 200) {
-        qCWarning(lcSharing) << "Thumbnail status code: " << statusCode;
-        return;
-    }
-    if (reply.isNull()) {
-        qCWarning(lcSharing) << "Invalid pixmap";
-        return;
+    Q_ASSERT(_sharePath.startsWith(QLatin1Char('/')));
+    // The thumbnail only changes with the file, identify it by the file id and etag if we know them
+    ImageCache::Key key { _sharePath, {}, QSize(150, 150) };
+    QString relativePath;
+    if (auto folder = FolderMan::instance()->folderForPath(_localPath, &relativePath)) {
+        SyncJournalFileRecord record;
+        if (folder->journalDb()->getFileRecord(relativePath, &record) && record.isValid()) {
+            key.id = QString::fromUtf8(record._fileId);
+            key.etag = record._etag;
+        }
     }
-    const auto p = reply.scaledToHeight(thumbnailSize, Qt::SmoothTransformation);
-    _ui->label_icon->setPixmap(p);
-    _ui->label_icon->show();
+    const auto account = _accountState->account();
+    ImageCache::instance()->fetch(key, account, account->url(), QStringLiteral("index.php/apps/files/api/v1/thumbnail/150/150") + _sharePath, this, [this](const QPixmap &thumbnail) {
+        if (thumbnail.isNull()) {
+            qCWarning(lcSharing) << "Failed to fetch the thumbnail of" << _sharePath;
+            return;
+        }
+        const auto p = thumbnail.scaledToHeight(thumbnailSize, Qt::SmoothTransformation);
+        _ui->label_icon->setPixmap(p);
+        _ui->label_icon->show();
+    });
 }
 
 void ShareDialog::slotAccountStateChanged(int state)
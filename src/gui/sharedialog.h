@@ -54,11 +54,11 @@ public:
 private slots:
     void slotPropfindReceived(const QString &, const QMap<QString, QString> &result);
     void slotPropfindError();
-    void slotThumbnailFetched(const int &statusCode, const QPixmap &reply);
     void slotAccountStateChanged(int state);
 
 private:
     void showSharingUi();
+    void fetchThumbnail();
 
     Ui::ShareDialog *_ui;
     AccountStatePtr _accountState;
@@ -23,7 +23,8 @@
 #include "configfile.h"
 #include "capabilities.h"
 #include "guiutility.h"
-#include "thumbnailjob.h"
+#include "imagecache.h"
+#include "networkjobs.h"
 #include "sharee.h"
 #include "sharemanager.h"
 #include "guiutility.h"
@@ -450,9 +451,11 @@ void ShareUserLine::loadAvatar()
         auto account = _share->account();
         auto capabilities = account->capabilities();
         if (capabilities.isValid() && capabilities.avatarsAvailable()) {
-            AvatarJob *job = new AvatarJob(account, _share->getShareWith()->shareWith(), avatarSize, this);
-            connect(job, &AvatarJob::avatarPixmap, this, &ShareUserLine::slotAvatarLoaded);
-            job->start();
+            const QString userId = _share->getShareWith()->shareWith();
+            ImageCache::instance()->fetch({ QStringLiteral("avatar:") + userId, {}, QSize(avatarSize, avatarSize) }, account, account->url(),
+                AvatarJob::avatarPath(userId, avatarSize), this, [this](const QPixmap &avatar) {
+                    slotAvatarLoaded(avatar);
+                });
         }
     }
 }
@@ -680,9 +680,10 @@ void SocketApi::command_MAKE_AVAILABLE_LOCALLY(const QString &filesArg, SocketLi
         // Update the pin state on all items
         data.folder->vfs().setPinState(data.folderRelativePath, PinState::AlwaysLocal);
 
-        // Trigger sync
+        // Hydrate the files without waiting for a discovery, the
+        // following sync rediscovers what the pin change skipped
         data.folder->schedulePathForLocalDiscovery(data.folderRelativePath);
-        data.folder->scheduleThisFolderSoon();
+        data.folder->schedulePinChange(data.folderRelativePath);
     }
 }
 
@@ -699,9 +700,10 @@ void SocketApi::command_MAKE_ONLINE_ONLY(const QString &filesArg, SocketListener
         // Update the pin state on all items
         data.folder->vfs().setPinState(data.folderRelativePath, PinState::OnlineOnly);
 
-        // Trigger sync
+        // Dehydrate the files without waiting for a discovery, the
+        // following sync rediscovers what the pin change skipped
         data.folder->schedulePathForLocalDiscovery(data.folderRelativePath);
-        data.folder->scheduleThisFolderSoon();
+        data.folder->schedulePinChange(data.folderRelativePath);
     }
 }
 
@@ -17,7 +17,7 @@
 // TODO: move models out from core
 #include "gui/guiutility.h"
 #include "gui/models/models.h"
-#include "networkjobs.h"
+#include "imagecache.h"
 
 #include <QIcon>
 #include <QPixmap>
@@ -121,15 +121,19 @@ QVariant SpacesModel::data(const QModelIndex &index, int role) const
             _images[item.getId()] = OCC::Utility::getCoreIcon(QStringLiteral("th-large")).pixmap(ImageSizeC);
             const auto imgUrl = data(index, Models::UnderlyingDataRole).toUrl();
             if (!imgUrl.isEmpty()) {
-                auto job = new OCC::SimpleNetworkJob(_acc, imgUrl, {}, "GET", {}, {}, nullptr);
-                connect(job, &OCC::SimpleNetworkJob::finishedSignal, this, [job, id = item.getId(), index, this] {
-                    QPixmap img;
-                    img.loadFromData(job->reply()->readAll());
-                    img = img.scaled(ImageSizeC, Qt::KeepAspectRatio, Qt::TransformationMode::SmoothTransformation);
-                    _images[id] = img;
+                const auto &special = item.getSpecial();
+                const auto img = std::find_if(special.cbegin(), special.cend(), [](const OpenAPI::OAIDriveItem &it) {
+                    return it.getSpecialFolder().getName() == QLatin1String("image");
+                });
+                // the image is scaled and decoded by the cache
+                const OCC::ImageCache::Key key { imgUrl.toString(), img->getETag().toUtf8(), ImageSizeC };
+                OCC::ImageCache::instance()->fetch(key, _acc, imgUrl, {}, const_cast<SpacesModel *>(this), [id = item.getId(), index, this](const QPixmap &pixmap) {
+                    if (pixmap.isNull()) {
+                        return;
+                    }
+                    _images[id] = pixmap;
                     Q_EMIT const_cast<SpacesModel *>(this)->dataChanged(index, index, { Qt::DecorationRole });
                 });
-                job->start();
             }
             return _images[item.getId()];
         }
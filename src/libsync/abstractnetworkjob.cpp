@@ -165,7 +165,14 @@ void AbstractNetworkJob::sendRequest(const QByteArray &verb,
     if (!isAuthenticationJob() && _account->jobQueue()->enqueue(this)) {
         return;
     }
-    auto reply = _account->sendRawRequest(verb, _request.url(), _request, requestBody);
+    QNetworkReply *reply = nullptr;
+    if (_allowCoalescing && !isAuthenticationJob() && RequestCoalescer::isCoalescable(verb, _request, requestBody)) {
+        reply = _account->jobQueue()->coalescer()->send(verb, _request, requestBody, [&] {
+            return _account->sendRawRequest(verb, _request.url(), _request, requestBody);
+        });
+    } else {
+        reply = _account->sendRawRequest(verb, _request.url(), _request, requestBody);
+    }
     if (_requestBody) {
         _requestBody->setParent(this);
     }
@@ -349,6 +356,11 @@ QString networkReplyErrorString(const QNetworkReply &reply)
 void AbstractNetworkJob::retry()
 {
     OC_ENFORCE(!_verb.isEmpty());
+    if (_aborted) {
+        // aborted while waiting for the retry, finish with the last error
+        slotFinished();
+        return;
+    }
     _retryCount++;
     qCInfo(lcNetworkJob) << "Restarting" << this << "for the" << _retryCount << "time";
     if (_requestBody) {
@@ -378,6 +390,11 @@ void AbstractNetworkJob::abort()
     }
 }
 
+void AbstractNetworkJob::setAllowCoalescing(bool allow)
+{
+    _allowCoalescing = allow;
+}
+
 void AbstractNetworkJob::setPriority(QNetworkRequest::Priority priority)
 {
     _priority = priority;
@@ -88,6 +88,12 @@ public:
     void setPriority(QNetworkRequest::Priority priority);
     QNetworkRequest::Priority priority() const;
 
+    /** Whether GET and PROPFIND requests may share the reply of an identical request in flight
+     *
+     * Defaults to true, jobs that stream large responses should disable it.
+     */
+    void setAllowCoalescing(bool allow);
+
     /** Returns an error message, if any. */
     QString errorString() const;
 
@@ -199,6 +205,7 @@ private:
     bool _aborted = false;
     bool _finished = false;
     bool _forceIgnoreCredentialFailure = false;
+    bool _allowCoalescing = true;
 
     QNetworkRequest _request;
     QByteArray _verb;
@@ -295,6 +295,22 @@ void Account::setCapabilities(const Capabilities &caps)
     }
 }
 
+void Account::setCapabilitiesEtag(const QByteArray &etag)
+{
+    if (_capabilitiesEtag == etag)
+        return;
+    _capabilitiesEtag = etag;
+    emit wantsAccountSaved(this);
+}
+
+void Account::setUserInfoEtag(const QByteArray &etag)
+{
+    if (_userInfoEtag == etag)
+        return;
+    _userInfoEtag = etag;
+    emit wantsAccountSaved(this);
+}
+
 Account::ServerSupportLevel Account::serverSupportLevel() const
 {
     if (!hasCapabilities()) {
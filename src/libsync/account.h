@@ -166,6 +166,16 @@ public:
 
     bool hasCapabilities() const;
 
+    /** The ETags of the responses the capabilities and the user info were read from
+     *
+     * They are persisted with the account, so the cached values can be
+     * revalidated with a conditional request when connecting.
+     */
+    QByteArray capabilitiesEtag() const { return _capabilitiesEtag; }
+    void setCapabilitiesEtag(const QByteArray &etag);
+    QByteArray userInfoEtag() const { return _userInfoEtag; }
+    void setUserInfoEtag(const QByteArray &etag);
+
     void setAppProvider(AppProvider &&p);
     const AppProvider &appProvider() const;
 
@@ -237,6 +247,8 @@ private:
 
     QSet<QSslCertificate> _approvedCerts;
     Capabilities _capabilities;
+    QByteArray _capabilitiesEtag;
+    QByteArray _userInfoEtag;
     QuotaInfo *_quotaInfo;
     QPointer<AccessManager> _am;
     QScopedPointer<AbstractCredentials> _credentials;
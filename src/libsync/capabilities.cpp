@@ -207,6 +207,11 @@ bool Capabilities::chunkingParallelUploadDisabled() const
     return _capabilities.value(QStringLiteral("dav")).toMap().value(QStringLiteral("chunkingParallelUploadDisabled")).toBool();
 }
 
+bool Capabilities::syncCollectionReport() const
+{
+    return _capabilities.value(QStringLiteral("dav")).toMap().value(QStringLiteral("reports")).toStringList().contains(QStringLiteral("sync-collection"));
+}
+
 bool Capabilities::privateLinkPropertyAvailable() const
 {
     return _capabilities.value(QStringLiteral("files")).toMap().value(QStringLiteral("privateLinks")).toBool();
@@ -186,6 +186,16 @@ public:
     /// disable parallel upload in chunking
     bool chunkingParallelUploadDisabled() const;
 
+    /**
+     * Whether the server can report the changes since a sync token
+     * with a WebDAV sync-collection REPORT.
+     *
+     * Path: dav/reports
+     * Default: []
+     * Example: ["search-files", "sync-collection"]
+     */
+    bool syncCollectionReport() const;
+
     /// Whether the "privatelink" DAV property is available
     bool privateLinkPropertyAvailable() const;
 
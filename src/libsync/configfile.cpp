@@ -32,12 +32,15 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QLoggingCategory>
+#include <QMutex>
 #include <QSettings>
 #include <QNetworkProxy>
 #include <QOperatingSystemVersion>
 #include <QStandardPaths>
 
 #include <chrono>
+#include <functional>
+
 using namespace std::chrono_literals;
 
 namespace OCC {
@@ -67,6 +70,9 @@ const QString chunkSizeC() { return QStringLiteral("chunkSize"); }
 const QString minChunkSizeC() { return QStringLiteral("minChunkSize"); }
 const QString maxChunkSizeC() { return QStringLiteral("maxChunkSize"); }
 const QString targetChunkUploadDurationC() { return QStringLiteral("targetChunkUploadDuration"); }
+const QString maxParallelFolderSyncsC() { return QStringLiteral("maxParallelFolderSyncs"); }
+const QString maxTotalTransferJobsC() { return QStringLiteral("maxTotalTransferJobs"); }
+const QString maxTransferJobsPerHostC() { return QStringLiteral("maxTransferJobsPerHost"); }
 const QString automaticLogDirC() { return QStringLiteral("logToTemporaryLogDir"); }
 const QString numberOfLogsToKeepC() { return QStringLiteral("numberOfLogsToKeep"); }
 const QString showExperimentalOptionsC() { return QStringLiteral("showExperimentalOptions"); }
@@ -93,10 +99,143 @@ const QString moveToTrashC() { return QStringLiteral("moveToTrash"); }
 QString ConfigFile::_confDir = QString();
 const std::chrono::seconds DefaultRemotePollInterval { 30 };
 
-static chrono::milliseconds millisecondsValue(const QSettings &setting, const QString &key,
-    chrono::milliseconds defaultValue)
+namespace {
+/**
+ * The values of a settings file, read once and kept in memory
+ *
+ * Keys are relative to the root of the file, like BWLimit/uploadLimit.
+ * Writes update the values in memory and the file.
+ */
+class SettingsSnapshot
+{
+public:
+    using Open = std::function<std::unique_ptr<QSettings>()>;
+
+    explicit SettingsSnapshot(Open open)
+        : _open(std::move(open))
+    {
+    }
+
+    /** The settings of the config file */
+    static SettingsSnapshot &user()
+    {
+        static SettingsSnapshot snapshot([] { return std::make_unique<QSettings>(ConfigFile::configFile(), QSettings::IniFormat); });
+        return snapshot;
+    }
+
+    /** The read only settings of the administrator */
+    static SettingsSnapshot &system()
+    {
+        static SettingsSnapshot snapshot([] {
+            if (Utility::isMac()) {
+                return std::make_unique<QSettings>(QStringLiteral("/Library/Preferences/" APPLICATION_REV_DOMAIN ".plist"), QSettings::NativeFormat);
+            } else if (Utility::isUnix()) {
+                return std::make_unique<QSettings>(QStringLiteral(SYSCONFDIR "/%1/%1.conf").arg(Theme::instance()->appName()), QSettings::NativeFormat);
+            }
+            return std::make_unique<QSettings>(QStringLiteral("HKEY_LOCAL_MACHINE\\Software\\" APPLICATION_VENDOR "\\%1").arg(Theme::instance()->appNameGUI()),
+                QSettings::NativeFormat);
+        });
+        return snapshot;
+    }
+
+    QVariant value(const QString &key, const QVariant &defaultValue = {})
+    {
+        QMutexLocker lock(&_mutex);
+        ensureLoaded();
+        return _values.value(key, defaultValue);
+    }
+
+    bool contains(const QString &key)
+    {
+        QMutexLocker lock(&_mutex);
+        ensureLoaded();
+        return _values.contains(key);
+    }
+
+    /** Returns whether the value changed */
+    bool setValue(const QString &key, const QVariant &value)
+    {
+        QMutexLocker lock(&_mutex);
+        ensureLoaded();
+        const auto it = _values.constFind(key);
+        if (it != _values.cend() && it.value() == value) {
+            return false;
+        }
+        _values.insert(key, value);
+        auto settings = _open();
+        settings->setValue(key, value);
+        settings->sync();
+        return true;
+    }
+
+    /** Removes key and the keys in the group key, returns whether anything was removed */
+    bool remove(const QString &key)
+    {
+        QMutexLocker lock(&_mutex);
+        ensureLoaded();
+        const QString group = key + QLatin1Char('/');
+        bool removed = false;
+        for (auto it = _values.begin(); it != _values.end();) {
+            if (it.key() == key || it.key().startsWith(group)) {
+                it = _values.erase(it);
+                removed = true;
+            } else {
+                ++it;
+            }
+        }
+        if (removed) {
+            auto settings = _open();
+            settings->remove(key);
+            settings->sync();
+        }
+        return removed;
+    }
+
+    /** Drops the values, they are read again on the next access */
+    void reload()
+    {
+        QMutexLocker lock(&_mutex);
+        _loaded = false;
+        _values.clear();
+    }
+
+private:
+    void ensureLoaded()
+    {
+        if (_loaded) {
+            return;
+        }
+        _loaded = true;
+        const auto settings = _open();
+        const auto keys = settings->allKeys();
+        _values.reserve(keys.size());
+        for (const auto &key : keys) {
+            _values.insert(key, settings->value(key));
+        }
+        qCDebug(lcConfigFile) << "Read" << _values.size() << "settings from" << settings->fileName();
+    }
+
+    const Open _open;
+    QMutex _mutex;
+    bool _loaded = false;
+    QHash<QString, QVariant> _values;
+};
+
+QString groupKey(const QString &group, const QString &key)
+{
+    return group.isEmpty() ? key : group + QLatin1Char('/') + key;
+}
+
+chrono::milliseconds millisecondsValue(const QString &key, chrono::milliseconds defaultValue)
+{
+    return chrono::milliseconds(SettingsSnapshot::user().value(key, qlonglong(defaultValue.count())).toLongLong());
+}
+}
+
+ConfigFileNotifier *ConfigFileNotifier::instance()
 {
-    return chrono::milliseconds(setting.value(key, qlonglong(defaultValue.count())).toLongLong());
+    static auto *notifier = new ConfigFileNotifier(qApp);
+    return notifier;
 }
 
 ConfigFile::ConfigFile()
@@ -104,6 +243,11 @@ ConfigFile::ConfigFile()
     QSettings::setDefaultFormat(QSettings::IniFormat);
 }
 
+void ConfigFile::reload()
+{
+    SettingsSnapshot::user().reload();
+}
+
 bool ConfigFile::setConfDir(const QString &value)
 {
     QString dirPath = value;
@@ -119,6 +263,7 @@ bool ConfigFile::setConfDir(const QString &value)
         dirPath = fi.absoluteFilePath();
         qCInfo(lcConfigFile) << "Using custom config dir " << dirPath;
         _confDir = dirPath;
+        SettingsSnapshot::user().reload();
         return true;
     }
     return false;
@@ -126,68 +271,70 @@ bool ConfigFile::setConfDir(const QString &value)
 
 bool ConfigFile::optionalDesktopNotifications() const
 {
-    auto settings = makeQSettings();
-    return settings.value(optionalDesktopNoficationsC(), true).toBool();
+    return SettingsSnapshot::user().value(optionalDesktopNoficationsC(), true).toBool();
 }
 
 bool ConfigFile::showInExplorerNavigationPane() const
 {
-    auto settings = makeQSettings();
-    return settings.value(showInExplorerNavigationPaneC(), QOperatingSystemVersion::current() >= QOperatingSystemVersion::Windows10).toBool();
+    return SettingsSnapshot::user().value(showInExplorerNavigationPaneC(), QOperatingSystemVersion::current() >= QOperatingSystemVersion::Windows10).toBool();
 }
 
 void ConfigFile::setShowInExplorerNavigationPane(bool show)
 {
-    auto settings = makeQSettings();
-    settings.setValue(showInExplorerNavigationPaneC(), show);
-    settings.sync();
+    setValue(showInExplorerNavigationPaneC(), show);
 }
 
 std::chrono::seconds ConfigFile::timeout() const
 {
-    auto settings = makeQSettings();
-    const auto val = settings.value(timeoutC()).toInt(); // default to 5 min
+    const auto val = SettingsSnapshot::user().value(timeoutC()).toInt(); // default to 5 min
     return val ? std::chrono::seconds(val) : 5min;
 }
 
 qint64 ConfigFile::chunkSize() const
 {
-    auto settings = makeQSettings();
-    return settings.value(chunkSizeC(), 10 * 1000 * 1000).toLongLong(); // default to 10 MB
+    return SettingsSnapshot::user().value(chunkSizeC(), 10 * 1000 * 1000).toLongLong(); // default to 10 MB
 }
 
 qint64 ConfigFile::maxChunkSize() const
 {
-    auto settings = makeQSettings();
-    return settings.value(maxChunkSizeC(), 100 * 1000 * 1000).toLongLong(); // default to 100 MB
+    return SettingsSnapshot::user().value(maxChunkSizeC(), 100 * 1000 * 1000).toLongLong(); // default to 100 MB
 }
 
 qint64 ConfigFile::minChunkSize() const
 {
-    auto settings = makeQSettings();
-    return settings.value(minChunkSizeC(), 1000 * 1000).toLongLong(); // default to 1 MB
+    return SettingsSnapshot::user().value(minChunkSizeC(), 1000 * 1000).toLongLong(); // default to 1 MB
 }
 
 chrono::milliseconds ConfigFile::targetChunkUploadDuration() const
 {
-    auto settings = makeQSettings();
-    return millisecondsValue(settings, targetChunkUploadDurationC(), chrono::minutes(1));
+    return millisecondsValue(targetChunkUploadDurationC(), chrono::minutes(1));
+}
+
+int ConfigFile::maxParallelFolderSyncs() const
+{
+    return qMax(1, SettingsSnapshot::user().value(maxParallelFolderSyncsC(), 3).toInt());
+}
+
+int ConfigFile::maxTotalTransferJobs() const
+{
+    return qMax(1, SettingsSnapshot::user().value(maxTotalTransferJobsC(), 20).toInt());
+}
+
+int ConfigFile::maxTransferJobsPerHost() const
+{
+    // no limit by default, with a single server it would only lower the total limit
+    return qMax(0, SettingsSnapshot::user().value(maxTransferJobsPerHostC(), 0).toInt());
 }
 
 void ConfigFile::setOptionalDesktopNotifications(bool show)
 {
-    auto settings = makeQSettings();
-    settings.setValue(optionalDesktopNoficationsC(), show);
-    settings.sync();
+    setValue(optionalDesktopNoficationsC(), show);
 }
 
 void ConfigFile::saveGeometry(QWidget *w)
 {
     OC_ASSERT(!w->objectName().isNull());
-    auto settings = makeQSettings();
-    settings.beginGroup(w->objectName());
-    settings.setValue(geometryC(), w->saveGeometry());
-    settings.sync();
+    setValue(groupKey(w->objectName(), geometryC()), w->saveGeometry());
 }
 
 void ConfigFile::restoreGeometry(QWidget *w)
@@ -201,20 +348,16 @@ void ConfigFile::saveGeometryHeader(QHeaderView *header)
         return;
     OC_ASSERT(!header->objectName().isEmpty());
 
-    auto settings = makeQSettings();
-    settings.beginGroup(header->objectName());
-    settings.setValue(geometryC(), header->saveState());
-    settings.sync();
+    setValue(groupKey(header->objectName(), geometryC()), header->saveState());
 }
 
 bool ConfigFile::restoreGeometryHeader(QHeaderView *header)
 {
     Q_ASSERT(header && !header->objectName().isNull());
 
-    auto settings = makeQSettings();
-    settings.beginGroup(header->objectName());
-    if (settings.contains(geometryC())) {
-        header->restoreState(settings.value(geometryC()).toByteArray());
+    const QString key = groupKey(header->objectName(), geometryC());
+    if (SettingsSnapshot::user().contains(key)) {
+        header->restoreState(SettingsSnapshot::user().value(key).toByteArray());
         return true;
     }
     return false;
@@ -368,29 +511,21 @@ QString ConfigFile::defaultConnection() const
 void ConfigFile::storeData(const QString &group, const QString &key, const QVariant &value)
 {
     const QString con(group.isEmpty() ? defaultConnection() : group);
-    auto settings = makeQSettings();
-
-    settings.beginGroup(con);
-    settings.setValue(key, value);
-    settings.sync();
+    setValue(groupKey(con, key), value);
 }
 
 void ConfigFile::removeData(const QString &group, const QString &key)
 {
     const QString con(group.isEmpty() ? defaultConnection() : group);
-    auto settings = makeQSettings();
-
-    settings.beginGroup(con);
-    settings.remove(key);
+    if (SettingsSnapshot::user().remove(groupKey(con, key))) {
+        emit ConfigFileNotifier::instance()->changed(groupKey(con, key));
+    }
 }
 
 bool ConfigFile::dataExists(const QString &group, const QString &key) const
 {
     const QString con(group.isEmpty() ? defaultConnection() : group);
-    auto settings = makeQSettings();
-
-    settings.beginGroup(con);
-    return settings.contains(key);
+    return SettingsSnapshot::user().contains(groupKey(con, key));
 }
 
 chrono::milliseconds ConfigFile::remotePollInterval(std::chrono::seconds defaultVal, const QString &connection) const
@@ -399,9 +534,6 @@ chrono::milliseconds ConfigFile::remotePollInterval(std::chrono::seconds default
     if (connection.isEmpty())
         con = defaultConnection();
 
-    auto settings = makeQSettings();
-    settings.beginGroup(con);
-
     auto defaultPollInterval { DefaultRemotePollInterval };
 
     // The server default-capabilities was set to 60 in some server releases,
@@ -412,7 +544,7 @@ chrono::milliseconds ConfigFile::remotePollInterval(std::chrono::seconds default
     if (defaultVal > chrono::seconds(5)) {
         defaultPollInterval = defaultVal;
     }
-    auto remoteInterval = millisecondsValue(settings, remotePollIntervalC(), defaultPollInterval);
+    auto remoteInterval = millisecondsValue(groupKey(con, remotePollIntervalC()), defaultPollInterval);
     if (remoteInterval < chrono::seconds(5)) {
         remoteInterval = defaultPollInterval;
         qCWarning(lcConfigFile) << "Remote Interval is less than 5 seconds, reverting to" << remoteInterval.count();
@@ -430,10 +562,7 @@ void ConfigFile::setRemotePollInterval(chrono::milliseconds interval, const QStr
         qCWarning(lcConfigFile) << "Remote Poll interval of " << interval.count() << " is below five seconds.";
         return;
     }
-    auto settings = makeQSettings();
-    settings.beginGroup(con);
-    settings.setValue(remotePollIntervalC(), qlonglong(interval.count()));
-    settings.sync();
+    setValue(groupKey(con, remotePollIntervalC()), qlonglong(interval.count()));
 }
 
 chrono::milliseconds ConfigFile::forceSyncInterval(std::chrono::seconds remoteFromCapabilities, const QString &connection) const
@@ -443,11 +572,9 @@ chrono::milliseconds ConfigFile::forceSyncInterval(std::chrono::seconds remoteFr
     QString con(connection);
     if (connection.isEmpty())
         con = defaultConnection();
-    auto settings = makeQSettings();
-    settings.beginGroup(con);
 
     auto defaultInterval = chrono::hours(2);
-    auto interval = millisecondsValue(settings, forceSyncIntervalC(), defaultInterval);
+    auto interval = millisecondsValue(groupKey(con, forceSyncIntervalC()), defaultInterval);
     if (interval < pollInterval) {
         qCWarning(lcConfigFile) << "Force sync interval is less than the remote poll inteval, reverting to" << pollInterval.count();
         interval = pollInterval;
@@ -457,9 +584,7 @@ chrono::milliseconds ConfigFile::forceSyncInterval(std::chrono::seconds remoteFr
 
 chrono::milliseconds OCC::ConfigFile::fullLocalDiscoveryInterval() const
 {
-    auto settings = makeQSettings();
-    settings.beginGroup(defaultConnection());
-    return millisecondsValue(settings, fullLocalDiscoveryIntervalC(), chrono::hours(1));
+    return millisecondsValue(groupKey(defaultConnection(), fullLocalDiscoveryIntervalC()), chrono::hours(1));
 }
 
 chrono::milliseconds ConfigFile::notificationRefreshInterval(const QString &connection) const
@@ -467,11 +592,9 @@ chrono::milliseconds ConfigFile::notificationRefreshInterval(const QString &conn
     QString con(connection);
     if (connection.isEmpty())
         con = defaultConnection();
-    auto settings = makeQSettings();
-    settings.beginGroup(con);
 
     auto defaultInterval = chrono::minutes(5);
-    auto interval = millisecondsValue(settings, notificationRefreshIntervalC(), defaultInterval);
+    auto interval = millisecondsValue(groupKey(con, notificationRefreshIntervalC()), defaultInterval);
     if (interval < chrono::minutes(1)) {
         qCWarning(lcConfigFile) << "Notification refresh interval smaller than one minute, setting to one minute";
         interval = chrono::minutes(1);
@@ -484,11 +607,9 @@ chrono::milliseconds ConfigFile::updateCheckInterval(const QString &connection)
     QString con(connection);
     if (connection.isEmpty())
         con = defaultConnection();
-    auto settings = makeQSettings();
-    settings.beginGroup(con);
 
     auto defaultInterval = chrono::hours(10);
-    auto interval = millisecondsValue(settings, updateCheckIntervalC(), defaultInterval);
+    auto interval = millisecondsValue(groupKey(con, updateCheckIntervalC()), defaultInterval);
 
     auto minInterval = chrono::minutes(5);
     if (interval < minInterval) {
@@ -517,11 +638,7 @@ void ConfigFile::setSkipUpdateCheck(bool skip, const QString &connection)
     if (connection.isEmpty())
         con = defaultConnection();
 
-    auto settings = makeQSettings();
-    settings.beginGroup(con);
-
-    settings.setValue(skipUpdateCheckC(), QVariant(skip));
-    settings.sync();
+    setValue(groupKey(con, skipUpdateCheckC()), QVariant(skip));
 }
 
 QString ConfigFile::updateChannel() const
@@ -536,26 +653,22 @@ QString ConfigFile::updateChannel() const
         defaultUpdateChannel = QStringLiteral("beta");
     }
 
-    auto settings = makeQSettings();
-    return settings.value(updateChannelC(), defaultUpdateChannel).toString();
+    return SettingsSnapshot::user().value(updateChannelC(), defaultUpdateChannel).toString();
 }
 
 void ConfigFile::setUpdateChannel(const QString &channel)
 {
-    auto settings = makeQSettings();
-    settings.setValue(updateChannelC(), channel);
+    setValue(updateChannelC(), channel);
 }
 
 QString ConfigFile::uiLanguage() const
 {
-    auto settings = makeQSettings();
-    return settings.value(uiLanguageC(), QString()).toString();
+    return SettingsSnapshot::user().value(uiLanguageC(), QString()).toString();
 }
 
 void ConfigFile::setUiLanguage(const QString &uiLanguage)
 {
-    auto settings = makeQSettings();
-    settings.setValue(uiLanguageC(), uiLanguage);
+    setValue(uiLanguageC(), uiLanguage);
 }
 
 void ConfigFile::setProxyType(int proxyType,
@@ -564,58 +677,33 @@ void ConfigFile::setProxyType(int proxyType,
     const QString &user,
     const QString &pass)
 {
-    auto settings = makeQSettings();
-
-    settings.setValue(proxyTypeC(), proxyType);
+    setValue(proxyTypeC(), proxyType);
 
     if (proxyType == QNetworkProxy::HttpProxy || proxyType == QNetworkProxy::Socks5Proxy) {
-        settings.setValue(proxyHostC(), host);
-        settings.setValue(proxyPortC(), port);
-        settings.setValue(proxyNeedsAuthC(), needsAuth);
-        settings.setValue(proxyUserC(), user);
-        settings.setValue(proxyPassC(), pass.toUtf8().toBase64());
+        setValue(proxyHostC(), host);
+        setValue(proxyPortC(), port);
+        setValue(proxyNeedsAuthC(), needsAuth);
+        setValue(proxyUserC(), user);
+        setValue(proxyPassC(), pass.toUtf8().toBase64());
     }
-    settings.sync();
 }
 
 QVariant ConfigFile::getValue(const QString &param, const QString &group,
     const QVariant &defaultValue) const
 {
-    QVariant systemSetting;
-    if (Utility::isMac()) {
-        QSettings systemSettings(QStringLiteral("/Library/Preferences/" APPLICATION_REV_DOMAIN ".plist"), QSettings::NativeFormat);
-        if (!group.isEmpty()) {
-            systemSettings.beginGroup(group);
-        }
-        systemSetting = systemSettings.value(param, defaultValue);
-    } else if (Utility::isUnix()) {
-        QSettings systemSettings(QStringLiteral(SYSCONFDIR "/%1/%1.conf").arg(Theme::instance()->appName()), QSettings::NativeFormat);
-        if (!group.isEmpty()) {
-            systemSettings.beginGroup(group);
-        }
-        systemSetting = systemSettings.value(param, defaultValue);
-    } else { // Windows
-        QSettings systemSettings(QStringLiteral("HKEY_LOCAL_MACHINE\\Software\\" APPLICATION_VENDOR "\\%1")
-                                     .arg(Theme::instance()->appNameGUI()),
-            QSettings::NativeFormat);
-        if (!group.isEmpty()) {
-            systemSettings.beginGroup(group);
-        }
-        systemSetting = systemSettings.value(param, defaultValue);
-    }
-
-    auto settings = makeQSettings();
-    if (!group.isEmpty())
-        settings.beginGroup(group);
-
-    return settings.value(param, systemSetting);
+    const QString key = groupKey(group, param);
+    const QVariant systemSetting = SettingsSnapshot::system().value(key, defaultValue);
+    return SettingsSnapshot::user().value(key, systemSetting);
 }
 
 void ConfigFile::setValue(const QString &key, const QVariant &value)
 {
-    auto settings = makeQSettings();
-
-    settings.setValue(key, value);
+    if (SettingsSnapshot::user().setValue(key, value)) {
+        emit ConfigFileNotifier::instance()->changed(key);
+        if (key.startsWith(QLatin1String("BWLimit/"))) {
+            emit ConfigFileNotifier::instance()->networkLimitsChanged();
+        }
+    }
 }
 
 int ConfigFile::proxyType() const
@@ -728,67 +816,57 @@ void ConfigFile::setMoveToTrash(bool isChecked)
 
 bool ConfigFile::promptDeleteFiles() const
 {
-    auto settings = makeQSettings();
-    return settings.value(promptDeleteC(), true).toBool();
+    return SettingsSnapshot::user().value(promptDeleteC(), true).toBool();
 }
 
 void ConfigFile::setPromptDeleteFiles(bool promptDeleteFiles)
 {
-    auto settings = makeQSettings();
-    settings.setValue(promptDeleteC(), promptDeleteFiles);
+    setValue(promptDeleteC(), promptDeleteFiles);
 }
 
 bool ConfigFile::monoIcons() const
 {
-    auto settings = makeQSettings();
     bool monoDefault = false; // On Mac we want bw by default
 #ifdef Q_OS_MAC
     // OEM themes are not obliged to ship mono icons
     monoDefault = (0 == (strcmp("ownCloud", APPLICATION_NAME)));
 #endif
-    return settings.value(monoIconsC(), monoDefault).toBool();
+    return SettingsSnapshot::user().value(monoIconsC(), monoDefault).toBool();
 }
 
 void ConfigFile::setMonoIcons(bool useMonoIcons)
 {
-    auto settings = makeQSettings();
-    settings.setValue(monoIconsC(), useMonoIcons);
+    setValue(monoIconsC(), useMonoIcons);
 }
 
 bool ConfigFile::crashReporter() const
 {
-    auto settings = makeQSettings();
-    return settings.value(crashReporterC(), true).toBool();
+    return SettingsSnapshot::user().value(crashReporterC(), true).toBool();
 }
 
 void ConfigFile::setCrashReporter(bool enabled)
 {
-    auto settings = makeQSettings();
-    settings.setValue(crashReporterC(), enabled);
+    setValue(crashReporterC(), enabled);
 }
 
 bool ConfigFile::automaticLogDir() const
 {
-    auto settings = makeQSettings();
-    return settings.value(automaticLogDirC(), false).toBool();
+    return SettingsSnapshot::user().value(automaticLogDirC(), false).toBool();
 }
 
 void ConfigFile::setAutomaticLogDir(bool enabled)
 {
-    auto settings = makeQSettings();
-    settings.setValue(automaticLogDirC(), enabled);
+    setValue(automaticLogDirC(), enabled);
 }
 
 int ConfigFile::automaticDeleteOldLogs() const
 {
-    auto settings = makeQSettings();
-    return settings.value(numberOfLogsToKeepC()).toInt();
+    return SettingsSnapshot::user().value(numberOfLogsToKeepC()).toInt();
 }
 
 void ConfigFile::setAutomaticDeleteOldLogs(int number)
 {
-    auto settings = makeQSettings();
-    settings.setValue(numberOfLogsToKeepC(), number);
+    setValue(numberOfLogsToKeepC(), number);
 }
 
 void ConfigFile::configureHttpLogging(std::optional<bool> enable)
@@ -797,8 +875,7 @@ void ConfigFile::configureHttpLogging(std::optional<bool> enable)
         enable = logHttp();
     }
 
-    auto settings = makeQSettings();
-    settings.setValue(logHttpC(), enable.value());
+    setValue(logHttpC(), enable.value());
 
     static const QSet<QString> rule = { QStringLiteral("sync.httplogger=true") };
 
@@ -811,26 +888,22 @@ void ConfigFile::configureHttpLogging(std::optional<bool> enable)
 
 bool ConfigFile::logHttp() const
 {
-    auto settings = makeQSettings();
-    return settings.value(logHttpC(), false).toBool();
+    return SettingsSnapshot::user().value(logHttpC(), false).toBool();
 }
 
 bool ConfigFile::showExperimentalOptions() const
 {
-    auto settings = makeQSettings();
-    return settings.value(showExperimentalOptionsC(), false).toBool();
+    return SettingsSnapshot::user().value(showExperimentalOptionsC(), false).toBool();
 }
 
 QString ConfigFile::clientVersionString() const
 {
-    auto settings = makeQSettings();
-    return settings.value(clientVersionC(), QString()).toString();
+    return SettingsSnapshot::user().value(clientVersionC(), QString()).toString();
 }
 
 void ConfigFile::setClientVersionString(const QString &version)
 {
-    auto settings = makeQSettings();
-    settings.setValue(clientVersionC(), version);
+    setValue(clientVersionC(), version);
 }
 
 std::unique_ptr<QSettings> ConfigFile::settingsWithGroup(const QString &group)
@@ -18,6 +18,7 @@
 #include "common/result.h"
 #include "owncloudlib.h"
 
+#include <QObject>
 #include <QSharedPointer>
 #include <QSettings>
 #include <QString>
@@ -35,9 +36,37 @@ namespace OCC {
 
 class AbstractCredentials;
 
+/**
+ * @brief Notifies about changes of the settings written through ConfigFile
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT ConfigFileNotifier : public QObject
+{
+    Q_OBJECT
+public:
+    static ConfigFileNotifier *instance();
+
+Q_SIGNALS:
+    /** The value of key changed, key is relative to the root of the config file, like BWLimit/uploadLimit */
+    void changed(const QString &key);
+    /** One of the bandwidth limits changed */
+    void networkLimitsChanged();
+
+private:
+    explicit ConfigFileNotifier(QObject *parent)
+        : QObject(parent)
+    {
+    }
+};
+
 /**
  * @brief The ConfigFile class
  * @ingroup libsync
+ *
+ * The settings are read once and kept in memory for the whole process,
+ * the setters update them and write them to the file. Settings that are
+ * written with makeQSettings() or settingsWithGroup() aren't seen until
+ * reload() is called.
  */
 class OWNCLOUDSYNC_EXPORT ConfigFile
 {
@@ -49,6 +78,9 @@ public:
 
     ConfigFile();
 
+    /** Reads the settings from the file again */
+    static void reload();
+
     enum Scope {
         UserScope,
         SystemScope
@@ -167,6 +199,13 @@ public:
     qint64 minChunkSize() const;
     std::chrono::milliseconds targetChunkUploadDuration() const;
 
+    /// The number of folders that are synced at the same time
+    int maxParallelFolderSyncs() const;
+    /// The maximal number of active network jobs of all running syncs
+    int maxTotalTransferJobs() const;
+    /// The maximal number of active network jobs of all running syncs with one server, 0 means no limit
+    int maxTransferJobsPerHost() const;
+
     void saveGeometry(QWidget *w);
     void restoreGeometry(QWidget *w);
 
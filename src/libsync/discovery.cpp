@@ -28,6 +28,7 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QSet>
 #include <QTextCodec>
 #include <QThreadPool>
 
@@ -35,12 +36,42 @@ namespace OCC {
 
 Q_LOGGING_CATEGORY(lcDisco, "sync.discovery", QtInfoMsg)
 
+namespace {
+/**
+ * The order in which the entries of a directory are reconciled.
+ *
+ * On case preserving file systems names that only differ in case are
+ * next to each other, entries are still only matched by their exact name.
+ */
+struct EntryNameLess
+{
+    Qt::CaseSensitivity caseSensitivity = Utility::fsCaseSensitivity();
+
+    bool operator()(const QString &a, const QString &b) const
+    {
+        if (caseSensitivity == Qt::CaseInsensitive) {
+            const int cmp = a.compare(b, Qt::CaseInsensitive);
+            if (cmp != 0) {
+                return cmp < 0;
+            }
+        }
+        return a < b;
+    }
+};
+}
+
 void ProcessDirectoryJob::start()
 {
     qCInfo(lcDisco) << "STARTING" << _currentFolder._server << _queryServer << _currentFolder._local << _queryLocal;
 
     if (_queryServer == NormalQuery) {
-        _serverJob = startAsyncServerQuery();
+        _usesRemoteDelta = fillServerEntriesFromRemoteDelta();
+        // The root has no db entry, its etag and permissions are always queried
+        if (!_usesRemoteDelta || !_dirItem) {
+            _serverJob = startAsyncServerQuery();
+        } else {
+            _serverQueryDone = true;
+        }
     } else {
         _serverQueryDone = true;
     }
@@ -68,95 +99,157 @@ void ProcessDirectoryJob::process()
 {
     OC_ASSERT(_localQueryDone && _serverQueryDone);
 
-    // Build lookup tables for local, remote and db entries.
+    // Sort the server, db and local entries by name and merge them. Unlike a
+    // lookup table this needs no allocation per name, which matters for
+    // directories with a huge number of entries.
     // For suffix-virtual files, the key will normally be the base file name
     // without the suffix.
     // However, if foo and foo.owncloud exists locally, there'll be "foo"
     // with local, db, server entries and "foo.owncloud" with only a local
     // entry.
-    struct Entries {
-        QString nameOverride;
-        SyncJournalFileRecord dbEntry;
-        RemoteInfo serverEntry;
-        LocalInfo localEntry;
+    const EntryNameLess less;
+    const auto byName = [&less](const auto &a, const auto &b) { return less(a.name, b.name); };
+    const auto containsName = [&less](const auto &sortedEntries, const QString &name) {
+        auto it = std::lower_bound(sortedEntries.cbegin(), sortedEntries.cend(), name,
+            [&less](const auto &entry, const QString &n) { return less(entry.name, n); });
+        return it != sortedEntries.cend() && it->name == name;
     };
-    std::map<QString, Entries> entries;
-    for (auto &e : _serverNormalQueryEntries) {
-        entries[e.name].serverEntry = std::move(e);
-    }
+
+    // stable, so that the last of several entries with the same name wins
+    auto serverEntries = std::move(_serverNormalQueryEntries);
     _serverNormalQueryEntries.clear();
+    std::stable_sort(serverEntries.begin(), serverEntries.end(), byName);
 
     // fetch all the name from the DB
-    auto pathU8 = _currentFolder._original.toUtf8();
-    if (!_discoveryData->_statedb->listFilesInPath(pathU8, [&](const SyncJournalFileRecord &rec) {
-            auto name = pathU8.isEmpty() ? QString::fromUtf8(rec._path) : QString::fromUtf8(rec._path.constData() + (pathU8.size() + 1));
+    struct DbEntry
+    {
+        QString name;
+        SyncJournalFileRecord record;
+    };
+    std::vector<DbEntry> dbEntries;
+    auto &dbPaths = _discoveryData->_dbPaths;
+    if (!_discoveryData->_statedb->listFilesInPath(dbPaths, _dbDir, [&](PathTable::Handle handle, const SyncJournalFileRecord &rec) {
+            auto name = dbPaths.name(handle);
             if (rec.isVirtualFile() && isVfsWithSuffix()) {
                 name = chopVirtualFileSuffix(name);
             }
-            auto &dbEntry = entries[name].dbEntry;
-            dbEntry = rec;
-            setupDbPinStateActions(dbEntry);
+            dbEntries.push_back({ std::move(name), rec });
+            setupDbPinStateActions(dbEntries.back().record);
         })) {
         dbError();
         return;
     }
+    std::stable_sort(dbEntries.begin(), dbEntries.end(), byName);
 
+    struct LocalEntry
+    {
+        QString name; // the name the entry is reconciled under
+        QString nameOverride;
+        LocalInfo info;
+    };
+    std::vector<LocalEntry> localEntries;
+    localEntries.reserve(_localNormalQueryEntries.size());
     for (auto &e : _localNormalQueryEntries) {
-        entries[e.name].localEntry = e;
+        localEntries.push_back({ e.name, QString(), std::move(e) });
     }
+    _localNormalQueryEntries.clear();
+    std::stable_sort(localEntries.begin(), localEntries.end(), byName);
+
     if (isVfsWithSuffix()) {
         // For vfs-suffix the local data for suffixed files should usually be associated
         // with the non-suffixed name. Unless both names exist locally or there's
         // other data about the suffixed file.
-        // This is done in a second path in order to not depend on the order of
-        // _localNormalQueryEntries.
-        for (auto &e : _localNormalQueryEntries) {
-            if (!e.isVirtualFile)
+        QSet<QString> movedLocalNames;
+        const auto hasLocalEntry = [&](const QString &name) {
+            if (movedLocalNames.contains(name)) {
+                return true;
+            }
+            // info.name stays sorted while the entries are renamed
+            auto it = std::lower_bound(localEntries.cbegin(), localEntries.cend(), name,
+                [&less](const LocalEntry &entry, const QString &n) { return less(entry.info.name, n); });
+            return it != localEntries.cend() && it->info.name == name && it->name == name;
+        };
+        bool renamed = false;
+        for (auto &e : localEntries) {
+            if (!e.info.isVirtualFile)
                 continue;
-            auto &suffixedEntry = entries[e.name];
-            bool hasOtherData = suffixedEntry.serverEntry.isValid() || suffixedEntry.dbEntry.isValid();
-
-            auto nonvirtualName = chopVirtualFileSuffix(e.name);
-            auto &nonvirtualEntry = entries[nonvirtualName];
-            // If the non-suffixed entry has no data, move it
-            if (!nonvirtualEntry.localEntry.isValid()) {
-                std::swap(nonvirtualEntry.localEntry, suffixedEntry.localEntry);
-                if (!hasOtherData)
-                    entries.erase(e.name);
+            bool hasOtherData = containsName(serverEntries, e.info.name) || containsName(dbEntries, e.info.name);
+
+            auto nonvirtualName = chopVirtualFileSuffix(e.info.name);
+            // If the non-suffixed name has no local data, move it
+            if (!hasLocalEntry(nonvirtualName)) {
+                movedLocalNames.insert(nonvirtualName);
+                e.name = nonvirtualName;
+                renamed = true;
             } else if (!hasOtherData) {
                 // Normally a lone local suffixed file would be processed under the
                 // unsuffixed name. In this special case it's under the suffixed name.
                 // To avoid lots of special casing, make sure PathTuple::addName()
                 // will be called with the unsuffixed name anyway.
-                suffixedEntry.nameOverride = nonvirtualName;
+                e.nameOverride = nonvirtualName;
             }
         }
+        if (renamed) {
+            std::stable_sort(localEntries.begin(), localEntries.end(), byName);
+        }
     }
-    _localNormalQueryEntries.clear();
 
     //
     // Iterate over entries and process them
     //
-    for (const auto &f : entries) {
-        const auto &e = f.second;
+    const RemoteInfo noServerEntry;
+    const SyncJournalFileRecord noDbEntry;
+    const LocalEntry noLocalEntry;
+    auto server = serverEntries.cbegin();
+    auto db = dbEntries.cbegin();
+    auto local = localEntries.cbegin();
+    while (server != serverEntries.cend() || db != dbEntries.cend() || local != localEntries.cend()) {
+        // The smallest name of the three inputs
+        QString name;
+        bool hasName = false;
+        const auto pickName = [&](const auto &it, const auto &end) {
+            if (it != end && (!hasName || less(it->name, name))) {
+                name = it->name;
+                hasName = true;
+            }
+        };
+        pickName(server, serverEntries.cend());
+        pickName(db, dbEntries.cend());
+        pickName(local, localEntries.cend());
+
+        // Consumes the entries with that name, the last one wins
+        const auto take = [&name](auto &it, const auto &end) {
+            decltype(&*it) found = nullptr;
+            for (; it != end && it->name == name; ++it) {
+                found = &*it;
+            }
+            return found;
+        };
+        const auto *serverFound = take(server, serverEntries.cend());
+        const auto *dbFound = take(db, dbEntries.cend());
+        const auto *localFound = take(local, localEntries.cend());
+        const RemoteInfo &serverEntry = serverFound ? *serverFound : noServerEntry;
+        const SyncJournalFileRecord &dbEntry = dbFound ? dbFound->record : noDbEntry;
+        const LocalInfo &localEntry = localFound ? localFound->info : noLocalEntry.info;
+        const QString &nameOverride = localFound ? localFound->nameOverride : noLocalEntry.nameOverride;
 
         PathTuple path;
-        path = _currentFolder.addName(e.nameOverride.isEmpty() ? f.first : e.nameOverride);
+        path = _currentFolder.addName(nameOverride.isEmpty() ? name : nameOverride);
 
         if (isVfsWithSuffix()) {
             // Without suffix vfs the paths would be good. But since the dbEntry and localEntry
-            // can have different names from f.first when suffix vfs is on, make sure the
+            // can have different names from name when suffix vfs is on, make sure the
             // corresponding _original and _local paths are right.
 
-            if (e.dbEntry.isValid()) {
-                path._original = QString::fromUtf8(e.dbEntry._path);
-            } else if (e.localEntry.isVirtualFile) {
+            if (dbEntry.isValid()) {
+                path._original = QString::fromUtf8(dbEntry._path);
+            } else if (localEntry.isVirtualFile) {
                 // We don't have a db entry - but it should be at this path
-                path._original = PathTuple::pathAppend(_currentFolder._original,  e.localEntry.name);
+                path._original = PathTuple::pathAppend(_currentFolder._original,  localEntry.name);
             }
-            if (e.localEntry.isValid()) {
-                path._local = PathTuple::pathAppend(_currentFolder._local, e.localEntry.name);
-            } else if (e.dbEntry.isVirtualFile()) {
+            if (localEntry.isValid()) {
+                path._local = PathTuple::pathAppend(_currentFolder._local, localEntry.name);
+            } else if (dbEntry.isVirtualFile()) {
                 // We don't have a local entry - but it should be at this path
                 addVirtualFileSuffix(path._local);
             }
@@ -166,14 +259,14 @@ void ProcessDirectoryJob::process()
         // For windows, the hidden state is also discovered within the vio
         // local stat function.
         // Recall file shall not be ignored (#4420)
-        bool isHidden = e.localEntry.isHidden || (f.first[0] == QLatin1Char('.') && f.first != QLatin1String(".sys.admin#recall#"));
+        bool isHidden = localEntry.isHidden || (name[0] == QLatin1Char('.') && name != QLatin1String(".sys.admin#recall#"));
         if (handleExcluded(path._target,
-                e.localEntry.name,
-                e.localEntry.isDirectory || e.serverEntry.isDirectory,
+                localEntry.name,
+                localEntry.isDirectory || serverEntry.isDirectory,
                 isHidden,
-                e.localEntry.isSymLink)) {
+                localEntry.isSymLink)) {
             // the file only exists in the db
-            if (!e.localEntry.isValid() && e.dbEntry.isValid()) {
+            if (!localEntry.isValid() && dbEntry.isValid() && !_discoveryData->_planOnly) {
                 qCWarning(lcDisco) << "Removing db entry for non exisitng ignored file:" << path._original;
                 _discoveryData->_statedb->deleteFileRecord(path._original, true);
             }
@@ -181,10 +274,10 @@ void ProcessDirectoryJob::process()
         }
 
         if (_queryServer == InBlackList || _discoveryData->isInSelectiveSyncBlackList(path._original)) {
-            processBlacklisted(path, e.localEntry, e.dbEntry);
+            processBlacklisted(path, localEntry, dbEntry);
             continue;
         }
-        processFile(std::move(path), e.localEntry, e.serverEntry, e.dbEntry);
+        processFile(std::move(path), localEntry, serverEntry, dbEntry);
     }
     QTimer::singleShot(0, _discoveryData, &DiscoveryPhase::scheduleMoreJobs);
 }
@@ -455,7 +548,10 @@ void ProcessDirectoryJob::processFileAnalyzeRemoteInfo(
             item->_instruction = CSYNC_INSTRUCTION_UPDATE_METADATA;
             item->_direction = SyncFileItem::Down;
         } else {
-            processFileAnalyzeLocalInfo(item, path, localEntry, serverEntry, dbEntry, ParentNotChanged);
+            // The etags of the parents should have changed as well, but don't rely on it
+            // when the server reported changes below this directory
+            const bool changesBelow = serverEntry.isDirectory && _discoveryData->hasRemoteChangesBelow(path._server);
+            processFileAnalyzeLocalInfo(item, path, localEntry, serverEntry, dbEntry, changesBelow ? NormalQuery : ParentNotChanged);
             return;
         }
 
@@ -701,7 +797,9 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
         } else if (noServerEntry) {
             // Not locally, not on the server. The entry is stale!
             qCInfo(lcDisco) << "Stale DB entry";
-            _discoveryData->_statedb->deleteFileRecord(path._original, true);
+            if (!_discoveryData->_planOnly) {
+                _discoveryData->_statedb->deleteFileRecord(path._original, true);
+            }
             return;
         } else if (dbEntry._type == ItemTypeVirtualFile && isVfsWithSuffix()) {
             // If the virtual file is removed, recreate it.
@@ -924,6 +1022,7 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
     // If it's not a move it's just a local-NEW
     if (!moveCheck()) {
         postProcessLocalNew(path);
+        processFileFindCopySource(item, path, localEntry, base);
         finalize(path, recurseQueryServer);
         return;
     }
@@ -953,8 +1052,10 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
         if (wasDeletedOnClient.first) {
             // More complicated. The REMOVE is canceled. Restore will happen next sync.
             qCInfo(lcDisco) << "Undid remove instruction on source" << originalPath;
-            _discoveryData->_statedb->deleteFileRecord(originalPath, true);
-            _discoveryData->_statedb->schedulePathForRemoteDiscovery(originalPath);
+            if (!_discoveryData->_planOnly) {
+                _discoveryData->_statedb->deleteFileRecord(originalPath, true);
+                _discoveryData->_statedb->schedulePathForRemoteDiscovery(originalPath);
+            }
             _discoveryData->_anotherSyncNeeded = true;
         } else {
             // Signal to future checkPermissions() to forbid the REMOVE and set to restore instead
@@ -1023,6 +1124,59 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
     }
 }
 
+void ProcessDirectoryJob::processFileFindCopySource(const SyncFileItemPtr &item, const PathTuple &path, const LocalInfo &localEntry, const SyncJournalFileRecord &inodeRecord)
+{
+    // Small files are uploaded faster than their checksum is verified
+    static constexpr qint64 minimumCopySize = 100 * 1024;
+    if (item->_instruction != CSYNC_INSTRUCTION_NEW || item->_type != ItemTypeFile || localEntry.size < minimumCopySize) {
+        return;
+    }
+
+    auto useCopySource = [&](const SyncJournalFileRecord &record) {
+        const auto source = QString::fromUtf8(record._path);
+        if (_discoveryData->isRenamed(source)) {
+            qCInfo(lcDisco) << "Not a copy, source already renamed" << source;
+            return false;
+        }
+        item->_copySource = source;
+        item->_copySourceEtag = QString::fromUtf8(record._etag);
+        item->_checksumHeader = record._checksumHeader;
+        qCInfo(lcDisco) << "Copy detected (up)" << source << "->" << path._target;
+        return true;
+    };
+
+    // A hard link of a synced file that wasn't modified since the last sync
+    if (inodeRecord.isValid() && inodeRecord._type == ItemTypeFile
+        && inodeRecord._modtime == localEntry.modtime && inodeRecord._fileSize == localEntry.size
+        && useCopySource(inodeRecord)) {
+        return;
+    }
+
+    // Copies usually keep the mtime, the checksum makes sure the content is the same
+    std::vector<SyncJournalFileRecord> candidates;
+    if (!_discoveryData->_statedb->getFileRecordsBySizeAndModTime(localEntry.size, localEntry.modtime, [&candidates](const SyncJournalFileRecord &record) {
+            candidates.push_back(record);
+        })) {
+        qCWarning(lcDisco) << "Failed to look up copy sources of" << path._local;
+        return;
+    }
+    const QByteArray previousChecksumHeader = item->_checksumHeader;
+    for (const auto &record : candidates) {
+        const auto type = ChecksumHeader::parseChecksumHeader(record._checksumHeader).type();
+        // only compute the local checksum once per checksum type
+        if (ChecksumHeader::parseChecksumHeader(item->_checksumHeader).type() != type) {
+            item->_checksumHeader.clear();
+            if (!computeLocalChecksum(record._checksumHeader, _discoveryData->_localDir + path._local, item)) {
+                continue;
+            }
+        }
+        if (item->_checksumHeader == record._checksumHeader && useCopySource(record)) {
+            return;
+        }
+    }
+    item->_checksumHeader = previousChecksumHeader;
+}
+
 void ProcessDirectoryJob::processFileConflict(const SyncFileItemPtr &item, const ProcessDirectoryJob::PathTuple &path, const LocalInfo &localEntry, const RemoteInfo &serverEntry, const SyncJournalFileRecord &dbEntry)
 {
     item->_previousSize = localEntry.size;
@@ -1401,6 +1555,8 @@ DiscoverySingleDirectoryJob *ProcessDirectoryJob::startAsyncServerQuery()
         _discoveryData->_remoteFolder + _currentFolder._server, this);
     if (!_dirItem)
         serverJob->setIsRootPath(); // query the fingerprint on the root
+    if (_usesRemoteDelta)
+        serverJob->setDirectoryOnly(); // the entries are already known
     connect(serverJob, &DiscoverySingleDirectoryJob::etag, this, &ProcessDirectoryJob::etag);
     _discoveryData->_currentlyActiveJobs++;
     _pendingAsyncJobs++;
@@ -1408,10 +1564,14 @@ DiscoverySingleDirectoryJob *ProcessDirectoryJob::startAsyncServerQuery()
         _discoveryData->_currentlyActiveJobs--;
         _pendingAsyncJobs--;
         if (results) {
-            _serverNormalQueryEntries = *results;
+            if (!_usesRemoteDelta)
+                _serverNormalQueryEntries = *results;
             _serverQueryDone = true;
             if (!serverJob->_dataFingerprint.isEmpty() && _discoveryData->_dataFingerprint.isEmpty())
                 _discoveryData->_dataFingerprint = serverJob->_dataFingerprint;
+            // When using a delta, the token of the delta is already set
+            if (!serverJob->_syncToken.isEmpty() && _discoveryData->_syncToken.isEmpty())
+                _discoveryData->_syncToken = serverJob->_syncToken;
             if (_localQueryDone)
                 this->process();
         } else {
@@ -1428,6 +1588,8 @@ DiscoverySingleDirectoryJob *ProcessDirectoryJob::startAsyncServerQuery()
                 // Similarly, the server might also return 404 or 50x in case of bugs. #7199 #7586
                 _dirItem->_instruction = CSYNC_INSTRUCTION_IGNORE;
                 _dirItem->_errorString = results.error().message;
+                // The changes in that directory must be reported again by the next delta
+                _discoveryData->_remoteTreeIncomplete = true;
                 emit this->finished();
             } else {
                 // Fatal for the root job since it has no SyncFileItem, or for the network errors
@@ -1442,6 +1604,80 @@ DiscoverySingleDirectoryJob *ProcessDirectoryJob::startAsyncServerQuery()
     return serverJob;
 }
 
+bool ProcessDirectoryJob::fillServerEntriesFromRemoteDelta()
+{
+    if (!_discoveryData->_remoteDelta) {
+        return false;
+    }
+    // The delta only reports the entries of renamed directories at their new location
+    if (_currentFolder._server != _currentFolder._original) {
+        return false;
+    }
+    const auto isInvalidated = [](const SyncJournalFileRecord &record) {
+        // see SyncJournalDb::schedulePathForRemoteDiscovery()
+        return record.isDirectory() && record._etag == "_invalid_";
+    };
+    if (_dirItem) {
+        SyncJournalFileRecord record;
+        if (!_discoveryData->_statedb->getFileRecord(_currentFolder._original, &record)
+            || !record.isValid() || !record.isDirectory() || isInvalidated(record)) {
+            return false;
+        }
+    }
+
+    const auto &delta = *_discoveryData->_remoteDelta;
+    const auto dir = delta.paths.find(_currentFolder._server);
+    auto entries = delta.changedEntries.value(dir);
+    auto reportedNames = delta.removedEntries.value(dir);
+    for (const auto &e : qAsConst(entries)) {
+        reportedNames.insert(e.name);
+    }
+
+    // Everything the server did not report is unchanged since the last sync
+    bool hasInvalidatedEntries = false;
+    auto &dbPaths = _discoveryData->_dbPaths;
+    if (!_discoveryData->_statedb->listFilesInPath(dbPaths, _dbDir, [&](PathTable::Handle handle, const SyncJournalFileRecord &rec) {
+            if (isInvalidated(rec)) {
+                // we have no etag to report for it
+                hasInvalidatedEntries = true;
+                return;
+            }
+            auto name = dbPaths.name(handle);
+            if (rec.isVirtualFile() && isVfsWithSuffix()) {
+                name = chopVirtualFileSuffix(name);
+            }
+            if (reportedNames.contains(name)) {
+                return;
+            }
+            RemoteInfo info;
+            info.name = name;
+            info.etag = QString::fromUtf8(rec._etag);
+            info.fileId = rec._fileId;
+            info.checksumHeader = rec._checksumHeader;
+            info.remotePerm = rec._remotePerm;
+            info.modtime = rec._modtime;
+            info.size = rec.isDirectory() ? 0 : rec._fileSize;
+            info.isDirectory = rec.isDirectory();
+            entries.append(std::move(info));
+        })
+        || hasInvalidatedEntries) {
+        return false;
+    }
+
+    // Same as in DiscoverySingleDirectoryJob::directoryListingIteratedSlot
+    if (_dirItem && (_dirItem->_remotePerm.hasPermission(RemotePermissions::IsMounted) || _dirItem->_remotePerm.hasPermission(RemotePermissions::IsMountedSub))) {
+        for (auto &e : entries) {
+            if (e.remotePerm.hasPermission(RemotePermissions::IsMounted)) {
+                e.remotePerm.unsetPermission(RemotePermissions::IsMounted);
+                e.remotePerm.setPermission(RemotePermissions::IsMountedSub);
+            }
+        }
+    }
+
+    _serverNormalQueryEntries = std::move(entries);
+    return true;
+}
+
 void ProcessDirectoryJob::startAsyncLocalQuery()
 {
     QString localPath = _discoveryData->_localDir + _currentFolder._local;
@@ -80,6 +80,7 @@ public:
         , _queryLocal(queryLocal)
         , _discoveryData(parent->_discoveryData)
         , _currentFolder(path)
+        , _dbDir(_discoveryData->_dbPaths.intern(path._original))
     {
         computePinState(parent->_pinState);
     }
@@ -158,6 +159,13 @@ private:
     /// processFile helper for reconciling local changes
     void processFileAnalyzeLocalInfo(const SyncFileItemPtr &item, const PathTuple &, const LocalInfo &, const RemoteInfo &, const SyncJournalFileRecord &, QueryMode recurseQueryServer);
 
+    /** processFile helper for new local files that are a copy of a synced file
+     *
+     * inodeRecord is the db record with the inode of the local file, a hard link
+     * of it. Other copies are found by size, mtime and content checksum.
+     */
+    void processFileFindCopySource(const SyncFileItemPtr &item, const PathTuple &, const LocalInfo &, const SyncJournalFileRecord &inodeRecord);
+
     /// processFile helper for local/remote conflicts
     void processFileConflict(const SyncFileItemPtr &item, const PathTuple &, const LocalInfo &, const RemoteInfo &, const SyncJournalFileRecord &);
 
@@ -206,6 +214,13 @@ private:
      */
     DiscoverySingleDirectoryJob *startAsyncServerQuery();
 
+    /** Fill _serverNormalQueryEntries from the db and the DiscoveryPhase::_remoteDelta
+     *
+     * Returns false if there is no delta or the directory has to be listed
+     * anyway, for example because its etag was invalidated.
+     */
+    bool fillServerEntriesFromRemoteDelta();
+
     /** Discover the local directory
       *
       * Fills _localNormalQueryEntries.
@@ -247,6 +262,9 @@ private:
     RemotePermissions _rootPermissions;
     QPointer<DiscoverySingleDirectoryJob> _serverJob;
 
+    // Whether _serverNormalQueryEntries were filled from the remote delta
+    bool _usesRemoteDelta = false;
+
 
     /** Number of currently running async jobs.
      *
@@ -270,6 +288,8 @@ private:
     DiscoveryPhase *_discoveryData;
 
     PathTuple _currentFolder;
+    // _currentFolder._original in DiscoveryPhase::_dbPaths
+    PathTable::Handle _dbDir = PathTable::root;
     bool _childModified = false; // the directory contains modified item what would prevent deletion
     bool _childIgnored = false; // The directory contains ignored item that would prevent deletion
     PinState _pinState = PinState::Unspecified; // The directory's pin-state, see computePinState()
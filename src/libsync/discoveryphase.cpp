@@ -61,6 +61,25 @@ static bool findPathInList(const QStringList &list, const QString &path)
     return pathSlash.startsWith(*it);
 }
 
+// The properties needed to fill a RemoteInfo, see propertyMapToRemoteInfo()
+static QList<QByteArray> remoteInfoProperties()
+{
+    return {
+        "resourcetype",
+        "getlastmodified",
+        "getcontentlength",
+        "getetag",
+        "http://owncloud.org/ns:id",
+        "http://owncloud.org/ns:downloadURL",
+        "http://owncloud.org/ns:dDC",
+        "http://owncloud.org/ns:permissions",
+        "http://owncloud.org/ns:checksums",
+        "http://owncloud.org/ns:share-types"
+    };
+}
+
+static void propertyMapToRemoteInfo(const QMap<QString, QString> &map, RemoteInfo &result);
+
 bool DiscoveryPhase::isInSelectiveSyncBlackList(const QString &path) const
 {
     if (_selectiveSyncBlackList.isEmpty()) {
@@ -238,6 +257,36 @@ void DiscoveryPhase::setSelectiveSyncWhiteList(const QStringList &list)
     std::sort(_selectiveSyncWhiteList.begin(), _selectiveSyncWhiteList.end());
 }
 
+void DiscoveryPhase::fetchRemoteDelta(const QByteArray &syncToken, const std::function<void()> &callback)
+{
+    _remoteDelta.reset(new RemoteDelta);
+    auto job = new SyncCollectionJob(_account, _baseUrl, _remoteFolder, syncToken, this);
+    job->setProperties(remoteInfoProperties());
+    connect(job, &SyncCollectionJob::itemChanged, this, [this](const QString &path, const QMap<QString, QString> &map) {
+        RemoteInfo result;
+        result.name = path.mid(path.lastIndexOf(QLatin1Char('/')) + 1);
+        result.size = -1;
+        propertyMapToRemoteInfo(map, result);
+        if (result.isDirectory)
+            result.size = 0;
+        _remoteDelta->addChanged(path, std::move(result));
+    });
+    connect(job, &SyncCollectionJob::itemRemoved, this, [this](const QString &path) {
+        _remoteDelta->addRemoved(path);
+    });
+    connect(job, &SyncCollectionJob::finishedWithoutError, this, [this, callback](const QByteArray &newSyncToken) {
+        qCInfo(lcDiscovery) << "Using the remote changes since the last sync:" << _remoteDelta->dirtyDirectories.size() << "changed directories";
+        _syncToken = newSyncToken;
+        callback();
+    });
+    connect(job, &SyncCollectionJob::finishedWithError, this, [this, callback](QNetworkReply *reply) {
+        qCInfo(lcDiscovery) << "The server did not report the remote changes, listing the remote tree" << reply->errorString();
+        _remoteDelta.reset();
+        callback();
+    });
+    job->start();
+}
+
 void DiscoveryPhase::scheduleMoreJobs()
 {
     auto limit = qMax(1, _syncOptions._parallelNetworkJobs);
@@ -333,22 +382,14 @@ DiscoverySingleDirectoryJob::DiscoverySingleDirectoryJob(const AccountPtr &accou
 void DiscoverySingleDirectoryJob::start()
 {
     // Start the actual HTTP job
-    _proFindJob = new PropfindJob(_account, _baseUrl, _subPath, PropfindJob::Depth::One, this);
+    _proFindJob = new PropfindJob(_account, _baseUrl, _subPath, _directoryOnly ? PropfindJob::Depth::Zero : PropfindJob::Depth::One, this);
 
-    QList<QByteArray> props {
-        "resourcetype",
-        "getlastmodified",
-        "getcontentlength",
-        "getetag",
-        "http://owncloud.org/ns:id",
-        "http://owncloud.org/ns:downloadURL",
-        "http://owncloud.org/ns:dDC",
-        "http://owncloud.org/ns:permissions",
-        "http://owncloud.org/ns:checksums",
-        "http://owncloud.org/ns:share-types"
-    };
+    QList<QByteArray> props = remoteInfoProperties();
     if (_isRootPath) {
         props << "http://owncloud.org/ns:data-fingerprint";
+        if (_account->capabilities().syncCollectionReport()) {
+            props << "sync-token";
+        }
     }
 
 
@@ -368,6 +409,32 @@ void DiscoverySingleDirectoryJob::abort()
     }
 }
 
+void RemoteDelta::addChanged(const QString &path, RemoteInfo &&info)
+{
+    const auto handle = paths.intern(path);
+    // share the interned name
+    info.name = paths.name(handle);
+    changedEntries[markParentsDirty(handle)].append(std::move(info));
+}
+
+void RemoteDelta::addRemoved(const QString &path)
+{
+    const auto handle = paths.intern(path);
+    removedEntries[markParentsDirty(handle)].insert(paths.name(handle));
+}
+
+PathTable::Handle RemoteDelta::markParentsDirty(PathTable::Handle handle)
+{
+    const auto parent = paths.parent(handle);
+    for (auto dir = parent; !dirtyDirectories.contains(dir); dir = paths.parent(dir)) {
+        dirtyDirectories.insert(dir);
+        if (dir == PathTable::root) {
+            break;
+        }
+    }
+    return parent;
+}
+
 static void propertyMapToRemoteInfo(const QMap<QString, QString> &map, RemoteInfo &result)
 {
     result.directDownloadUrl = map.value(QStringLiteral("downloadURL"));
@@ -431,6 +498,9 @@ void DiscoverySingleDirectoryJob::directoryListingIteratedSlot(const QString &fi
                 _dataFingerprint = "[empty]";
             }
         }
+        if (auto it = Utility::optionalFind(map, QStringLiteral("sync-token"))) {
+            _syncToken = it->value().toUtf8();
+        }
     } else {
 
         RemoteInfo result;
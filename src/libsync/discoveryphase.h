@@ -25,8 +25,10 @@
 #include <QWaitCondition>
 #include <QRunnable>
 #include <deque>
+#include <memory>
 #include "syncoptions.h"
 #include "syncfileitem.h"
+#include "common/pathtable.h"
 
 #include "csync/csync_exclude.h"
 
@@ -62,6 +64,35 @@ struct RemoteInfo
     QString directDownloadCookies;
 };
 
+/**
+ * The changes on the server since the sync token of the previous sync
+ *
+ * All paths are server paths relative to the sync root, the root itself
+ * is the empty string. They are interned in a PathTable, the entries of a
+ * directory are found by the handle of its path.
+ *
+ * See DiscoveryPhase::fetchRemoteDelta()
+ */
+struct RemoteDelta
+{
+    PathTable paths;
+    /** New or changed entries, by the parent directory */
+    QHash<PathTable::Handle, QVector<RemoteInfo>> changedEntries;
+    /** Names of removed entries, by the parent directory */
+    QHash<PathTable::Handle, QSet<QString>> removedEntries;
+    /** Directories with changes somewhere below them */
+    QSet<PathTable::Handle> dirtyDirectories;
+
+    void addChanged(const QString &path, RemoteInfo &&info);
+    void addRemoved(const QString &path);
+
+    bool hasChangesBelow(const QString &path) const { return dirtyDirectories.contains(paths.find(path)); }
+
+private:
+    // returns the parent directory and marks it and all its parents dirty
+    PathTable::Handle markParentsDirty(PathTable::Handle handle);
+};
+
 struct LocalInfo
 {
     /** FileName of the entry (this does not contains any directory or path, just the plain name */
@@ -117,6 +148,8 @@ public:
     explicit DiscoverySingleDirectoryJob(const AccountPtr &account, const QUrl &baseUrl, const QString &path, QObject *parent = nullptr);
     // Specify that this is the root and we need to check the data-fingerprint
     void setIsRootPath() { _isRootPath = true; }
+    // Only query the directory itself, the entries are known from the RemoteDelta
+    void setDirectoryOnly() { _directoryOnly = true; }
     void start();
     void abort();
 
@@ -142,6 +175,7 @@ private:
     bool _ignoredFirst;
     // Set to true if this is the root path and we need to check the data-fingerprint
     bool _isRootPath;
+    bool _directoryOnly = false;
     // If this directory is an external storage (The first item has 'M' in its permission)
     bool _isExternalStorage;
     // If set, the discovery will finish with an error
@@ -150,6 +184,8 @@ private:
 
 public:
     QByteArray _dataFingerprint;
+    // Only queried on the root
+    QByteArray _syncToken;
 };
 
 class DiscoveryPhase : public QObject
@@ -181,6 +217,14 @@ class DiscoveryPhase : public QObject
     // needs to be ordered
     QMap<QString, ProcessDirectoryJob *> _queuedDeletedDirectories;
 
+    /** The db paths of the listed directories and their entries
+     *
+     * The journal entries are listed through the table, so the name of an
+     * entry is converted from UTF-8 once per sync instead of once per directory
+     * containing it.
+     */
+    PathTable _dbPaths;
+
     // map source (original path) -> destinations (current server or local path)
     QHash<QString, QString> _renamedItemsRemote;
     QHash<QString, QString> _renamedItemsLocal;
@@ -224,6 +268,12 @@ class DiscoveryPhase : public QObject
      */
     QString adjustRenamedPath(const QString &original, SyncFileItem::Direction) const;
 
+    /** Whether the server reported changes below the directory at serverPath
+     *
+     * Always false if the remote tree is listed instead of using a delta.
+     */
+    bool hasRemoteChangesBelow(const QString &serverPath) const { return _remoteDelta && _remoteDelta->hasChangesBelow(serverPath); }
+
     /** If the db-path is scheduled for deletion, abort it.
      *
      * Check if there is already a job to delete that item:
@@ -256,6 +306,8 @@ public:
     QRegExp _invalidFilenameRx; // FIXME: maybe move in ExcludedFiles
     QStringList _serverBlacklistedFiles; // The blacklist from the capabilities
     bool _ignoreHiddenFiles = false;
+    // Don't clean up stale journal entries, the results are only used for a plan
+    bool _planOnly = false;
     std::function<bool(const QString &)> _shouldDiscoverLocaly;
 
     void startJob(ProcessDirectoryJob *);
@@ -263,8 +315,26 @@ public:
     void setSelectiveSyncBlackList(const QStringList &list);
     void setSelectiveSyncWhiteList(const QStringList &list);
 
+    /** Ask the server for the changes since syncToken instead of listing the remote tree
+     *
+     * On success _remoteDelta is set and directories whose etag is known
+     * from the database are not listed during discovery. Their entries are
+     * taken from the database and the delta instead.
+     *
+     * If the server rejects the token, the remote tree is listed as usual.
+     * The callback is called in both cases, before starting discovery.
+     */
+    void fetchRemoteDelta(const QByteArray &syncToken, const std::function<void()> &callback);
+
+    /** Null if the remote tree is listed */
+    std::unique_ptr<RemoteDelta> _remoteDelta;
+
     // output
     QByteArray _dataFingerprint;
+    // the server's sync token for the state discovered in this sync, might be empty
+    QByteArray _syncToken;
+    // Set if remote directories were skipped because of server errors
+    bool _remoteTreeIncomplete = false;
     bool _anotherSyncNeeded = false;
 
 signals:
@@ -27,6 +27,11 @@
 
 #ifdef Q_OS_WIN32
 #include <winsock2.h>
+#include <windows.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
 #endif
 
 namespace OCC {
@@ -189,5 +194,52 @@ bool FileSystem::getInode(const QString &filename, quint64 *inode)
     return false;
 }
 
+FileSystem::PreallocateResult FileSystem::preallocate(QFile &file, qint64 offset, qint64 length)
+{
+    if (length <= 0) {
+        return PreallocateResult::Ok;
+    }
+#if defined(Q_OS_LINUX)
+    if (fallocate(file.handle(), FALLOC_FL_KEEP_SIZE, offset, length) == 0) {
+        return PreallocateResult::Ok;
+    }
+    const int error = errno;
+    if (error == ENOSPC || error == EFBIG || error == EDQUOT) {
+        return PreallocateResult::NoSpace;
+    }
+    qCDebug(lcFileSystem) << "Failed to preallocate" << file.fileName() << strerror(error);
+    return PreallocateResult::Unsupported;
+#elif defined(Q_OS_MAC)
+    Q_UNUSED(offset);
+    // F_PEOFPOSMODE allocates from the end of the already allocated space
+    fstore_t store = { F_ALLOCATEALL, F_PEOFPOSMODE, 0, length, 0 };
+    if (fcntl(file.handle(), F_PREALLOCATE, &store) == 0) {
+        return PreallocateResult::Ok;
+    }
+    const int error = errno;
+    if (error == ENOSPC || error == EFBIG || error == EDQUOT) {
+        return PreallocateResult::NoSpace;
+    }
+    qCDebug(lcFileSystem) << "Failed to preallocate" << file.fileName() << strerror(error);
+    return PreallocateResult::Unsupported;
+#elif defined(Q_OS_WIN)
+    FILE_ALLOCATION_INFO info;
+    info.AllocationSize.QuadPart = offset + length;
+    const auto handle = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+    if (handle != INVALID_HANDLE_VALUE && SetFileInformationByHandle(handle, FileAllocationInfo, &info, sizeof(info))) {
+        return PreallocateResult::Ok;
+    }
+    const auto error = GetLastError();
+    if (error == ERROR_DISK_FULL || error == ERROR_HANDLE_DISK_FULL) {
+        return PreallocateResult::NoSpace;
+    }
+    qCDebug(lcFileSystem) << "Failed to preallocate" << file.fileName() << Utility::formatWinError(error);
+    return PreallocateResult::Unsupported;
+#else
+    Q_UNUSED(file);
+    Q_UNUSED(offset);
+    return PreallocateResult::Unsupported;
+#endif
+}
 
 } // namespace OCC
@@ -68,6 +68,23 @@ namespace FileSystem {
      */
     bool OWNCLOUDSYNC_EXPORT getInode(const QString &filename, quint64 *inode);
 
+    enum class PreallocateResult {
+        Ok,
+        /// There is not enough free space on the disk
+        NoSpace,
+        /// The platform or the file system can't preallocate
+        Unsupported
+    };
+
+    /**
+     * @brief Reserves length bytes on disk for the open file, starting at offset
+     *
+     * The size of the file doesn't change, the reserved space is used when the
+     * file grows. This avoids fragmentation and running out of space halfway
+     * through a download.
+     */
+    PreallocateResult OWNCLOUDSYNC_EXPORT preallocate(QFile &file, qint64 offset, qint64 length);
+
     /**
      * @brief Check if \a fileName has changed given previous size and mtime
      *
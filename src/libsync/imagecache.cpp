@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "imagecache.h"
+
+#include "account.h"
+#include "networkjobs.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcImageCache, "sync.imagecache", QtInfoMsg)
+
+ImageCache::ImageCache(const QString &directory, qint64 maxDiskSize, qint64 maxMemorySize, QObject *parent)
+    : QObject(parent)
+    , _directory(directory)
+    , _maxDiskSize(maxDiskSize)
+{
+    // the cost of a pixmap is its size in KiB
+    _memory.setMaxCost(static_cast<int>(maxMemorySize / 1024));
+}
+
+ImageCache::~ImageCache()
+{
+    qCDebug(lcImageCache) << "Memory hits:" << _statistics.memoryHits << "disk hits:" << _statistics.diskHits << "downloads:" << _statistics.downloads;
+}
+
+ImageCache *ImageCache::instance()
+{
+    static QPointer<ImageCache> cache;
+    if (!cache) {
+        cache = new ImageCache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/images"), DefaultMaxDiskSize, DefaultMaxMemorySize, qApp);
+    }
+    return cache;
+}
+
+QByteArray ImageCache::hash(const Key &key)
+{
+    const QByteArray etag = key.etag.isEmpty() ? QDate::currentDate().toString(Qt::ISODate).toUtf8() : key.etag;
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(key.id.toUtf8());
+    hash.addData("\n", 1);
+    hash.addData(etag);
+    hash.addData("\n", 1);
+    hash.addData(QByteArray::number(key.size.width()) + 'x' + QByteArray::number(key.size.height()));
+    return hash.result().toHex();
+}
+
+QImage ImageCache::decode(const QByteArray &data, const QSize &size)
+{
+    QImage image;
+    if (!image.loadFromData(data)) {
+        return {};
+    }
+    if (size.isValid() && (image.width() > size.width() || image.height() > size.height())) {
+        image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+void ImageCache::fetch(const Key &key, AccountPtr account, const QUrl &baseUrl, const QString &path, QObject *context, const Callback &callback)
+{
+    const QByteArray id = hash(key);
+    const QSize size = key.size;
+    load(id, size, context, callback, [account, baseUrl, path, id, size, this] {
+        ++_statistics.downloads;
+        auto *job = new SimpleNetworkJob(account, baseUrl, path, "GET", nullptr, QNetworkRequest(), this);
+        job->setForceIgnoreCredentialFailure(true);
+        connect(job, &SimpleNetworkJob::finishedSignal, this, [job, id, size, this] {
+            if (job->httpStatusCode() == 200) {
+                store(id, size, job->reply()->readAll());
+            } else {
+                qCDebug(lcImageCache) << "Failed to download" << job->url() << job->httpStatusCode();
+                deliver(id, {});
+            }
+        });
+        job->start();
+    });
+}
+
+void ImageCache::lookup(const Key &key, QObject *context, const Callback &callback)
+{
+    const QByteArray id = hash(key);
+    load(id, key.size, context, callback, [id, this] {
+        deliver(id, {});
+    });
+}
+
+void ImageCache::insert(const Key &key, const QByteArray &data)
+{
+    store(hash(key), key.size, data);
+}
+
+qint64 ImageCache::diskSize()
+{
+    ensureIndex();
+    return _diskSize;
+}
+
+void ImageCache::load(const QByteArray &id, const QSize &size, QObject *context, const Callback &callback, const std::function<void()> &onMiss)
+{
+    ensureIndex();
+    const auto it = _disk.find(id);
+    if (it != _disk.end()) {
+        it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+    }
+    if (auto *pixmap = _memory.object(id)) {
+        ++_statistics.memoryHits;
+        callback(*pixmap);
+        return;
+    }
+    if (!addPending(id, context, callback)) {
+        return;
+    }
+    if (it == _disk.end()) {
+        onMiss();
+        return;
+    }
+    ++_statistics.diskHits;
+
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, id, onMiss, this] {
+        watcher->deleteLater();
+        const QImage image = watcher->result();
+        if (image.isNull()) {
+            qCWarning(lcImageCache) << "Failed to read the cached image" << id;
+            if (auto it = _disk.find(id); it != _disk.end()) {
+                _diskSize -= it->size;
+                _disk.erase(it);
+            }
+            onMiss();
+        } else {
+            decoded(id, image);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([path = _directory + QLatin1Char('/') + QString::fromLatin1(id), size] {
+        QFile file(path);
+        // the image might have been evicted in the meantime, don't create an empty one
+        if (!file.open(QIODevice::ReadWrite | QIODevice::ExistingOnly)) {
+            return QImage();
+        }
+        // keep the order of use across restarts
+        file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+        return decode(file.readAll(), size);
+    }));
+}
+
+bool ImageCache::addPending(const QByteArray &id, QObject *context, const Callback &callback)
+{
+    const bool first = !_pending.contains(id);
+    _pending[id].emplace_back(context, callback);
+    return first;
+}
+
+void ImageCache::deliver(const QByteArray &id, const QPixmap &pixmap)
+{
+    const auto callbacks = _pending.take(id);
+    for (const auto &[context, callback] : callbacks) {
+        if (context) {
+            callback(pixmap);
+        }
+    }
+}
+
+void ImageCache::store(const QByteArray &id, const QSize &size, const QByteArray &data)
+{
+    ensureIndex();
+    auto it = _disk.find(id);
+    if (it != _disk.end()) {
+        _diskSize -= it->size;
+    } else {
+        it = _disk.insert(id, {});
+    }
+    it->size = data.size();
+    it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+    ++it->pendingWrites;
+    _diskSize += data.size();
+    evict();
+    // lookups wait for the decoded image
+    _pending[id];
+
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, id, this] {
+        watcher->deleteLater();
+        if (auto it = _disk.find(id); it != _disk.end()) {
+            --it->pendingWrites;
+        }
+        // the eviction might have waited for this write
+        evict();
+        decoded(id, watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([path = _directory + QLatin1Char('/') + QString::fromLatin1(id), data, size] {
+        QSaveFile file(path);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(data);
+            file.commit();
+        }
+        return decode(data, size);
+    }));
+}
+
+void ImageCache::decoded(const QByteArray &id, const QImage &image)
+{
+    QPixmap pixmap;
+    if (!image.isNull()) {
+        pixmap = QPixmap::fromImage(image);
+        const qint64 bytes = qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+        _memory.insert(id, new QPixmap(pixmap), std::max<int>(1, static_cast<int>(bytes / 1024)));
+    }
+    deliver(id, pixmap);
+}
+
+void ImageCache::ensureIndex()
+{
+    if (_indexed) {
+        return;
+    }
+    _indexed = true;
+    QDir dir(_directory);
+    if (!dir.exists() && !dir.mkpath(QStringLiteral("."))) {
+        qCWarning(lcImageCache) << "Failed to create" << _directory;
+        return;
+    }
+    const auto entries = dir.entryInfoList(QDir::Files);
+    for (const auto &info : entries) {
+        _disk.insert(info.fileName().toLatin1(), { info.size(), info.lastModified().toMSecsSinceEpoch() });
+        _diskSize += info.size();
+    }
+    qCDebug(lcImageCache) << "Found" << _disk.size() << "cached images with" << _diskSize << "bytes in" << _directory;
+    evict();
+}
+
+void ImageCache::evict()
+{
+    while (_diskSize > _maxDiskSize) {
+        // removing a file that is still being written would leave it behind once the write is done
+        auto oldest = _disk.end();
+        for (auto it = _disk.begin(); it != _disk.end(); ++it) {
+            if (it->pendingWrites == 0 && (oldest == _disk.end() || it->lastUsed < oldest->lastUsed)) {
+                oldest = it;
+            }
+        }
+        if (oldest == _disk.end()) {
+            return;
+        }
+        qCDebug(lcImageCache) << "Evicting" << oldest.key();
+        QFile::remove(_directory + QLatin1Char('/') + QString::fromLatin1(oldest.key()));
+        _diskSize -= oldest->size;
+        _disk.erase(oldest);
+    }
+}
+
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#pragma once
+
+#include "accountfwd.h"
+#include "owncloudlib.h"
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QPointer>
+#include <QSize>
+#include <QUrl>
+
+#include <functional>
+#include <vector>
+
+namespace OCC {
+
+/**
+ * @brief A cache for images from the server, like thumbnails, avatars and space images
+ *
+ * The decoded images are kept in memory, the downloaded data on disk. Both
+ * are bounded in size and the least recently used images are evicted first.
+ * Images are read, decoded and written in the thread pool.
+ *
+ * An image is identified by a Key. Without an etag the cached image is used
+ * for the rest of the day.
+ */
+class OWNCLOUDSYNC_EXPORT ImageCache : public QObject
+{
+    Q_OBJECT
+public:
+    struct Key
+    {
+        /// The file id, user or url of the image
+        QString id;
+        QByteArray etag;
+        /// The requested size, larger images are scaled down to it
+        QSize size;
+    };
+
+    struct Statistics
+    {
+        qint64 memoryHits = 0;
+        qint64 diskHits = 0;
+        qint64 downloads = 0;
+    };
+
+    using Callback = std::function<void(const QPixmap &)>;
+
+    static constexpr qint64 DefaultMaxDiskSize = 50 * 1024 * 1024;
+    static constexpr qint64 DefaultMaxMemorySize = 32 * 1024 * 1024;
+
+    ImageCache(const QString &directory, qint64 maxDiskSize = DefaultMaxDiskSize, qint64 maxMemorySize = DefaultMaxMemorySize, QObject *parent = nullptr);
+    ~ImageCache() override;
+
+    /** The cache in the cache location of the application */
+    static ImageCache *instance();
+
+    /** Calls callback with the image, downloading it from baseUrl + path if it isn't cached
+     *
+     * A null pixmap is passed if the image couldn't be downloaded or decoded.
+     * Images in memory are passed immediately, callback isn't called if
+     * context is destroyed before the image is available.
+     */
+    void fetch(const Key &key, AccountPtr account, const QUrl &baseUrl, const QString &path, QObject *context, const Callback &callback);
+
+    /** Like fetch, but passes a null pixmap if the image isn't cached */
+    void lookup(const Key &key, QObject *context, const Callback &callback);
+
+    /** Stores the encoded image data */
+    void insert(const Key &key, const QByteArray &data);
+
+    /** The size of the image data on disk */
+    qint64 diskSize();
+    const Statistics &statistics() const { return _statistics; }
+
+private:
+    struct DiskEntry
+    {
+        qint64 size;
+        qint64 lastUsed;
+        /// Writes in the thread pool that didn't finish yet, the file can't be evicted before
+        int pendingWrites = 0;
+    };
+
+    static QByteArray hash(const Key &key);
+    /// Decodes and scales image data, runs in the thread pool
+    static QImage decode(const QByteArray &data, const QSize &size);
+
+    void load(const QByteArray &id, const QSize &size, QObject *context, const Callback &callback, const std::function<void()> &onMiss);
+    /// Returns false if the image is already being loaded
+    bool addPending(const QByteArray &id, QObject *context, const Callback &callback);
+    void deliver(const QByteArray &id, const QPixmap &pixmap);
+    void store(const QByteArray &id, const QSize &size, const QByteArray &data);
+    void decoded(const QByteArray &id, const QImage &image);
+
+    void ensureIndex();
+    void evict();
+
+    const QString _directory;
+    const qint64 _maxDiskSize;
+
+    QCache<QByteArray, QPixmap> _memory;
+    QHash<QByteArray, DiskEntry> _disk;
+    qint64 _diskSize = 0;
+    bool _indexed = false;
+
+    QHash<QByteArray, std::vector<std::pair<QPointer<QObject>, Callback>>> _pending;
+    Statistics _statistics;
+};
+
+}
@@ -18,6 +18,7 @@
 #include "account.h"
 
 #include <QLoggingCategory>
+#include <QTimer>
 
 namespace OCC {
 
@@ -59,16 +60,26 @@ bool JobQueue::isBlocked() const
 
 bool JobQueue::retry(AbstractNetworkJob *job)
 {
-    if (!job->needsRetry()) {
+    if (job->aborted() || !job->needsRetry()) {
         return false;
     }
     if (_blocked) {
+        // waiting for the credentials, not caused by the server
         qCDebug(lcJobQUeue) << "Retry queued" << job;
         _jobs.push_back(job);
     } else {
-        qCDebug(lcJobQUeue) << "Direct retry" << job;
-        job->retry();
+        const QString host = job->url().host();
+        if (!_retryBudget.tryAcquire(host)) {
+            qCWarning(lcJobQUeue) << "Retry budget of" << host << "exhausted, not retrying" << job << "denied retries:" << _retryBudget.deniedRetries();
+            return false;
+        }
+        const auto delay = RetryBudget::backoff(job->retryCount());
+        qCDebug(lcJobQUeue) << "Direct retry" << job << "in" << delay.count() << "ms";
+        QTimer::singleShot(delay, job, [job] {
+            job->retry();
+        });
     }
+    ++_retries;
     return true;
 }
 
@@ -99,6 +110,11 @@ size_t JobQueue::size() const
     return _jobs.size();
 }
 
+RequestCoalescer *JobQueue::coalescer()
+{
+    return &_coalescer;
+}
+
 JobQueueGuard::JobQueueGuard(JobQueue *queue)
     : _queue(queue)
 {
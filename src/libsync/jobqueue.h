@@ -14,6 +14,8 @@
 #pragma once
 
 #include "owncloudlib.h"
+#include "requestcoalescer.h"
+#include "retrybudget.h"
 
 #include <QPointer>
 #include <vector>
@@ -37,6 +39,10 @@ public:
      * Retry a job if the job allows it,
      * if blocked the job will be queued untill we are unblocked
      * Returns whether the job will be retired
+     *
+     * Retries that don't wait for the queue to be unblocked are
+     * delayed with a jittered exponential backoff and limited by
+     * a retry budget per host.
      */
     bool retry(AbstractNetworkJob *job);
     /**
@@ -47,6 +53,16 @@ public:
 
     size_t size() const;
 
+    /**
+     * Shares the replies of identical requests of the account
+     */
+    RequestCoalescer *coalescer();
+
+    /** The number of retries, of retries refused by the retry budget and of coalesced requests */
+    qint64 retries() const { return _retries; }
+    qint64 deniedRetries() const { return _retryBudget.deniedRetries(); }
+    qint64 coalescedRequests() const { return _coalescer.coalescedRequests(); }
+
 private:
     void block();
     void unblock();
@@ -58,6 +74,9 @@ private:
     Account *_account;
     uint _blocked = 0;
     std::vector<QPointer<AbstractNetworkJob>> _jobs;
+    RetryBudget _retryBudget;
+    RequestCoalescer _coalescer;
+    qint64 _retries = 0;
 
     friend class JobQueueGuard;
 };
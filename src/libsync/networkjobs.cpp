@@ -42,6 +42,7 @@ namespace OCC {
 
 Q_LOGGING_CATEGORY(lcEtagJob, "sync.networkjob.etag", QtInfoMsg)
 Q_LOGGING_CATEGORY(lcPropfindJob, "sync.networkjob.propfind", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcSyncCollectionJob, "sync.networkjob.synccollection", QtInfoMsg)
 Q_LOGGING_CATEGORY(lcAvatarJob, "sync.networkjob.avatar", QtInfoMsg)
 Q_LOGGING_CATEGORY(lcMkColJob, "sync.networkjob.mkcol", QtInfoMsg)
 Q_LOGGING_CATEGORY(lcDetermineAuthTypeJob, "sync.networkjob.determineauthtype", QtInfoMsg)
@@ -127,6 +128,20 @@ static QString readContentsAsString(QXmlStreamReader &reader)
     return result;
 }
 
+// writes the <d:prop> element of a PROPFIND or REPORT request, see PropfindJob::setProperties()
+static void writeProperties(QTextStream &stream, const QList<QByteArray> &properties)
+{
+    stream << QByteArrayLiteral("<d:prop>");
+    for (const QByteArray &prop : properties) {
+        const int colIdx = prop.lastIndexOf(':');
+        if (colIdx >= 0) {
+            stream << QByteArrayLiteral("<") << prop.mid(colIdx + 1) << QByteArrayLiteral(" xmlns=\"") << prop.left(colIdx) << QByteArrayLiteral("\"/>");
+        } else {
+            stream << QByteArrayLiteral("<d:") << prop << QByteArrayLiteral("/>");
+        }
+    }
+    stream << QByteArrayLiteral("</d:prop>");
+}
 
 LsColXMLParser::LsColXMLParser()
 {
@@ -134,100 +149,173 @@ LsColXMLParser::LsColXMLParser()
 
 bool LsColXMLParser::parse(const QByteArray &xml, QHash<QString, qint64> *sizes, const QString &expectedPath)
 {
-    // Parse DAV response
-    QXmlStreamReader reader(xml);
-    reader.addExtraNamespaceDeclaration(QXmlStreamNamespaceDeclaration(QStringLiteral("d"), QStringLiteral("DAV:")));
+    begin(sizes, expectedPath);
+    return addData(xml) && finish();
+}
+
+void LsColXMLParser::begin(QHash<QString, qint64> *sizes, const QString &expectedPath)
+{
+    _reader.clear();
+    _reader.addExtraNamespaceDeclaration(QXmlStreamNamespaceDeclaration(QStringLiteral("d"), QStringLiteral("DAV:")));
+    _pending.clear();
+    _sizes = sizes;
+    _expectedPath = expectedPath;
+    _folders.clear();
+    _currentHref.clear();
+    _currentResponseStatus.clear();
+    _currentTmpProperties.clear();
+    _currentHttp200Properties.clear();
+    _syncToken.clear();
+    _currentPropsAreValid = false;
+    _insideResponse = false;
+    _insidePropstat = false;
+    _insideProp = false;
+    _insideMultiStatus = false;
+}
+
+// Returns the position after the last closing response tag in data or -1
+static int endOfLastResponse(const QByteArray &data)
+{
+    static const QByteArray tag = QByteArrayLiteral("response>");
+    int pos = data.lastIndexOf(tag);
+    while (pos > 0) {
+        // only accept "</response>" or "</prefix:response>", '<' is escaped in text
+        const int tagStart = data.lastIndexOf('<', pos);
+        if (tagStart >= 0 && tagStart + 1 < pos && data.at(tagStart + 1) == '/') {
+            const QByteArray prefix = data.mid(tagStart + 2, pos - tagStart - 2);
+            if (prefix.isEmpty() || (prefix.endsWith(':') && prefix.indexOf(':') == prefix.size() - 1 && !prefix.contains('>') && !prefix.contains(' '))) {
+                return pos + tag.size();
+            }
+        }
+        pos = data.lastIndexOf(tag, pos - 1);
+    }
+    return -1;
+}
 
-    QStringList folders;
-    QString currentHref;
-    QMap<QString, QString> currentTmpProperties;
-    QMap<QString, QString> currentHttp200Properties;
-    bool currentPropsAreValid = false;
-    bool insidePropstat = false;
-    bool insideProp = false;
-    bool insideMultiStatus = false;
+bool LsColXMLParser::addData(const QByteArray &data)
+{
+    _pending.append(data);
+    // The reader can't resume in the middle of an element's text, so only
+    // complete responses are handed over
+    const int end = endOfLastResponse(_pending);
+    if (end < 0) {
+        return true;
+    }
+    _reader.addData(_pending.left(end));
+    _pending.remove(0, end);
+    return parseAvailable();
+}
 
-    while (!reader.atEnd()) {
-        QXmlStreamReader::TokenType type = reader.readNext();
-        QString name = reader.name().toString();
+bool LsColXMLParser::finish()
+{
+    _reader.addData(_pending);
+    _pending.clear();
+    if (!parseAvailable()) {
+        return false;
+    }
+
+    if (_reader.hasError()) {
+        // XML Parser error? Whatever had been emitted before will come as directoryListingIterated
+        qCWarning(lcPropfindJob) << "ERROR" << _reader.errorString() << "at line" << _reader.lineNumber() << "column" << _reader.columnNumber();
+        return false;
+    } else if (!_insideMultiStatus) {
+        qCWarning(lcPropfindJob) << "ERROR no WebDAV response?";
+        return false;
+    } else {
+        emit directoryListingSubfolders(_folders);
+        emit finishedWithoutError();
+    }
+    return true;
+}
+
+bool LsColXMLParser::parseAvailable()
+{
+    while (!_reader.atEnd()) {
+        QXmlStreamReader::TokenType type = _reader.readNext();
+        QString name = _reader.name().toString();
         // Start elements with DAV:
-        if (type == QXmlStreamReader::StartElement && reader.namespaceUri() == QLatin1String("DAV:")) {
+        if (type == QXmlStreamReader::StartElement && _reader.namespaceUri() == QLatin1String("DAV:")) {
             if (name == QLatin1String("href")) {
                 // We don't use URL encoding in our request URL (which is the expected path) (QNAM will do it for us)
                 // but the result will have URL encoding..
-                QString hrefString = QString::fromUtf8(QByteArray::fromPercentEncoding(reader.readElementText().toUtf8()));
-                if (!hrefString.startsWith(expectedPath)) {
-                    qCWarning(lcPropfindJob) << "Invalid href" << hrefString << "expected starting with" << expectedPath;
+                QString hrefString = QString::fromUtf8(QByteArray::fromPercentEncoding(_reader.readElementText().toUtf8()));
+                if (!hrefString.startsWith(_expectedPath)) {
+                    qCWarning(lcPropfindJob) << "Invalid href" << hrefString << "expected starting with" << _expectedPath;
                     return false;
                 }
-                currentHref = hrefString;
+                _currentHref = hrefString;
             } else if (name == QLatin1String("response")) {
+                _insideResponse = true;
             } else if (name == QLatin1String("propstat")) {
-                insidePropstat = true;
-            } else if (name == QLatin1String("status") && insidePropstat) {
-                QString httpStatus = reader.readElementText();
+                _insidePropstat = true;
+            } else if (name == QLatin1String("status") && _insidePropstat) {
+                QString httpStatus = _reader.readElementText();
                 if (httpStatus.startsWith(QLatin1String("HTTP/1.1 200")) || httpStatus.startsWith(QLatin1String("HTTP/1.1 425"))) {
-                    currentPropsAreValid = true;
+                    _currentPropsAreValid = true;
                 } else {
-                    currentPropsAreValid = false;
+                    _currentPropsAreValid = false;
                 }
+            } else if (name == QLatin1String("status") && _insideResponse) {
+                // a status outside of a propstat describes the resource itself
+                _currentResponseStatus = _reader.readElementText();
+            } else if (name == QLatin1String("sync-token") && !_insideResponse) {
+                _syncToken = _reader.readElementText().toUtf8();
             } else if (name == QLatin1String("prop")) {
-                insideProp = true;
+                _insideProp = true;
                 continue;
             } else if (name == QLatin1String("multistatus")) {
-                insideMultiStatus = true;
+                _insideMultiStatus = true;
                 continue;
             }
         }
 
-        if (type == QXmlStreamReader::StartElement && insidePropstat && insideProp) {
+        if (type == QXmlStreamReader::StartElement && _insidePropstat && _insideProp) {
             // All those elements are properties
-            QString propertyContent = readContentsAsString(reader);
+            QString propertyContent = readContentsAsString(_reader);
             if (name == QLatin1String("resourcetype") && propertyContent.contains(QLatin1String("collection"))) {
-                folders.append(currentHref);
+                _folders.append(_currentHref);
             } else if (name == QLatin1String("size")) {
                 bool ok = false;
                 auto s = propertyContent.toLongLong(&ok);
-                if (ok && sizes) {
-                    sizes->insert(currentHref, s);
+                if (ok && _sizes) {
+                    _sizes->insert(_currentHref, s);
                 }
             }
-            currentTmpProperties.insert(reader.name().toString(), propertyContent);
+            _currentTmpProperties.insert(_reader.name().toString(), propertyContent);
         }
 
         // End elements with DAV:
         if (type == QXmlStreamReader::EndElement) {
-            if (reader.namespaceUri() == QLatin1String("DAV:")) {
-                if (reader.name() == QLatin1String("response")) {
-                    if (currentHref.endsWith(QLatin1Char('/'))) {
-                        currentHref.chop(1);
+            if (_reader.namespaceUri() == QLatin1String("DAV:")) {
+                if (_reader.name() == QLatin1String("response")) {
+                    _insideResponse = false;
+                    if (_currentHref.endsWith(QLatin1Char('/'))) {
+                        _currentHref.chop(1);
                     }
-                    emit directoryListingIterated(currentHref, currentHttp200Properties);
-                    currentHref.clear();
-                    currentHttp200Properties.clear();
-                } else if (reader.name() == QLatin1String("propstat")) {
-                    insidePropstat = false;
-                    if (currentPropsAreValid) {
-                        currentHttp200Properties = std::move(currentTmpProperties);
+                    if (!_currentResponseStatus.isEmpty()) {
+                        emit directoryListingStatus(_currentHref, _currentResponseStatus);
                     }
-                    currentPropsAreValid = false;
-                } else if (reader.name() == QLatin1String("prop")) {
-                    insideProp = false;
+                    emit directoryListingIterated(_currentHref, _currentHttp200Properties);
+                    _currentHref.clear();
+                    _currentResponseStatus.clear();
+                    _currentHttp200Properties.clear();
+                } else if (_reader.name() == QLatin1String("propstat")) {
+                    _insidePropstat = false;
+                    if (_currentPropsAreValid) {
+                        _currentHttp200Properties = std::move(_currentTmpProperties);
+                    }
+                    _currentPropsAreValid = false;
+                } else if (_reader.name() == QLatin1String("prop")) {
+                    _insideProp = false;
                 }
             }
         }
     }
 
-    if (reader.hasError()) {
-        // XML Parser error? Whatever had been emitted before will come as directoryListingIterated
-        qCWarning(lcPropfindJob) << "ERROR" << reader.errorString() << xml;
+    // Running out of data is expected until finish() is called
+    if (_reader.hasError() && _reader.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+        qCWarning(lcPropfindJob) << "ERROR" << _reader.errorString() << "at line" << _reader.lineNumber() << "column" << _reader.columnNumber();
         return false;
-    } else if (!insideMultiStatus) {
-        qCWarning(lcPropfindJob) << "ERROR no WebDAV response?" << xml;
-        return false;
-    } else {
-        emit directoryListingSubfolders(folders);
-        emit finishedWithoutError();
     }
     return true;
 }
@@ -268,19 +356,9 @@ void PropfindJob::start()
         QTextStream stream(&data, QIODevice::WriteOnly);
         stream.setCodec("UTF-8");
         stream << QByteArrayLiteral("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
-                                    "<d:propfind xmlns:d=\"DAV:\">"
-                                    "<d:prop>");
-
-        for (const QByteArray &prop : qAsConst(_properties)) {
-            const int colIdx = prop.lastIndexOf(':');
-            if (colIdx >= 0) {
-                stream << QByteArrayLiteral("<") << prop.mid(colIdx + 1) << QByteArrayLiteral(" xmlns=\"") << prop.left(colIdx) << QByteArrayLiteral("\"/>");
-            } else {
-                stream << QByteArrayLiteral("<d:") << prop << QByteArrayLiteral("/>");
-            }
-        }
-        stream << QByteArrayLiteral("</d:prop>"
-                                    "</d:propfind>\n");
+                                    "<d:propfind xmlns:d=\"DAV:\">");
+        writeProperties(stream, _properties);
+        stream << QByteArrayLiteral("</d:propfind>\n");
     }
 
     QBuffer *buf = new QBuffer(this);
@@ -290,42 +368,72 @@ void PropfindJob::start()
     AbstractNetworkJob::start();
 }
 
-// TODO: Instead of doing all in this slot, we should iteratively parse in readyRead(). This
-// would allow us to be more asynchronous in processing while data is coming from the network,
-// not all in one big blob at the end.
-void PropfindJob::finished()
+void PropfindJob::newReplyHook(QNetworkReply *reply)
 {
-    qCInfo(lcPropfindJob) << "LSCOL of" << reply()->request().url() << "FINISHED WITH STATUS"
-                          << replyStatusString();
+    // A retried request delivers a new document, the old parser would see it appended to a partial one
+    delete _parser;
+    _parseError = false;
+    _sizes.clear();
 
-    QString contentType = reply()->header(QNetworkRequest::ContentTypeHeader).toString();
-    int httpCode = reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    if (httpCode == 207 && contentType.contains(QLatin1String("application/xml; charset=utf-8"))) {
-        LsColXMLParser parser;
-        connect(&parser, &LsColXMLParser::directoryListingSubfolders,
+    // Parse while receiving, large listings are not kept in memory as a whole
+    connect(reply, &QNetworkReply::readyRead, this, [reply, this] {
+        if (reply == this->reply()) {
+            parseAvailableData();
+        }
+    });
+}
+
+void PropfindJob::parseAvailableData()
+{
+    if (_parseError) {
+        return;
+    }
+    if (!_parser) {
+        const QString contentType = reply()->header(QNetworkRequest::ContentTypeHeader).toString();
+        const int httpCode = reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (httpCode != 207 || !contentType.contains(QLatin1String("application/xml; charset=utf-8"))) {
+            // leave the data for error handling in finished()
+            return;
+        }
+        _parser = new LsColXMLParser;
+        _parser->setParent(this);
+        connect(_parser, &LsColXMLParser::directoryListingSubfolders,
             this, &PropfindJob::directoryListingSubfolders);
-        connect(&parser, &LsColXMLParser::directoryListingIterated,
+        connect(_parser, &LsColXMLParser::directoryListingIterated,
             this, &PropfindJob::directoryListingIterated);
-        connect(&parser, &LsColXMLParser::finishedWithError,
-            this, &PropfindJob::finishedWithError);
-        connect(&parser, &LsColXMLParser::finishedWithoutError,
-            this, &PropfindJob::finishedWithoutError);
         if (_depth == Depth::Zero) {
-            connect(&parser, &LsColXMLParser::directoryListingIterated, [&parser, counter = 0, this](const QString &name, const QMap<QString, QString> &) mutable {
+            connect(_parser, &LsColXMLParser::directoryListingIterated, this, [parser = _parser.data(), counter = 0, this](const QString &name, const QMap<QString, QString> &) mutable {
                 counter++;
                 // With a depths of 0 we must receive only one listing
                 if (OC_ENSURE(counter == 1)) {
-                    disconnect(&parser, &LsColXMLParser::directoryListingIterated, this, &PropfindJob::directoryListingIterated);
+                    disconnect(parser, &LsColXMLParser::directoryListingIterated, this, &PropfindJob::directoryListingIterated);
                 } else {
                     qCCritical(lcPropfindJob) << "Received superfluous directory listing for depth 0 propfind" << counter << "Path:" << name;
                 }
             });
         }
+        const QString expectedPath = reply()->request().url().path(); // something like "/owncloud/remote.php/webdav/folder"
+        _parser->begin(&_sizes, expectedPath);
+    }
+    if (!_parser->addData(reply()->readAll())) {
+        _parseError = true;
+    }
+}
+
+void PropfindJob::finished()
+{
+    qCInfo(lcPropfindJob) << "LSCOL of" << reply()->request().url() << "FINISHED WITH STATUS"
+                          << replyStatusString();
 
-        QString expectedPath = reply()->request().url().path(); // something like "/owncloud/remote.php/webdav/folder"
-        if (!parser.parse(reply()->readAll(), &_sizes, expectedPath)) {
+    QString contentType = reply()->header(QNetworkRequest::ContentTypeHeader).toString();
+    int httpCode = reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpCode == 207 && contentType.contains(QLatin1String("application/xml; charset=utf-8"))) {
+        parseAvailableData();
+        if (_parseError || !_parser->finish()) {
             // XML parse error
             emit finishedWithError(reply());
+        } else {
+            emit finishedWithoutError();
         }
     } else if (httpCode == 207) {
         // wrong content type
@@ -343,9 +451,109 @@ const QHash<QString, qint64> &PropfindJob::sizes() const
 
 /*********************************************************************************************/
 
+SyncCollectionJob::SyncCollectionJob(AccountPtr account, const QUrl &url, const QString &path, const QByteArray &syncToken, QObject *parent)
+    : AbstractNetworkJob(account, url, path, parent)
+    , _syncToken(syncToken)
+{
+}
+
+void SyncCollectionJob::setProperties(const QList<QByteArray> &properties)
+{
+    _properties = properties;
+}
+
+void SyncCollectionJob::start()
+{
+    QNetworkRequest req;
+    req.setRawHeader(QByteArrayLiteral("Content-Type"), QByteArrayLiteral("application/xml; charset=utf-8"));
+
+    QByteArray data;
+    {
+        QTextStream stream(&data, QIODevice::WriteOnly);
+        stream.setCodec("UTF-8");
+        stream << QByteArrayLiteral("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+                                    "<d:sync-collection xmlns:d=\"DAV:\">"
+                                    "<d:sync-token>")
+               << QString::fromUtf8(_syncToken).toHtmlEscaped()
+               << QByteArrayLiteral("</d:sync-token>"
+                                    "<d:sync-level>infinite</d:sync-level>");
+        writeProperties(stream, _properties);
+        stream << QByteArrayLiteral("</d:sync-collection>\n");
+    }
+
+    QBuffer *buf = new QBuffer(this);
+    buf->setData(data);
+    buf->open(QIODevice::ReadOnly);
+    sendRequest(QByteArrayLiteral("REPORT"), req, buf);
+    AbstractNetworkJob::start();
+}
+
+void SyncCollectionJob::finished()
+{
+    qCInfo(lcSyncCollectionJob) << "REPORT sync-collection of" << reply()->request().url() << "FINISHED WITH STATUS"
+                                << replyStatusString();
+
+    const QString contentType = reply()->header(QNetworkRequest::ContentTypeHeader).toString();
+    const int httpCode = reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpCode != 207 || !contentType.contains(QLatin1String("application/xml; charset=utf-8"))) {
+        // an unknown or expired sync token is reported as 403 with a DAV:valid-sync-token precondition
+        emit finishedWithError(reply());
+        return;
+    }
+
+    const QString expectedPath = reply()->request().url().path();
+    auto relativePath = [&expectedPath](const QString &href) {
+        auto path = href.mid(expectedPath.size());
+        while (path.startsWith(QLatin1Char('/'))) {
+            path.remove(0, 1);
+        }
+        return path;
+    };
+
+    // Any response we can't map to a change makes the delta unusable, the
+    // caller then lists the whole collection instead
+    bool incomplete = false;
+    LsColXMLParser parser;
+    connect(&parser, &LsColXMLParser::directoryListingStatus, this, [&](const QString &href, const QString &httpStatus) {
+        const QString path = relativePath(href);
+        if (httpStatus.startsWith(QLatin1String("HTTP/1.1 2"))) {
+            return;
+        } else if (path.isEmpty()) {
+            // a 507 for the collection itself means the server truncated the result (RFC 6578 3.6)
+            qCWarning(lcSyncCollectionJob) << "Incomplete result:" << httpStatus;
+            incomplete = true;
+        } else if (httpStatus.startsWith(QLatin1String("HTTP/1.1 404"))) {
+            emit itemRemoved(path);
+        } else {
+            qCWarning(lcSyncCollectionJob) << "Unexpected status" << httpStatus << "for" << path;
+            incomplete = true;
+        }
+    });
+    connect(&parser, &LsColXMLParser::directoryListingIterated, this, [&](const QString &href, const QMap<QString, QString> &properties) {
+        const QString path = relativePath(href);
+        // the collection itself is of no interest
+        if (!path.isEmpty() && !properties.isEmpty()) {
+            emit itemChanged(path, properties);
+        }
+    });
+
+    if (!parser.parse(reply()->readAll(), nullptr, expectedPath) || incomplete || parser.syncToken().isEmpty()) {
+        emit finishedWithError(reply());
+        return;
+    }
+    emit finishedWithoutError(parser.syncToken());
+}
+
+/*********************************************************************************************/
+
 AvatarJob::AvatarJob(AccountPtr account, const QString &userId, int size, QObject *parent)
-    : AbstractNetworkJob(account, account->url(), QStringLiteral("remote.php/dav/avatars/%1/%2.png").arg(userId, QString::number(size)), parent)
+    : AbstractNetworkJob(account, account->url(), avatarPath(userId, size), parent)
+{
+}
+
+QString AvatarJob::avatarPath(const QString &userId, int size)
 {
+    return QStringLiteral("remote.php/dav/avatars/%1/%2.png").arg(userId, QString::number(size));
 }
 
 void AvatarJob::start()
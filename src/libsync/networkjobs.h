@@ -20,6 +20,7 @@
 #include "common/result.h"
 #include <QJsonObject>
 #include <QUrlQuery>
+#include <QXmlStreamReader>
 #include <functional>
 
 class QUrl;
@@ -65,11 +66,52 @@ public:
 
     bool parse(const QByteArray &xml, QHash<QString, qint64> *sizes, const QString &expectedPath);
 
+    /** Parse a document while it is received
+     *
+     * Call begin() once, pass the data to addData() as it arrives and call
+     * finish() at the end. Entries are emitted as soon as they are complete,
+     * so the document never has to be held in memory as a whole.
+     *
+     * addData() and finish() return false on errors.
+     */
+    void begin(QHash<QString, qint64> *sizes, const QString &expectedPath);
+    bool addData(const QByteArray &data);
+    bool finish();
+
+    /** The DAV:sync-token of a sync-collection report, empty for other documents */
+    const QByteArray &syncToken() const { return _syncToken; }
+
 signals:
     void directoryListingSubfolders(const QStringList &items);
     void directoryListingIterated(const QString &name, const QMap<QString, QString> &properties);
+    /** A response carried a status for the resource itself instead of propstats
+     *
+     * Emitted before directoryListingIterated() for the same response.
+     */
+    void directoryListingStatus(const QString &name, const QString &httpStatus);
     void finishedWithError(QNetworkReply *reply);
     void finishedWithoutError();
+
+private:
+    bool parseAvailable();
+
+    QXmlStreamReader _reader;
+    // received data that doesn't end with a complete response yet
+    QByteArray _pending;
+    QHash<QString, qint64> *_sizes = nullptr;
+    QString _expectedPath;
+
+    QStringList _folders;
+    QString _currentHref;
+    QString _currentResponseStatus;
+    QMap<QString, QString> _currentTmpProperties;
+    QMap<QString, QString> _currentHttp200Properties;
+    QByteArray _syncToken;
+    bool _currentPropsAreValid = false;
+    bool _insideResponse = false;
+    bool _insidePropstat = false;
+    bool _insideProp = false;
+    bool _insideMultiStatus = false;
 };
 
 class OWNCLOUDSYNC_EXPORT PropfindJob : public AbstractNetworkJob
@@ -103,16 +145,68 @@ signals:
     void finishedWithError(QNetworkReply *reply);
     void finishedWithoutError();
 
+protected:
+    void newReplyHook(QNetworkReply *reply) override;
+
 private slots:
     void finished() override;
 
 private:
+    /// Parses the data that arrived so far, the parser is created for 207 replies only
+    void parseAvailableData();
+
     QList<QByteArray> _properties;
     QHash<QString, qint64> _sizes;
     Depth _depth;
+    QPointer<LsColXMLParser> _parser;
+    bool _parseError = false;
 };
 
 
+/**
+ * @brief Asks the server for the changes below a collection since a sync token
+ *
+ * Runs a REPORT with a DAV:sync-collection request (RFC 6578) of infinite
+ * depth. New and changed entries are reported through itemChanged(),
+ * removed entries through itemRemoved(). The paths are relative to the
+ * requested collection and never start or end with a slash.
+ *
+ * The server replies with an error if it doesn't know the sync token
+ * anymore, in that case the whole collection needs to be listed. The same
+ * applies to truncated results (507) and to entries with a status other
+ * than 404, finishedWithError() is emitted for those.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT SyncCollectionJob : public AbstractNetworkJob
+{
+    Q_OBJECT
+public:
+    explicit SyncCollectionJob(AccountPtr account, const QUrl &url, const QString &path, const QByteArray &syncToken, QObject *parent = nullptr);
+    void start() override;
+
+    /**
+     * The properties to retrieve for changed entries.
+     *
+     * Same format as PropfindJob::setProperties()
+     */
+    void setProperties(const QList<QByteArray> &properties);
+
+signals:
+    void itemChanged(const QString &relativePath, const QMap<QString, QString> &properties);
+    void itemRemoved(const QString &relativePath);
+    /** newSyncToken identifies the state of the collection the reply describes */
+    void finishedWithoutError(const QByteArray &newSyncToken);
+    void finishedWithError(QNetworkReply *reply);
+
+private slots:
+    void finished() override;
+
+private:
+    QList<QByteArray> _properties;
+    QByteArray _syncToken;
+};
+
 /**
  * @brief Retrieves the account users avatar from the server using a GET request.
  *
@@ -135,6 +229,9 @@ public:
     /** The retrieved avatar images don't have the circle shape by default */
     static QPixmap makeCircularAvatar(const QPixmap &baseAvatar);
 
+    /** The path of the avatar relative to the account url */
+    static QString avatarPath(const QString &userId, int size);
+
 signals:
     /**
      * @brief avatarPixmap - returns either a valid pixmap or not.
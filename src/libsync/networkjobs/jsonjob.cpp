@@ -35,6 +35,8 @@ void JsonJob::finished()
 
     if (reply()->error() != QNetworkReply::NoError) {
         qCWarning(lcJsonApiJob) << "Network error: " << this << errorString();
+    } else if (httpStatusCode() == 304) {
+        // the response to a conditional request, the caller still has the data
     } else {
         parse(reply()->readAll());
     }
@@ -24,10 +24,12 @@
 #include "propagatedownload.h"
 #include "propagateremotedelete.h"
 #include "propagateremotemkdir.h"
+#include "propagateremotecopy.h"
 #include "propagateremotemove.h"
 #include "propagateupload.h"
 #include "propagateuploadtus.h"
 #include "propagatorjobs.h"
+#include "transferbudget.h"
 
 #ifdef Q_OS_WIN
 #include <winbase.h>
@@ -44,6 +46,8 @@
 #include <QTimerEvent>
 #include <qmath.h>
 
+#include <algorithm>
+
 using namespace std::chrono_literals;
 
 namespace OCC {
@@ -79,6 +83,9 @@ qint64 freeSpaceLimit()
 
 OwncloudPropagator::~OwncloudPropagator()
 {
+    if (_syncOptions._transferBudget) {
+        _syncOptions._transferBudget->unregisterPropagator(this);
+    }
 }
 
 
@@ -339,6 +346,9 @@ PropagateItemJob *OwncloudPropagator::createJob(const SyncFileItemPtr &item)
             job->setDeleteExistingFolder(deleteExisting);
             return job;
         } else {
+            if (!item->_copySource.isEmpty()) {
+                return new PropagateRemoteCopy(this, item);
+            }
             PropagateUploadFileCommon *job = nullptr;
             if (account()->capabilities().tusSupport().isValid()) {
                 job = new PropagateUploadFileTUS(this, item);
@@ -389,7 +399,12 @@ void OwncloudPropagator::start(SyncFileItemSet &&items)
     /* This builds all the jobs needed for the propagation.
      * Each directory is a PropagateDirectory job, which contains the files in it.
      * In order to do that we loop over the items. (which are sorted by destination)
-     * When we enter a directory, we can create the directory job and push it on the stack. */
+     * When we enter a directory, we can create the directory job and push it on the stack.
+     * The contents of a directory directly follow it, which keeps this linear. */
+
+    if (_syncOptions._transferBudget) {
+        _syncOptions._transferBudget->registerPropagator(this, _syncOptions._transferWeight);
+    }
 
     _rootJob.reset(new PropagateRootDirectory(this));
     QStack<QPair<QString /* directory name */, PropagateDirectory * /* job */>> directories;
@@ -397,7 +412,8 @@ void OwncloudPropagator::start(SyncFileItemSet &&items)
     QVector<PropagatorJob *> directoriesToRemove;
     QString removedDirectory;
     QString maybeConflictDirectory;
-    for (const auto &item : qAsConst(items)) {
+    for (auto it = items.cbegin(); it != items.cend(); ++it) {
+        const auto &item = *it;
         if (!removedDirectory.isEmpty() && item->_file.startsWith(removedDirectory)) {
             // this is an item in a directory which is going to be removed.
             PropagateDirectory *delDirJob = qobject_cast<PropagateDirectory *>(directoriesToRemove.first());
@@ -458,11 +474,11 @@ void OwncloudPropagator::start(SyncFileItemSet &&items)
                 // checkForPermissions() has already run and used the permissions
                 // of the file we're about to delete to decide whether uploading
                 // to the new dir is ok...
-                for (const auto &item2 : qAsConst(items)) {
-                    if (item2->destination().startsWith(item->destination() + QLatin1Char('/'))) {
-                        item2->_instruction = CSYNC_INSTRUCTION_NONE;
-                        _anotherSyncNeeded = true;
-                    }
+                // The items in the new folder are the ones directly following it.
+                const QString prefix = item->destination() + QLatin1Char('/');
+                for (auto subIt = std::next(it); subIt != items.cend() && (*subIt)->destination().startsWith(prefix); ++subIt) {
+                    (*subIt)->_instruction = CSYNC_INSTRUCTION_NONE;
+                    _anotherSyncNeeded = true;
                 }
             }
 
@@ -618,21 +634,25 @@ void OwncloudPropagator::scheduleNextJobImpl()
 
     _jobScheduled = false;
 
+    if (const auto &budget = _syncOptions._transferBudget) {
+        // a job of ours might have freed a slot other syncs are waiting for
+        budget->wakeWaiting();
+        if (!budget->tryAcquire(this)) {
+            return;
+        }
+    }
+
     if (_activeJobList.count() < maximumActiveTransferJob()) {
         if (_rootJob->scheduleSelfOrChild()) {
             scheduleNextJob();
         }
     } else if (_activeJobList.count() < hardMaximumActiveJob()) {
-        int likelyFinishedQuicklyCount = 0;
-        // NOTE: Only counts the first 3 jobs! Then for each
-        // one that is likely finished quickly, we can launch another one.
-        // When a job finishes another one will "move up" to be one of the first 3 and then
-        // be counted too.
-        for (int i = 0; i < maximumActiveTransferJob() && i < _activeJobList.count(); i++) {
-            if (_activeJobList.at(i)->isLikelyFinishedQuickly()) {
-                likelyFinishedQuicklyCount++;
-            }
-        }
+        // Jobs that are likely finished quickly, like deletes, moves or small transfers,
+        // don't count against the transfer limit. The server has no bulk endpoint for
+        // deletes and moves, so they are pipelined up to the hard limit instead.
+        const auto likelyFinishedQuicklyCount = std::count_if(_activeJobList.cbegin(), _activeJobList.cend(), [](PropagateItemJob *job) {
+            return job->isLikelyFinishedQuickly();
+        });
         if (_activeJobList.count() < maximumActiveTransferJob() + likelyFinishedQuicklyCount) {
             qCDebug(lcPropagator) << "Can pump in another request! activeJobs =" << _activeJobList.count();
             if (_rootJob->scheduleSelfOrChild()) {
@@ -17,6 +17,7 @@
 #include <QObject>
 #include <QMetaType>
 #include <QCoreApplication>
+#include <QFileInfo>
 
 namespace OCC {
 
@@ -414,4 +415,195 @@ void ProgressInfo::Progress::setCompleted(qint64 completed)
     _completed = qMin(completed, _total);
     _prevCompleted = qMin(_prevCompleted, _completed);
 }
+
+class ProgressSnapshotData : public QSharedData
+{
+public:
+    quint64 version = 0;
+    ProgressInfo::Status status = ProgressInfo::None;
+    QString currentDiscoveredRemoteFolder;
+    QString currentDiscoveredLocalFolder;
+    qint64 totalFiles = 0;
+    qint64 completedFiles = 0;
+    qint64 currentFile = 0;
+    qint64 totalSize = 0;
+    qint64 completedSize = 0;
+    bool trustEta = false;
+    quint64 estimatedEta = 0;
+    quint64 estimatedUploadBandwidth = 0;
+    quint64 estimatedDownloadBandwidth = 0;
+    ProgressSnapshot::Item currentItem;
+    QStringList currentFileNames;
+};
+
+ProgressSnapshot::ProgressSnapshot()
+    : d(new ProgressSnapshotData)
+{
+}
+
+ProgressSnapshot::~ProgressSnapshot() = default;
+ProgressSnapshot::ProgressSnapshot(const ProgressSnapshot &other) = default;
+ProgressSnapshot &ProgressSnapshot::operator=(const ProgressSnapshot &other) = default;
+
+ProgressSnapshot ProgressSnapshot::fromProgressInfo(const ProgressInfo &progress, quint64 version)
+{
+    ProgressSnapshot out;
+    auto *data = out.d.data();
+    data->version = version;
+    data->status = progress.status();
+    data->currentDiscoveredRemoteFolder = progress._currentDiscoveredRemoteFolder;
+    data->currentDiscoveredLocalFolder = progress._currentDiscoveredLocalFolder;
+    data->totalFiles = progress.totalFiles();
+    data->completedFiles = progress.completedFiles();
+    data->currentFile = progress.currentFile();
+    data->totalSize = progress.totalSize();
+    data->completedSize = progress.completedSize();
+    if (progress.status() != ProgressInfo::Propagation && progress.status() != ProgressInfo::Done) {
+        return out;
+    }
+    data->trustEta = progress.trustEta();
+    data->estimatedEta = progress.totalProgress().estimatedEta;
+
+    // find the single item to display:  This is going to be the bigger item, or the last completed
+    // item if no items are in progress.
+    const SyncFileItem *curItem = &progress._lastCompletedItem;
+    qint64 curItemProgress = -1; // -1 means finished
+    qint64 biggerItemSize = 0;
+    for (const auto &citm : progress._currentItems) {
+        if (curItemProgress == -1 || (ProgressInfo::isSizeDependent(citm._item) && biggerItemSize < citm._item._size)) {
+            curItemProgress = citm._progress.completed();
+            curItem = &citm._item;
+            biggerItemSize = citm._item._size;
+        }
+        const auto bandwidth = citm._progress.estimates().estimatedBandwidth;
+        if (citm._item._direction != SyncFileItem::Up) {
+            data->estimatedDownloadBandwidth += bandwidth;
+        } else {
+            data->estimatedUploadBandwidth += bandwidth;
+        }
+        if (data->currentFileNames.size() < maxCurrentFileNames) {
+            data->currentFileNames.append(QFileInfo(citm._item._file).fileName());
+        }
+    }
+    if (curItemProgress == -1) {
+        curItemProgress = curItem->_size;
+    }
+    data->currentItem.file = curItem->_file;
+    data->currentItem.actionString = Progress::asActionString(*curItem);
+    data->currentItem.size = curItem->_size;
+    data->currentItem.completed = curItemProgress;
+    data->currentItem.isSizeDependent = ProgressInfo::isSizeDependent(*curItem);
+    return out;
+}
+
+quint64 ProgressSnapshot::version() const
+{
+    return d->version;
+}
+
+ProgressInfo::Status ProgressSnapshot::status() const
+{
+    return d->status;
+}
+
+QString ProgressSnapshot::currentDiscoveredRemoteFolder() const
+{
+    return d->currentDiscoveredRemoteFolder;
+}
+
+QString ProgressSnapshot::currentDiscoveredLocalFolder() const
+{
+    return d->currentDiscoveredLocalFolder;
+}
+
+qint64 ProgressSnapshot::totalFiles() const
+{
+    return d->totalFiles;
+}
+
+qint64 ProgressSnapshot::completedFiles() const
+{
+    return d->completedFiles;
+}
+
+qint64 ProgressSnapshot::currentFile() const
+{
+    return d->currentFile;
+}
+
+qint64 ProgressSnapshot::totalSize() const
+{
+    return d->totalSize;
+}
+
+qint64 ProgressSnapshot::completedSize() const
+{
+    return d->completedSize;
+}
+
+bool ProgressSnapshot::trustEta() const
+{
+    return d->trustEta;
+}
+
+quint64 ProgressSnapshot::estimatedEta() const
+{
+    return d->estimatedEta;
+}
+
+quint64 ProgressSnapshot::estimatedUploadBandwidth() const
+{
+    return d->estimatedUploadBandwidth;
+}
+
+quint64 ProgressSnapshot::estimatedDownloadBandwidth() const
+{
+    return d->estimatedDownloadBandwidth;
+}
+
+const ProgressSnapshot::Item &ProgressSnapshot::currentItem() const
+{
+    return d->currentItem;
+}
+
+const QStringList &ProgressSnapshot::currentFileNames() const
+{
+    return d->currentFileNames;
+}
+
+ProgressAggregator::ProgressAggregator(QObject *parent)
+    : QObject(parent)
+{
+    _publishTimer.setSingleShot(true);
+    _publishTimer.setInterval(publishInterval);
+    connect(&_publishTimer, &QTimer::timeout, this, &ProgressAggregator::publish);
+}
+
+ProgressSnapshot ProgressAggregator::snapshot() const
+{
+    return _snapshot;
+}
+
+void ProgressAggregator::updateProgress(const ProgressInfo &progress)
+{
+    ++_receivedUpdates;
+    _pending = &progress;
+    if (progress.status() != _snapshot.status()) {
+        // the listeners rely on seeing each status change
+        publish();
+    } else if (!_publishTimer.isActive()) {
+        _publishTimer.start();
+    }
+}
+
+void ProgressAggregator::publish()
+{
+    _publishTimer.stop();
+    if (!_pending) {
+        return;
+    }
+    _snapshot = ProgressSnapshot::fromProgressInfo(*_pending, _snapshot.version() + 1);
+    _pending = nullptr;
+    Q_EMIT snapshotPublished(_snapshot);
+}
 }
@@ -21,8 +21,11 @@
 #include <QTime>
 #include <QQueue>
 #include <QElapsedTimer>
+#include <QSharedDataPointer>
 #include <QTimer>
 
+#include <chrono>
+
 #include "syncfileitem.h"
 
 #include "csync/csync_exclude.h"
@@ -259,6 +262,76 @@ private:
     double _maxBytesPerSecond;
 };
 
+class ProgressSnapshotData;
+
+/**
+ * @brief A compact, immutable summary of a ProgressInfo
+ *
+ * Unlike ProgressInfo it does not reference any SyncFileItem, the values
+ * needed for display are computed once when the snapshot is taken.
+ * Copies share the data, passing snapshots around is cheap.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT ProgressSnapshot
+{
+public:
+    /**
+     * The item that should be displayed: the biggest item in progress
+     * or the last completed item if none is in progress.
+     */
+    struct Item
+    {
+        QString file;
+        QString actionString;
+        qint64 size = 0;
+        qint64 completed = 0;
+        bool isSizeDependent = false;
+    };
+
+    ProgressSnapshot();
+    ~ProgressSnapshot();
+    ProgressSnapshot(const ProgressSnapshot &other);
+    ProgressSnapshot &operator=(const ProgressSnapshot &other);
+
+    static ProgressSnapshot fromProgressInfo(const ProgressInfo &progress, quint64 version);
+
+    /**
+     * Increases with every published snapshot of a sync engine
+     */
+    quint64 version() const;
+
+    ProgressInfo::Status status() const;
+
+    QString currentDiscoveredRemoteFolder() const;
+    QString currentDiscoveredLocalFolder() const;
+
+    qint64 totalFiles() const;
+    qint64 completedFiles() const;
+    qint64 currentFile() const;
+    qint64 totalSize() const;
+    qint64 completedSize() const;
+
+    /// see ProgressInfo::trustEta()
+    bool trustEta() const;
+    /// Estimated time remaining in milliseconds
+    quint64 estimatedEta() const;
+
+    quint64 estimatedUploadBandwidth() const;
+    quint64 estimatedDownloadBandwidth() const;
+
+    const Item &currentItem() const;
+
+    /**
+     * The names of the files in progress, at most maxCurrentFileNames
+     */
+    const QStringList &currentFileNames() const;
+    static constexpr int maxCurrentFileNames = 10;
+
+private:
+    QSharedDataPointer<ProgressSnapshotData> d;
+};
+
 namespace Progress {
 
     OWNCLOUDSYNC_EXPORT QString asActionString(const SyncFileItem &item);
@@ -299,10 +372,10 @@ signals:
       @brief Signals the progress of data transmission.
 
       @param[out]  folder The folder which is being processed
-      @param[out]  progress   A struct with all progress info.
+      @param[out]  progress   A rate limited snapshot of the progress info.
 
      */
-    void progressInfo(Folder *folder, const ProgressInfo &progress);
+    void progressInfo(Folder *folder, const ProgressSnapshot &progress);
     /**
      * @brief: the item was completed by a job
      */
@@ -327,5 +400,51 @@ private:
     QElapsedTimer _timer;
     static ProgressDispatcher *_instance;
 };
+
+/**
+ * @brief Rate limits the progress of a sync engine
+ *
+ * The sync engine reports progress for each step of each item,
+ * with many small files this happens thousands of times per second.
+ * The aggregator only takes a ProgressSnapshot at most every publishInterval,
+ * changes of the status are published immediately.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT ProgressAggregator : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr std::chrono::milliseconds publishInterval { 100 };
+
+    explicit ProgressAggregator(QObject *parent = nullptr);
+
+    /**
+     * The last published snapshot
+     */
+    ProgressSnapshot snapshot() const;
+
+    quint64 receivedUpdates() const { return _receivedUpdates; }
+
+public Q_SLOTS:
+    /**
+     * The referenced progress must stay valid until the next call, or until
+     * a status change was published.
+     */
+    void updateProgress(const ProgressInfo &progress);
+
+Q_SIGNALS:
+    void snapshotPublished(const ProgressSnapshot &snapshot);
+
+private:
+    void publish();
+
+    QTimer _publishTimer;
+    const ProgressInfo *_pending = nullptr;
+    ProgressSnapshot _snapshot;
+    quint64 _receivedUpdates = 0;
+};
 }
+Q_DECLARE_METATYPE(OCC::ProgressSnapshot)
+
 #endif // PROGRESSDISPATCHER_H
@@ -93,6 +93,8 @@ GETFileJob::GETFileJob(AccountPtr account, const QUrl &url, const QString &path,
 
     // Long downloads must not block non-propagation jobs.
     setPriority(QNetworkRequest::LowPriority);
+    // The data is streamed to the device with a limited read buffer
+    setAllowCoalescing(false);
 }
 
 void GETFileJob::start()
@@ -502,7 +504,10 @@ void PropagateDownloadFile::startDownload()
     FileSystem::setFileHidden(_tmpFile.fileName(), true);
 
     // If there's not enough space to fully download this file, stop.
-    const auto diskSpaceResult = propagator()->diskSpaceCheck();
+    auto diskSpaceResult = propagator()->diskSpaceCheck();
+    if (diskSpaceResult == OwncloudPropagator::DiskSpaceOk && !preallocate()) {
+        diskSpaceResult = OwncloudPropagator::DiskSpaceFailure;
+    }
     if (diskSpaceResult != OwncloudPropagator::DiskSpaceOk) {
         if (diskSpaceResult == OwncloudPropagator::DiskSpaceFailure) {
             // Using DetailError here will make the error not pop up in the account
@@ -567,9 +572,35 @@ void PropagateDownloadFile::startFullDownload()
     _job->start();
 }
 
+bool PropagateDownloadFile::preallocate()
+{
+    const qint64 remaining = _item->_size - _resumeStart;
+    switch (FileSystem::preallocate(_tmpFile, _resumeStart, remaining)) {
+    case FileSystem::PreallocateResult::Ok:
+        _preallocated = true;
+        return true;
+    case FileSystem::PreallocateResult::NoSpace:
+        qCWarning(lcPropagateDownload) << "Not enough disk space to preallocate" << remaining << "bytes for" << _tmpFile.fileName();
+        return false;
+    case FileSystem::PreallocateResult::Unsupported:
+        // the space is only accounted for in committedDiskSpace()
+        return true;
+    }
+    Q_UNREACHABLE();
+}
+
+void PropagateDownloadFile::releasePreallocation()
+{
+    if (_preallocated) {
+        _tmpFile.resize(_tmpFile.size());
+        _preallocated = false;
+    }
+}
+
 qint64 PropagateDownloadFile::committedDiskSpace() const
 {
-    if (_state == Running) {
+    // preallocated space is no longer part of the free disk space
+    if (_state == Running && !_preallocated) {
         return qBound(0LL, _item->_size - _resumeStart - _downloadProgress, _item->_size);
     }
     return 0;
@@ -594,6 +625,8 @@ void PropagateDownloadFile::slotGetFinished()
 
     QNetworkReply::NetworkError err = job->reply()->error();
     if (err != QNetworkReply::NoError) {
+        // a partial tmp file is kept for resuming, it must not hold on to the reserved space
+        releasePreallocation();
 
         // If we sent a 'Range' header and get 416 back, we want to retry
         // without the header.
@@ -671,6 +704,8 @@ void PropagateDownloadFile::slotGetFinished()
         _item->_modtime = job->lastModified();
     }
 
+    // release the space we reserved beyond the received data
+    releasePreallocation();
     _tmpFile.close();
     _tmpFile.flush();
 
@@ -154,7 +154,11 @@ public:
     qint64 committedDiskSpace() const override;
 
     // We think it might finish quickly because it is a small file.
-    bool isLikelyFinishedQuickly() override { return _item->_size < propagator()->smallFileSize(); }
+    bool isLikelyFinishedQuickly() override
+    {
+        // dehydrations don't transfer anything
+        return _item->_type == ItemTypeVirtualFileDehydration || _item->_size < propagator()->smallFileSize();
+    }
 
     /**
      * Whether an existing folder with the same name may be deleted before
@@ -190,12 +194,18 @@ private slots:
 
 private:
     void deleteExistingFolder();
+    /// Reserves the disk space of the rest of the download, returns false if there isn't enough
+    bool preallocate();
+    /// Frees the reserved space beyond the received data, the tmp file keeps its size
+    void releasePreallocation();
 
     qint64 _resumeStart;
     qint64 _downloadProgress;
     QPointer<GETFileJob> _job;
     QFile _tmpFile;
     bool _deleteExisting;
+    /// The disk space of the rest of the download is reserved
+    bool _preallocated = false;
     ConflictRecord _conflictRecord;
 
     QElapsedTimer _stopwatch;
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "propagateremotecopy.h"
+#include "owncloudpropagator_p.h"
+#include "account.h"
+#include "common/asserts.h"
+#include "common/syncjournaldb.h"
+#include <QDir>
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcCopyJob, "sync.networkjob.copy", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcPropagateRemoteCopy, "sync.propagator.remotecopy", QtInfoMsg)
+
+CopyJob::CopyJob(AccountPtr account, const QUrl &url, const QString &path, const QString &destination,
+    const QString &etag, QObject *parent)
+    : AbstractNetworkJob(account, url, path, parent)
+    , _destination(destination)
+    , _etag(etag)
+{
+}
+
+void CopyJob::start()
+{
+    QNetworkRequest req;
+    req.setRawHeader("Destination", QUrl::toPercentEncoding(_destination, "/"));
+    // never replace a file that appeared on the server in the meantime
+    req.setRawHeader("Overwrite", "F");
+    if (!_etag.isEmpty()) {
+        req.setRawHeader("If-Match", QStringLiteral("\"%1\"").arg(_etag).toUtf8());
+    }
+    sendRequest("COPY", req);
+    AbstractNetworkJob::start();
+}
+
+void CopyJob::finished()
+{
+    qCInfo(lcCopyJob) << "COPY of" << reply()->request().url() << "FINISHED WITH STATUS"
+                      << replyStatusString();
+}
+
+void PropagateRemoteCopy::start()
+{
+    if (propagator()->_abortRequested)
+        return;
+
+    const QString remoteSource = propagator()->fullRemotePath(propagator()->adjustRenamedPath(_item->_copySource));
+    const QString remoteDestination = QDir::cleanPath(propagator()->webDavUrl().path() + propagator()->fullRemotePath(_item->_file));
+    qCDebug(lcPropagateRemoteCopy) << remoteSource << remoteDestination;
+
+    _job = new CopyJob(propagator()->account(), propagator()->webDavUrl(), remoteSource, remoteDestination, _item->_copySourceEtag, this);
+    connect(_job.data(), &CopyJob::finishedSignal, this, &PropagateRemoteCopy::slotCopyJobFinished);
+    propagator()->_activeJobList.append(this);
+    _job->start();
+}
+
+void PropagateRemoteCopy::abort(PropagatorJob::AbortType abortType)
+{
+    if (_uploadJob) {
+        _uploadJob->abort(abortType);
+        return;
+    }
+    if (_job) {
+        _job->abort();
+    }
+    if (abortType == AbortType::Asynchronous) {
+        emit abortFinished();
+    }
+}
+
+void PropagateRemoteCopy::slotCopyJobFinished()
+{
+    propagator()->_activeJobList.removeOne(this);
+
+    OC_ASSERT(_job);
+
+    QNetworkReply::NetworkError err = _job->reply()->error();
+    _item->_httpErrorCode = _job->reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    _item->_responseTimeStamp = _job->responseTimestamp();
+    _item->_requestId = _job->requestId();
+
+    if (err == QNetworkReply::OperationCanceledError && propagator()->_abortRequested) {
+        done(SyncFileItem::SoftError, _job->errorString());
+        return;
+    }
+    if (err != QNetworkReply::NoError || _item->_httpErrorCode != 201) {
+        uploadInstead(_job->errorString());
+        return;
+    }
+
+    // the copy has a new file id, etag and maybe other permissions
+    auto *propfind = new PropfindJob(propagator()->account(), propagator()->webDavUrl(), propagator()->fullRemotePath(_item->_file), PropfindJob::Depth::Zero, this);
+    propfind->setProperties({ "getetag", "http://owncloud.org/ns:id", "http://owncloud.org/ns:permissions" });
+    connect(propfind, &PropfindJob::directoryListingIterated, this, [this](const QString &, const QMap<QString, QString> &map) {
+        _item->_etag = Utility::normalizeEtag(map.value(QStringLiteral("getetag")));
+        _item->_fileId = map.value(QStringLiteral("id")).toUtf8();
+        _item->_remotePerm = RemotePermissions::fromServerString(map.value(QStringLiteral("permissions")));
+    });
+    connect(propfind, &PropfindJob::finishedWithoutError, this, [this] {
+        propagator()->_activeJobList.removeOne(this);
+        if (_item->_etag.isEmpty()) {
+            uploadInstead(tr("Missing ETag from server"));
+            return;
+        }
+        finalize();
+    });
+    connect(propfind, &PropfindJob::finishedWithError, this, [this](QNetworkReply *reply) {
+        propagator()->_activeJobList.removeOne(this);
+        uploadInstead(reply->errorString());
+    });
+    _job = propfind;
+    propagator()->_activeJobList.append(this);
+    propfind->start();
+}
+
+void PropagateRemoteCopy::uploadInstead(const QString &reason)
+{
+    qCInfo(lcPropagateRemoteCopy) << "Failed to copy" << _item->_copySource << "to" << _item->_file << reason << "uploading it instead";
+    _item->_copySource.clear();
+    _item->_copySourceEtag.clear();
+    _item->_checksumHeader.clear();
+    _item->_etag.clear();
+    _item->_fileId.clear();
+    _item->_remotePerm = {};
+    _item->_httpErrorCode = 0;
+
+    _uploadJob = propagator()->createJob(_item);
+    // the upload completes the item
+    connect(_uploadJob.data(), &PropagatorJob::finished, this, [this](SyncFileItem::Status status) {
+        _state = Finished;
+        emit finished(status);
+    });
+    connect(_uploadJob.data(), &PropagatorJob::abortFinished, this, &PropagatorJob::abortFinished);
+    _uploadJob->scheduleSelfOrChild();
+}
+
+void PropagateRemoteCopy::finalize()
+{
+    const auto result = propagator()->updateMetadata(*_item);
+    if (!result) {
+        done(SyncFileItem::FatalError, tr("Error updating metadata: %1").arg(result.error()));
+        return;
+    } else if (result.get() == Vfs::ConvertToPlaceholderResult::Locked) {
+        done(SyncFileItem::SoftError, tr("The file %1 is currently in use").arg(_item->_file));
+        return;
+    }
+
+    // Files that were new on the remote shouldn't have online-only pin state
+    // even if their parent folder is online-only.
+    auto &vfs = propagator()->syncOptions()._vfs;
+    const auto pin = vfs->pinState(_item->_file);
+    if (pin && *pin == PinState::OnlineOnly) {
+        vfs->setPinState(_item->_file, PinState::Unspecified);
+    }
+
+    propagator()->_journal->commit(QStringLiteral("Remote Copy"));
+    done(SyncFileItem::Success);
+}
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "owncloudpropagator.h"
+#include "networkjobs.h"
+
+namespace OCC {
+
+/**
+ * @brief Copies a file on the server
+ * @ingroup libsync
+ *
+ * The copy fails with 412 if the source no longer has the given etag.
+ */
+class CopyJob : public AbstractNetworkJob
+{
+    Q_OBJECT
+    const QString _destination;
+    const QString _etag;
+
+public:
+    explicit CopyJob(AccountPtr account, const QUrl &url, const QString &path, const QString &destination,
+        const QString &etag, QObject *parent = nullptr);
+
+    void start() override;
+    void finished() override;
+};
+
+/**
+ * @brief Propagates a new local file by copying a file with the same content on the server
+ * @ingroup libsync
+ *
+ * The copy source is detected by the discovery, see SyncFileItem::_copySource.
+ * If the copy fails the file is uploaded instead.
+ */
+class PropagateRemoteCopy : public PropagateItemJob
+{
+    Q_OBJECT
+    QPointer<AbstractNetworkJob> _job;
+    QPointer<PropagateItemJob> _uploadJob;
+
+public:
+    PropagateRemoteCopy(OwncloudPropagator *propagator, const SyncFileItemPtr &item)
+        : PropagateItemJob(propagator, item)
+    {
+    }
+    void start() override;
+    void abort(PropagatorJob::AbortType abortType) override;
+    bool isLikelyFinishedQuickly() override { return !_uploadJob || _uploadJob->isLikelyFinishedQuickly(); }
+
+private slots:
+    void slotCopyJobFinished();
+    void finalize();
+
+private:
+    void uploadInstead(const QString &reason);
+};
+}
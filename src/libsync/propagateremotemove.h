@@ -53,6 +53,7 @@ public:
     void start() override;
     void abort(PropagatorJob::AbortType abortType) override;
     JobParallelism parallelism() override { return _item->isDirectory() ? WaitForFinished : FullParallelism; }
+    bool isLikelyFinishedQuickly() override { return !_item->isDirectory(); }
 
     /**
      * Rename the directory in the selective sync list
@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "requestcoalescer.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QLoggingCategory>
+
+#include <algorithm>
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcRequestCoalescer, "sync.networkjob.coalescer", QtInfoMsg)
+
+/**
+ * The network reply of a request that is shared by several callers,
+ * a child of the network reply.
+ */
+class SharedReply : public QObject
+{
+public:
+    SharedReply(RequestCoalescer *coalescer, const QByteArray &key, QNetworkReply *source)
+        : QObject(source)
+        , _coalescer(coalescer)
+        , _key(key)
+        , _source(source)
+    {
+        connect(source, &QNetworkReply::metaDataChanged, this, [this] {
+            for (auto *reply : replies()) {
+                reply->copyMetaData(_source);
+                Q_EMIT reply->metaDataChanged();
+            }
+        });
+        connect(source, &QNetworkReply::readyRead, this, &SharedReply::forwardData);
+        connect(source, &QNetworkReply::downloadProgress, this, [this](qint64 received, qint64 total) {
+            for (auto *reply : replies()) {
+                Q_EMIT reply->downloadProgress(received, total);
+            }
+        });
+        connect(source, &QNetworkReply::finished, this, [this] {
+            // a request sent while we notify the callers, even by them, needs its own reply
+            stopJoining();
+            forwardData();
+            for (auto *reply : replies()) {
+                reply->copyMetaData(_source);
+                reply->finish(_source->error(), _source->errorString());
+            }
+            _replies.clear();
+            _source->deleteLater();
+        });
+    }
+
+    ~SharedReply() override
+    {
+        stopJoining();
+        // the network reply was deleted before it finished
+        for (auto *reply : replies()) {
+            reply->finish(QNetworkReply::OperationCanceledError, QCoreApplication::translate("QNetworkReply", "Operation canceled"));
+        }
+    }
+
+    CoalescedReply *join()
+    {
+        auto *reply = new CoalescedReply(this, _source, _coalescer);
+        _replies.append(reply);
+        return reply;
+    }
+
+    void release(CoalescedReply *reply)
+    {
+        _replies.removeAll(reply);
+        if (replies().isEmpty() && !_source->isFinished()) {
+            qCDebug(lcRequestCoalescer) << "Nobody is waiting for" << _source->url() << "anymore, aborting";
+            stopJoining();
+            _source->abort();
+        }
+    }
+
+private:
+    QVector<CoalescedReply *> replies()
+    {
+        QVector<CoalescedReply *> out;
+        out.reserve(_replies.size());
+        for (const auto &reply : qAsConst(_replies)) {
+            if (reply && !reply->isFinished()) {
+                out.append(reply);
+            }
+        }
+        return out;
+    }
+
+    void forwardData()
+    {
+        if (!_source->bytesAvailable()) {
+            return;
+        }
+        // we don't keep the data for late callers
+        stopJoining();
+        const QByteArray data = _source->readAll();
+        for (auto *reply : replies()) {
+            reply->appendData(data);
+        }
+    }
+
+    void stopJoining()
+    {
+        if (_coalescer) {
+            _coalescer->remove(this);
+            _coalescer.clear();
+        }
+    }
+
+    QPointer<RequestCoalescer> _coalescer;
+    const QByteArray _key;
+    QNetworkReply *_source;
+    QVector<QPointer<CoalescedReply>> _replies;
+
+    friend class RequestCoalescer;
+};
+
+CoalescedReply::CoalescedReply(SharedReply *shared, QNetworkReply *source, QObject *parent)
+    : QNetworkReply(parent)
+    , _shared(shared)
+{
+    setOperation(source->operation());
+    setRequest(source->request());
+    setUrl(source->url());
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    copyMetaData(source);
+}
+
+CoalescedReply::~CoalescedReply()
+{
+    if (_shared) {
+        _shared->release(this);
+    }
+}
+
+void CoalescedReply::abort()
+{
+    if (isFinished()) {
+        return;
+    }
+    finish(OperationCanceledError, QCoreApplication::translate("QNetworkReply", "Operation canceled"));
+    if (_shared) {
+        _shared->release(this);
+        _shared.clear();
+    }
+}
+
+qint64 CoalescedReply::bytesAvailable() const
+{
+    return _buffer.size() - _readOffset + QNetworkReply::bytesAvailable();
+}
+
+qint64 CoalescedReply::readData(char *data, qint64 maxSize)
+{
+    const int available = _buffer.size() - _readOffset;
+    if (available == 0) {
+        return isFinished() ? -1 : 0;
+    }
+    const auto size = std::min<qint64>(maxSize, available);
+    std::copy_n(_buffer.constData() + _readOffset, size, data);
+    _readOffset += static_cast<int>(size);
+    if (_readOffset == _buffer.size()) {
+        _buffer.clear();
+        _readOffset = 0;
+    }
+    return size;
+}
+
+void CoalescedReply::copyMetaData(QNetworkReply *source)
+{
+    for (const auto &header : source->rawHeaderPairs()) {
+        setRawHeader(header.first, header.second);
+    }
+    for (const auto attribute : { QNetworkRequest::HttpStatusCodeAttribute, QNetworkRequest::HttpReasonPhraseAttribute,
+             QNetworkRequest::RedirectionTargetAttribute, QNetworkRequest::ConnectionEncryptedAttribute,
+             QNetworkRequest::SourceIsFromCacheAttribute, QNetworkRequest::Http2WasUsedAttribute }) {
+        setAttribute(attribute, source->attribute(attribute));
+    }
+    // like the authentication failure flag of the credentials, see HttpCredentials::stillValid()
+    for (const auto &name : source->dynamicPropertyNames()) {
+        // Qt internal
+        if (!name.startsWith("_q_")) {
+            setProperty(name.constData(), source->property(name.constData()));
+        }
+    }
+}
+
+void CoalescedReply::appendData(const QByteArray &data)
+{
+    // only move the unread data once at least as much was read, that keeps small reads linear
+    if (_readOffset > 0 && _readOffset >= _buffer.size() - _readOffset) {
+        _buffer.remove(0, _readOffset);
+        _readOffset = 0;
+    }
+    _buffer.append(data);
+    Q_EMIT readyRead();
+}
+
+void CoalescedReply::finish(QNetworkReply::NetworkError error, const QString &errorString)
+{
+    if (isFinished()) {
+        return;
+    }
+    if (error != NoError) {
+        setError(error, errorString);
+    }
+    setFinished(true);
+    if (error != NoError) {
+        Q_EMIT errorOccurred(error);
+    }
+    Q_EMIT finished();
+}
+
+RequestCoalescer::RequestCoalescer(QObject *parent)
+    : QObject(parent)
+{
+}
+
+bool RequestCoalescer::isCoalescable(const QByteArray &verb, const QNetworkRequest &request, QIODevice *body)
+{
+    if (verb != QByteArrayLiteral("GET") && verb != QByteArrayLiteral("PROPFIND")) {
+        return false;
+    }
+    // partial downloads are driven by their caller
+    if (request.hasRawHeader(QByteArrayLiteral("Range"))) {
+        return false;
+    }
+    // we can only compare bodies we can look at without consuming them
+    return !body || qobject_cast<QBuffer *>(body);
+}
+
+QByteArray RequestCoalescer::requestKey(const QByteArray &verb, const QNetworkRequest &request, QIODevice *body)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(verb);
+    hash.addData(request.url().toEncoded());
+    auto headers = request.rawHeaderList();
+    std::sort(headers.begin(), headers.end());
+    for (const auto &header : qAsConst(headers)) {
+        // unique per request
+        if (header == QByteArrayLiteral("X-Request-ID") || header == QByteArrayLiteral("Original-Request-ID")) {
+            continue;
+        }
+        hash.addData(header);
+        hash.addData(request.rawHeader(header));
+    }
+    if (auto buffer = qobject_cast<QBuffer *>(body)) {
+        hash.addData(buffer->data());
+    }
+    return hash.result();
+}
+
+QNetworkReply *RequestCoalescer::send(const QByteArray &verb, const QNetworkRequest &request, QIODevice *body, const SendFunction &send)
+{
+    Q_ASSERT(isCoalescable(verb, request, body));
+    const QByteArray key = requestKey(verb, request, body);
+    if (auto shared = _inFlight.value(key)) {
+        ++_coalescedRequests;
+        qCDebug(lcRequestCoalescer) << "Joining the in-flight" << verb << request.url() << "total:" << _coalescedRequests;
+        return shared->join();
+    }
+    auto *source = send();
+    if (!source || source->isFinished()) {
+        return source;
+    }
+    auto *shared = new SharedReply(this, key, source);
+    _inFlight.insert(key, shared);
+    return shared->join();
+}
+
+void RequestCoalescer::remove(SharedReply *shared)
+{
+    auto it = _inFlight.find(shared->_key);
+    if (it != _inFlight.end() && it.value() == shared) {
+        _inFlight.erase(it);
+    }
+}
+
+}
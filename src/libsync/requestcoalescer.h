@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QHash>
+#include <QNetworkReply>
+#include <QPointer>
+
+#include <functional>
+
+namespace OCC {
+
+class SharedReply;
+
+/**
+ * @brief A reply that replays the response of a request sent by someone else
+ *
+ * Headers, attributes, dynamic properties, data and the error of the shared
+ * network reply are copied as they arrive. Aborting or deleting it only
+ * detaches it, the shared request is aborted once nobody is waiting for it
+ * anymore.
+ */
+class OWNCLOUDSYNC_EXPORT CoalescedReply : public QNetworkReply
+{
+    Q_OBJECT
+public:
+    ~CoalescedReply() override;
+
+    void abort() override;
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+
+private:
+    CoalescedReply(SharedReply *shared, QNetworkReply *source, QObject *parent);
+
+    void copyMetaData(QNetworkReply *source);
+    void appendData(const QByteArray &data);
+    void finish(QNetworkReply::NetworkError error, const QString &errorString);
+
+    QPointer<SharedReply> _shared;
+    QByteArray _buffer;
+    // the data before it was read already
+    int _readOffset = 0;
+
+    friend class SharedReply;
+};
+
+/**
+ * @brief Sends identical idempotent requests only once while they are in flight
+ *
+ * When a GET or PROPFIND is sent while an identical one, same url, headers
+ * and body, is waiting for its response, no new request is sent. Both
+ * callers receive a CoalescedReply replaying the response of the first
+ * request.
+ *
+ * Only requests that didn't receive any data yet are joined, so the
+ * response never has to be kept in memory as a whole.
+ */
+class OWNCLOUDSYNC_EXPORT RequestCoalescer : public QObject
+{
+    Q_OBJECT
+public:
+    using SendFunction = std::function<QNetworkReply *()>;
+
+    explicit RequestCoalescer(QObject *parent = nullptr);
+
+    /** Whether the request is idempotent and its body can be compared */
+    static bool isCoalescable(const QByteArray &verb, const QNetworkRequest &request, QIODevice *body);
+
+    /** Returns a reply for the request, sending it with send() unless an identical request is in flight */
+    QNetworkReply *send(const QByteArray &verb, const QNetworkRequest &request, QIODevice *body, const SendFunction &send);
+
+    /** The number of requests that didn't need to be sent */
+    qint64 coalescedRequests() const { return _coalescedRequests; }
+
+    /** The number of requests that can currently be joined */
+    int inFlight() const { return _inFlight.size(); }
+
+private:
+    static QByteArray requestKey(const QByteArray &verb, const QNetworkRequest &request, QIODevice *body);
+    void remove(SharedReply *shared);
+
+    QHash<QByteArray, SharedReply *> _inFlight;
+    qint64 _coalescedRequests = 0;
+
+    friend class SharedReply;
+};
+
+}
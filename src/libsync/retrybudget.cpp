@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "retrybudget.h"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+using namespace std::chrono;
+
+namespace OCC {
+
+RetryBudget::RetryBudget(int capacity, milliseconds refillInterval)
+    : _capacity(capacity)
+    , _refillInterval(refillInterval)
+{
+}
+
+double RetryBudget::refilled(const Bucket &bucket, Clock::time_point now) const
+{
+    const auto elapsed = duration_cast<milliseconds>(now - bucket.lastRefill);
+    if (elapsed <= 0ms) {
+        return bucket.tokens;
+    }
+    return std::min<double>(_capacity, bucket.tokens + double(elapsed.count()) / _refillInterval.count());
+}
+
+bool RetryBudget::tryAcquire(const QString &host, Clock::time_point now)
+{
+    auto it = _buckets.find(host);
+    if (it == _buckets.end()) {
+        it = _buckets.insert(host, { double(_capacity), now });
+    } else {
+        it->tokens = refilled(*it, now);
+        it->lastRefill = std::max(it->lastRefill, now);
+    }
+    if (it->tokens < 1) {
+        ++_denied;
+        return false;
+    }
+    it->tokens -= 1;
+    ++_granted;
+    return true;
+}
+
+double RetryBudget::tokens(const QString &host, Clock::time_point now) const
+{
+    const auto it = _buckets.constFind(host);
+    if (it == _buckets.cend()) {
+        return _capacity;
+    }
+    return refilled(*it, now);
+}
+
+milliseconds RetryBudget::backoff(int retryCount, double jitter)
+{
+    // 2^16 * BaseDelay is way beyond MaxDelay
+    const auto exponential = std::min(BaseDelay * (1 << std::clamp(retryCount, 0, 16)), MaxDelay);
+    return exponential / 2 + duration_cast<milliseconds>(exponential / 2 * std::clamp(jitter, 0.0, 1.0));
+}
+
+milliseconds RetryBudget::backoff(int retryCount)
+{
+    return backoff(retryCount, QRandomGenerator::global()->generateDouble());
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QHash>
+#include <QString>
+
+#include <chrono>
+
+namespace OCC {
+
+/**
+ * @brief Limits how often failed requests are retried per host
+ *
+ * Every host has a token bucket: a retry takes a token, tokens are refilled
+ * at a fixed rate up to the capacity. Without a token the request fails
+ * instead of being retried, so a struggling server isn't hit by all jobs
+ * retrying at the same time.
+ *
+ * The delay before a retry grows exponentially with the number of previous
+ * retries of the job and is jittered, so jobs that failed together don't
+ * retry together.
+ */
+class OWNCLOUDSYNC_EXPORT RetryBudget
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int DefaultCapacity = 10;
+    static constexpr std::chrono::milliseconds DefaultRefillInterval { 2000 };
+    static constexpr std::chrono::milliseconds BaseDelay { 250 };
+    static constexpr std::chrono::milliseconds MaxDelay { 30000 };
+
+    explicit RetryBudget(int capacity = DefaultCapacity, std::chrono::milliseconds refillInterval = DefaultRefillInterval);
+
+    /** Takes a token of the host, returns false if none is left */
+    bool tryAcquire(const QString &host, Clock::time_point now = Clock::now());
+
+    /** The number of tokens the host has left */
+    double tokens(const QString &host, Clock::time_point now = Clock::now()) const;
+
+    /** The delay before the next retry of a job that was already retried retryCount times
+     *
+     * jitter is in [0, 1), the delay is between half and the full exponential delay.
+     */
+    static std::chrono::milliseconds backoff(int retryCount, double jitter);
+    /** Like above with a random jitter */
+    static std::chrono::milliseconds backoff(int retryCount);
+
+    /** The number of granted and denied retries */
+    qint64 grantedRetries() const { return _granted; }
+    qint64 deniedRetries() const { return _denied; }
+
+private:
+    struct Bucket
+    {
+        double tokens;
+        Clock::time_point lastRefill;
+    };
+
+    double refilled(const Bucket &bucket, Clock::time_point now) const;
+
+    const int _capacity;
+    const std::chrono::milliseconds _refillInterval;
+    QHash<QString, Bucket> _buckets;
+    qint64 _granted = 0;
+    qint64 _denied = 0;
+};
+
+}
@@ -38,6 +38,8 @@
 #include <climits>
 #include <assert.h>
 #include <chrono>
+#include <utility>
+#include <vector>
 
 #include <QCoreApplication>
 #include <QSslSocket>
@@ -371,6 +373,7 @@ void SyncEngine::startSync()
 
     _hasNoneFiles = false;
     _hasRemoveFile = false;
+    _hasFailedItems = false;
     _seenConflictFiles.clear();
 
     _progressInfo->reset();
@@ -429,6 +432,8 @@ void SyncEngine::startSync()
     // filtering via schedulePathForRemoteDiscovery(). This *is* the next sync, so
     // undo the filter to allow this sync to retrieve and store the correct etags.
     _journal->clearEtagStorageFilter();
+    // the blacklist might have changed since the last sync, the statistics are per sync run
+    _journal->clearErrorBlacklistCache();
 
     _excludedFiles->setExcludeConflictFiles(!_account->capabilities().uploadConflictFiles());
 
@@ -454,6 +459,11 @@ void SyncEngine::startSync()
 
     _stopWatch.start();
 
+    if (!_pinChangePaths.empty()) {
+        startPinChangeSync();
+        return;
+    }
+
     qCInfo(lcEngine) << "#### Discovery start ####################################################";
     qCInfo(lcEngine) << "Server" << account()->capabilities().status().versionString()
                      << (account()->isHttp2Supported() ? "Using HTTP/2" : "");
@@ -487,6 +497,7 @@ void SyncEngine::startSync()
     }
     _discoveryPhase->_serverBlacklistedFiles = _account->capabilities().blacklistedFiles();
     _discoveryPhase->_ignoreHiddenFiles = ignoreHiddenFiles();
+    _discoveryPhase->_planOnly = _planOnly;
 
     connect(_discoveryPhase.data(), &DiscoveryPhase::itemDiscovered, this, &SyncEngine::slotItemDiscovered);
     connect(_discoveryPhase.data(), &DiscoveryPhase::newBigFolder, this, &SyncEngine::newBigFolder);
@@ -502,10 +513,19 @@ void SyncEngine::startSync()
     connect(_discoveryPhase.data(), &DiscoveryPhase::excluded,
         this, &SyncEngine::excluded);
 
-    auto discoveryJob = new ProcessDirectoryJob(
-        _discoveryPhase.data(), PinState::AlwaysLocal, _discoveryPhase.data());
-    _discoveryPhase->startJob(discoveryJob);
-    connect(discoveryJob, &ProcessDirectoryJob::etag, this, &SyncEngine::slotRootEtagReceived);
+    auto startDiscovery = [this] {
+        auto discoveryJob = new ProcessDirectoryJob(
+            _discoveryPhase.data(), PinState::AlwaysLocal, _discoveryPhase.data());
+        _discoveryPhase->startJob(discoveryJob);
+        connect(discoveryJob, &ProcessDirectoryJob::etag, this, &SyncEngine::slotRootEtagReceived);
+    };
+
+    const QByteArray syncToken = _journal->syncToken();
+    if (!syncToken.isEmpty() && _account->capabilities().syncCollectionReport()) {
+        _discoveryPhase->fetchRemoteDelta(syncToken, startDiscovery);
+    } else {
+        startDiscovery();
+    }
 }
 
 void SyncEngine::slotFolderDiscovered(bool local, const QString &folder)
@@ -551,7 +571,96 @@ void SyncEngine::slotDiscoveryFinished()
     }
 
     qCInfo(lcEngine) << "#### Discovery end #################################################### " << _stopWatch.addLapTime(QStringLiteral("Discovery Finished")) << "ms";
+    qCInfo(lcEngine) << "Checked the blacklist without a query" << _journal->errorBlacklistQueriesSaved() << "times";
+
+    reconcile();
+}
+
+void SyncEngine::startPinChangeSync()
+{
+    qCInfo(lcEngine) << "#### Pin change start, skipping the discovery ####################################################";
+    const auto paths = std::exchange(_pinChangePaths, {});
+
+    // collect the records first, the journal is locked while iterating
+    std::vector<SyncJournalFileRecord> records;
+    for (const auto &path : paths) {
+        qCInfo(lcEngine) << "Applying the pin states below" << path;
+        SyncJournalFileRecord record;
+        const bool ok = _journal->getFileRecord(path, &record)
+            && _journal->getFilesBelowPath(path.toUtf8(), [&records](const SyncJournalFileRecord &rec) { records.push_back(rec); });
+        if (!ok) {
+            Q_EMIT syncError(tr("Unable to read from the sync journal."));
+            finalize(false);
+            return;
+        }
+        if (record.isValid()) {
+            records.push_back(record);
+        }
+    }
 
+    for (const auto &record : records) {
+        auto item = pinChangeItem(record);
+        // overlapping paths yield the same item twice
+        if (item && _syncItems.find(item) == _syncItems.cend()) {
+            slotItemDiscovered(item);
+        }
+    }
+
+    qCInfo(lcEngine) << "#### Pin change end, found" << _syncItems.size() << "files #### " << _stopWatch.addLapTime(QStringLiteral("Pin Change Finished")) << "ms";
+    reconcile();
+}
+
+SyncFileItemPtr SyncEngine::pinChangeItem(const SyncJournalFileRecord &record)
+{
+    auto &vfs = *syncOptions()._vfs;
+    const QString path = QString::fromUtf8(record._path);
+    const auto pin = vfs.pinState(path);
+    if (!pin) {
+        return {};
+    }
+    const bool hydrate = record._type == ItemTypeVirtualFileDownload || (record._type == ItemTypeVirtualFile && *pin == PinState::AlwaysLocal);
+    const bool dehydrate = record._type == ItemTypeVirtualFileDehydration || (record._type == ItemTypeFile && *pin == PinState::OnlineOnly);
+    if (!hydrate && !dehydrate) {
+        return {};
+    }
+
+    auto item = SyncFileItem::fromSyncJournalFileRecord(record);
+    item->_instruction = CSYNC_INSTRUCTION_SYNC;
+    item->_direction = SyncFileItem::Down;
+    item->_previousSize = record._fileSize;
+    item->_previousModtime = record._modtime;
+
+    const QDir localDir(_localPath);
+    const QString localPath = localDir.filePath(path);
+    bool leftToNextSync = !FileSystem::fileExists(localPath);
+    if (hydrate) {
+        item->_type = ItemTypeVirtualFileDownload;
+        if (vfs.mode() == Vfs::WithSuffix) {
+            // the placeholder is replaced by the file without the suffix
+            if (!item->_file.endsWith(vfs.fileSuffix())) {
+                return {};
+            }
+            item->_file.chop(vfs.fileSuffix().size());
+            leftToNextSync = leftToNextSync || FileSystem::fileExists(localDir.filePath(item->_file));
+        }
+    } else {
+        item->_type = ItemTypeVirtualFileDehydration;
+        leftToNextSync = leftToNextSync || FileSystem::fileChanged(QFileInfo(localPath), record._fileSize, record._modtime);
+        if (vfs.mode() == Vfs::WithSuffix) {
+            item->_renameTarget = item->_file + vfs.fileSuffix();
+        }
+    }
+    if (leftToNextSync) {
+        // the discovery of the next sync has to sort it out
+        qCInfo(lcEngine) << "Not applying the pin state of the changed file" << path;
+        _anotherSyncNeeded = ImmediateFollowUp;
+        return {};
+    }
+    return item;
+}
+
+void SyncEngine::reconcile()
+{
     // Sanity check
     if (!_journal->open()) {
         qCWarning(lcEngine) << "Bailing out, DB failure";
@@ -581,7 +690,7 @@ void SyncEngine::slotDiscoveryFinished()
             restoreOldFiles(_syncItems);
         }
 
-        if (_discoveryPhase->_anotherSyncNeeded && _anotherSyncNeeded == NoFollowUpSync) {
+        if (_discoveryPhase && _discoveryPhase->_anotherSyncNeeded && _anotherSyncNeeded == NoFollowUpSync) {
             _anotherSyncNeeded = ImmediateFollowUp;
         }
 
@@ -623,6 +732,17 @@ void SyncEngine::slotDiscoveryFinished()
 
         _localDiscoveryPaths.clear();
 
+        if (_planOnly) {
+            // nothing was changed, there is nothing to follow up on
+            _anotherSyncNeeded = NoFollowUpSync;
+            Q_EMIT syncPlanReady(SyncPlan::fromItems(_syncItems), _syncItems);
+            _syncItems.clear();
+            _progressInfo->_status = ProgressInfo::Done;
+            emit transmissionProgress(*_progressInfo);
+            finalize(true);
+            return;
+        }
+
         // To announce the beginning of the sync
         emit aboutToPropagate(_syncItems);
 
@@ -665,10 +785,13 @@ void SyncEngine::slotDiscoveryFinished()
         // apply the network limits to the propagator
         setNetworkLimits(_uploadLimit, _downloadLimit);
 
-        deleteStaleDownloadInfos(_syncItems);
-        deleteStaleUploadInfos(_syncItems);
-        deleteStaleErrorBlacklistEntries(_syncItems);
-        _journal->commit(QStringLiteral("post stale entry removal"));
+        // a pin change sync only knows the items it hydrates or dehydrates
+        if (_discoveryPhase) {
+            deleteStaleDownloadInfos(_syncItems);
+            deleteStaleUploadInfos(_syncItems);
+            deleteStaleErrorBlacklistEntries(_syncItems);
+            _journal->commit(QStringLiteral("post stale entry removal"));
+        }
 
         // Emit the started signal only after the propagator has been set up.
         if (_needsUpdate)
@@ -679,7 +802,7 @@ void SyncEngine::slotDiscoveryFinished()
         qCInfo(lcEngine) << "#### Post-Reconcile end #################################################### " << _stopWatch.addLapTime(QStringLiteral("Post-Reconcile Finished")) << "ms";
     };
 
-    if (!_hasNoneFiles && _hasRemoveFile) {
+    if (!_hasNoneFiles && _hasRemoveFile && !_planOnly) {
         qCInfo(lcEngine) << "All the files are going to be changed, asking the user";
         int side = 0; // > 0 means more deleted on the server.  < 0 means more deleted on the client
         for (const auto &it : qAsConst(_syncItems)) {
@@ -742,6 +865,18 @@ void SyncEngine::slotItemCompleted(const SyncFileItemPtr &item)
 
     _progressInfo->setProgressComplete(*item);
 
+    switch (item->_status) {
+    case SyncFileItem::FatalError:
+    case SyncFileItem::NormalError:
+    case SyncFileItem::SoftError:
+    case SyncFileItem::DetailError:
+    case SyncFileItem::BlacklistedError:
+        _hasFailedItems = true;
+        break;
+    default:
+        break;
+    }
+
     emit transmissionProgress(*_progressInfo);
     emit itemCompleted(item);
 }
@@ -754,6 +889,11 @@ void SyncEngine::slotPropagationFinished(bool success)
 
     if (success && _discoveryPhase) {
         _journal->setDataFingerprint(_discoveryPhase->_dataFingerprint);
+
+        // Failed items must be reported again by the next delta, keep the old token
+        if (!_hasFailedItems && !_discoveryPhase->_remoteTreeIncomplete && !_discoveryPhase->_syncToken.isEmpty()) {
+            _journal->setSyncToken(_discoveryPhase->_syncToken);
+        }
     }
 
     conflictRecordMaintenance();
@@ -28,6 +28,7 @@
 #include "csync/csync_exclude.h"
 
 #include "syncfileitem.h"
+#include "syncplan.h"
 #include "progressdispatcher.h"
 #include "common/utility.h"
 #include "syncfilestatustracker.h"
@@ -132,6 +133,27 @@ public:
      */
     bool shouldDiscoverLocally(const QString &path) const;
 
+    /**
+     * Stop syncs after reconcile and report what they would do.
+     *
+     * A plan-only sync runs the discovery and emits syncPlanReady(), it
+     * neither propagates nor updates the journal and never asks for
+     * confirmation before removing all files.
+     */
+    void setPlanOnly(bool planOnly) { _planOnly = planOnly; }
+    bool isPlanOnly() const { return _planOnly; }
+
+    /**
+     * Let the next sync only apply the pin states of the files below paths.
+     *
+     * The files to hydrate or dehydrate are taken from the journal and passed
+     * to the propagator right away, without a discovery. Files that changed
+     * locally since the last sync are left to the next regular sync.
+     *
+     * The paths are only retained for the next sync.
+     */
+    void setPinChangePaths(std::set<QString> paths) { _pinChangePaths = std::move(paths); }
+
     /** Access the last sync run's local discovery style */
     LocalDiscoveryStyle lastLocalDiscoveryStyle() const { return _lastLocalDiscoveryStyle; }
 
@@ -166,6 +188,9 @@ signals:
     void finished(bool success);
     void started();
 
+    /// Emitted by plan-only syncs before finished(), with the reconciled items
+    void syncPlanReady(const SyncPlan &plan, const SyncFileItemSet &items);
+
     /**
      * Emited when the sync engine detects that all the files have been removed or change.
      * This usually happen when the server was reset or something.
@@ -234,6 +259,13 @@ private:
     // cleanup and emit the finished signal
     void finalize(bool success);
 
+    // Collects the hydrations and dehydrations of _pinChangePaths instead of a discovery
+    void startPinChangeSync();
+    SyncFileItemPtr pinChangeItem(const SyncJournalFileRecord &record);
+
+    // Propagates the discovered items
+    void reconcile();
+
     // Must only be acessed during update and reconcile
     SyncFileItemSet _syncItems;
 
@@ -275,9 +307,14 @@ private:
     // true if there is at leasr one file with instruction REMOVE
     bool _hasRemoveFile;
 
+    // If any item failed in this sync run, the sync token must not be stored
+    bool _hasFailedItems = false;
+
     // If ignored files should be ignored
     bool _ignore_hidden_files = false;
 
+    bool _planOnly = false;
+
 
     int _uploadLimit;
     int _downloadLimit;
@@ -304,6 +341,8 @@ private:
     // must be ordered
     std::set<QString> _localDiscoveryPaths;
 
+    std::set<QString> _pinChangePaths;
+
     // destructor called
     bool _goingDown = false;
 };
@@ -285,6 +285,14 @@ public:
     QString _directDownloadUrl;
     QString _directDownloadCookies;
 
+    /** For new local files: the db path of a file with the same content
+     *
+     * The file is copied on the server instead of being uploaded.
+     */
+    QString _copySource;
+    /// The etag the copy source must still have on the server
+    QString _copySourceEtag;
+
     bool _relevantDirectoyInstruction = false;
     bool _finished = false;
 };
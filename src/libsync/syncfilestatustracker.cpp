@@ -27,40 +27,6 @@ namespace OCC {
 
 Q_LOGGING_CATEGORY(lcStatusTracker, "sync.statustracker", QtInfoMsg)
 
-bool SyncFileStatusTracker::PathComparator::operator()( const QString& lhs, const QString& rhs ) const
-{
-    // This will make sure that the std::map is ordered and queried case-insensitively on macOS and Windows.
-    // we want don't want to pay for the runtime check on every comparison.
-    static const auto sensitivity = Utility::fsCaseSensitivity();
-    return lhs.compare(rhs, sensitivity) < 0;
-}
-
-SyncFileStatus::SyncFileStatusTag SyncFileStatusTracker::lookupProblem(const QString &pathToMatch, const SyncFileStatusTracker::ProblemsMap &problemMap)
-{
-    auto lower = problemMap.lower_bound(pathToMatch);
-    for (auto it = lower; it != problemMap.cend(); ++it) {
-        const QString &problemPath = it->first;
-        SyncFileStatus::SyncFileStatusTag severity = it->second;
-
-        if (problemPath.compare(pathToMatch, _caseSensitivity) == 0) {
-            return severity;
-        } else if (severity == SyncFileStatus::StatusError
-            && problemPath.startsWith(pathToMatch, _caseSensitivity)
-            && (pathToMatch.isEmpty() || problemPath.at(pathToMatch.size()) == QLatin1Char('/'))) {
-            return SyncFileStatus::StatusWarning;
-        } else if (!problemPath.startsWith(pathToMatch, _caseSensitivity)) {
-            // Starting at lower_bound we get the first path that is not smaller,
-            // since: "a/" < "a/aa" < "a/aa/aaa" < "a/ab/aba"
-            // If problemMap keys are ["a/aa/aaa", "a/ab/aba"] and pathToMatch == "a/aa",
-            // lower_bound(pathToMatch) will point to "a/aa/aaa", and the moment that
-            // problemPath.startsWith(pathToMatch) == false, we know that we've looked
-            // at everything that interest us.
-            break;
-        }
-    }
-    return SyncFileStatus::StatusNone;
-}
-
 /**
  * Whether this item should get an ERROR icon through the Socket API.
  *
@@ -91,7 +57,7 @@ static inline bool hasExcludedStatus(const SyncFileItem &item)
 
 SyncFileStatusTracker::SyncFileStatusTracker(SyncEngine *syncEngine)
     : _syncEngine(syncEngine)
-    , _caseSensitivity(Utility::fsCaseSensitivity())
+    , _statusTree(Utility::fsCaseSensitivity())
 {
     connect(syncEngine, &SyncEngine::aboutToPropagate,
         this, &SyncFileStatusTracker::slotAboutToPropagate);
@@ -157,14 +123,14 @@ void SyncFileStatusTracker::slotPathTouched(const QString &fileName)
 
 void SyncFileStatusTracker::slotAddSilentlyExcluded(const QString &folderPath)
 {
-    _syncProblems[folderPath] = SyncFileStatus::StatusExcluded;
+    _statusTree.setProblem(folderPath, SyncFileStatus::StatusExcluded);
     emit fileStatusChanged(getSystemDestination(folderPath), resolveSyncAndErrorStatus(folderPath, NotShared));
 }
 
 void SyncFileStatusTracker::incSyncCountAndEmitStatusChanged(const QString &relativePath, SharedFlag sharedFlag)
 {
-    // Will return 0 (and increase to 1) if the path wasn't in the map yet
-    int count = _syncCount[relativePath]++;
+    // Will return 0 (and increase to 1) if the path wasn't in the tree yet
+    int count = _statusTree.incSyncCount(relativePath);
     if (!count) {
         SyncFileStatus status = sharedFlag == UnknownShared
             ? fileStatus(relativePath)
@@ -184,11 +150,8 @@ void SyncFileStatusTracker::incSyncCountAndEmitStatusChanged(const QString &rela
 
 void SyncFileStatusTracker::decSyncCountAndEmitStatusChanged(const QString &relativePath, SharedFlag sharedFlag)
 {
-    int count = --_syncCount[relativePath];
+    int count = _statusTree.decSyncCount(relativePath);
     if (!count) {
-        // Remove from the map, same as 0
-        _syncCount.remove(relativePath);
-
         SyncFileStatus status = sharedFlag == UnknownShared
             ? fileStatus(relativePath)
             : resolveSyncAndErrorStatus(relativePath, sharedFlag);
@@ -206,10 +169,9 @@ void SyncFileStatusTracker::decSyncCountAndEmitStatusChanged(const QString &rela
 
 void SyncFileStatusTracker::slotAboutToPropagate(const SyncFileItemSet &items)
 {
-    OC_ASSERT(_syncCount.isEmpty());
+    OC_ASSERT(!_statusTree.hasSyncCounts());
 
-    ProblemsMap oldProblems;
-    std::swap(_syncProblems, oldProblems);
+    const auto oldProblems = _statusTree.takeProblems();
 
     for (const auto &item : qAsConst(items)) {
         qCDebug(lcStatusTracker) << "Investigating" << item->destination() << item->_status << item->_instruction;
@@ -217,10 +179,10 @@ void SyncFileStatusTracker::slotAboutToPropagate(const SyncFileItemSet &items)
         _dirtyPaths.remove(item->_originalFile);
 
         if (hasErrorStatus(*item)) {
-            _syncProblems[item->destination()] = SyncFileStatus::StatusError;
+            _statusTree.setProblem(item->destination(), SyncFileStatus::StatusError);
             invalidateParentPaths(item->destination());
         } else if (hasExcludedStatus(*item)) {
-            _syncProblems[item->destination()] = SyncFileStatus::StatusExcluded;
+            _statusTree.setProblem(item->destination(), SyncFileStatus::StatusExcluded);
         }
 
         SharedFlag sharedFlag = item->_remotePerm.hasPermission(RemotePermissions::IsShared) ? Shared : NotShared;
@@ -245,11 +207,11 @@ void SyncFileStatusTracker::slotAboutToPropagate(const SyncFileItemSet &items)
 
     // Make sure to push any status that might have been resolved indirectly since the last sync
     // (like an error file being deleted from disk)
-    for (auto it = _syncProblems.begin(); it != _syncProblems.end(); ++it)
-        oldProblems.erase(it->first);
-    for (auto it = oldProblems.begin(); it != oldProblems.end(); ++it) {
-        const QString &path = it->first;
-        SyncFileStatus::SyncFileStatusTag severity = it->second;
+    for (auto it = oldProblems.cbegin(); it != oldProblems.cend(); ++it) {
+        const QString &path = it.key();
+        if (_statusTree.problem(path) != SyncFileStatus::StatusNone)
+            continue;
+        SyncFileStatus::SyncFileStatusTag severity = it.value();
         if (severity == SyncFileStatus::StatusError)
             invalidateParentPaths(path);
         emit fileStatusChanged(getSystemDestination(path), fileStatus(path));
@@ -261,12 +223,12 @@ void SyncFileStatusTracker::slotItemCompleted(const SyncFileItemPtr &item)
     qCDebug(lcStatusTracker) << "Item completed" << item->destination() << item->_status << item->_instruction;
 
     if (hasErrorStatus(*item)) {
-        _syncProblems[item->destination()] = SyncFileStatus::StatusError;
+        _statusTree.setProblem(item->destination(), SyncFileStatus::StatusError);
         invalidateParentPaths(item->destination());
     } else if (hasExcludedStatus(*item)) {
-        _syncProblems[item->destination()] = SyncFileStatus::StatusExcluded;
+        _statusTree.setProblem(item->destination(), SyncFileStatus::StatusExcluded);
     } else {
-        _syncProblems.erase(item->destination());
+        _statusTree.removeProblem(item->destination());
     }
 
     SharedFlag sharedFlag = item->_remotePerm.hasPermission(RemotePermissions::IsShared) ? Shared : NotShared;
@@ -284,10 +246,9 @@ void SyncFileStatusTracker::slotItemCompleted(const SyncFileItemPtr &item)
 void SyncFileStatusTracker::slotSyncFinished()
 {
     // Clear the sync counts to reduce the impact of unsymetrical inc/dec calls (e.g. when directory job abort)
-    QHash<QString, int> oldSyncCount;
-    std::swap(_syncCount, oldSyncCount);
-    for (auto it = oldSyncCount.begin(); it != oldSyncCount.end(); ++it)
-        emit fileStatusChanged(getSystemDestination(it.key()), fileStatus(it.key()));
+    const QStringList oldSyncCount = _statusTree.takeSyncCounts();
+    for (const auto &path : oldSyncCount)
+        emit fileStatusChanged(getSystemDestination(path), fileStatus(path));
 }
 
 void SyncFileStatusTracker::slotSyncEngineRunningChanged()
@@ -300,12 +261,12 @@ SyncFileStatus SyncFileStatusTracker::resolveSyncAndErrorStatus(const QString &r
     // If it's a new file and that we're not syncing it yet,
     // don't show any icon and wait for the filesystem watcher to trigger a sync.
     SyncFileStatus status(isPathKnown ? SyncFileStatus::StatusUpToDate : SyncFileStatus::StatusNone);
-    if (_syncCount.value(relativePath)) {
+    if (_statusTree.syncCount(relativePath)) {
         status.set(SyncFileStatus::StatusSync);
     } else {
         // After a sync finished, we need to show the users issues from that last sync like the activity list does.
         // Also used for parent directories showing a warning for an error child.
-        SyncFileStatus::SyncFileStatusTag problemStatus = lookupProblem(relativePath, _syncProblems);
+        SyncFileStatus::SyncFileStatusTag problemStatus = _statusTree.lookupProblem(relativePath);
         if (problemStatus != SyncFileStatus::StatusNone)
             status.set(problemStatus);
     }
@@ -18,8 +18,8 @@
 
 // #include "ownsql.h"
 #include "syncfileitem.h"
+#include "syncfilestatustree.h"
 #include "common/syncfilestatus.h"
-#include <map>
 #include <QSet>
 
 namespace OCC {
@@ -53,12 +53,6 @@ private slots:
     void slotSyncEngineRunningChanged();
 
 private:
-    struct PathComparator {
-        bool operator()( const QString& lhs, const QString& rhs ) const;
-    };
-    typedef std::map<QString, SyncFileStatus::SyncFileStatusTag, PathComparator> ProblemsMap;
-    SyncFileStatus::SyncFileStatusTag lookupProblem(const QString &pathToMatch, const ProblemsMap &problemMap);
-
     enum SharedFlag { UnknownShared,
         NotShared,
         Shared };
@@ -73,15 +67,12 @@ private:
 
     SyncEngine *_syncEngine;
 
-    ProblemsMap _syncProblems;
     QSet<QString> _dirtyPaths;
-    // Counts the number direct children currently being synced (has unfinished propagation jobs).
+    // The problems of the last sync and the sync counts.
+    // A sync count is the number of direct children currently being synced (has unfinished propagation jobs).
     // We'll show a file/directory as SYNC as long as its sync count is > 0.
     // A directory that starts/ends propagation will in turn increase/decrease its own parent by 1.
-    QHash<QString, int> _syncCount;
-
-    // case sensitivity used for path comparisons
-    Qt::CaseSensitivity _caseSensitivity;
+    SyncFileStatusTree _statusTree;
 };
 }
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "syncfilestatustree.h"
+
+#include <functional>
+#include <unordered_map>
+
+namespace OCC {
+
+struct SyncFileStatusTree::Node
+{
+    Node *parent = nullptr;
+    /// The key of the node in its parent
+    QString key;
+    /// The path component as it was first seen
+    QString name;
+    std::unordered_map<QString, std::unique_ptr<Node>> children;
+
+    Tag problem = SyncFileStatus::StatusNone;
+    int syncCount = 0;
+    /// The number of errors below the node, not counting its own
+    int errorsBelow = 0;
+
+    bool isEmpty() const { return problem == SyncFileStatus::StatusNone && syncCount == 0 && children.empty(); }
+};
+
+SyncFileStatusTree::SyncFileStatusTree(Qt::CaseSensitivity caseSensitivity)
+    : _caseSensitivity(caseSensitivity)
+    , _root(new Node)
+{
+}
+
+SyncFileStatusTree::~SyncFileStatusTree() = default;
+
+QString SyncFileStatusTree::key(QStringView component) const
+{
+    return _caseSensitivity == Qt::CaseSensitive ? component.toString() : component.toString().toCaseFolded();
+}
+
+const SyncFileStatusTree::Node *SyncFileStatusTree::find(const QString &path) const
+{
+    const Node *node = _root.get();
+    const auto components = path.splitRef(QLatin1Char('/'), Qt::SkipEmptyParts);
+    for (const auto &component : components) {
+        const auto it = node->children.find(key(component));
+        if (it == node->children.cend()) {
+            return nullptr;
+        }
+        node = it->second.get();
+    }
+    return node;
+}
+
+SyncFileStatusTree::Node *SyncFileStatusTree::findOrCreate(const QString &path)
+{
+    Node *node = _root.get();
+    const auto components = path.splitRef(QLatin1Char('/'), Qt::SkipEmptyParts);
+    for (const auto &component : components) {
+        auto &child = node->children[key(component)];
+        if (!child) {
+            child.reset(new Node);
+            child->parent = node;
+            child->key = key(component);
+            child->name = component.toString();
+        }
+        node = child.get();
+    }
+    return node;
+}
+
+void SyncFileStatusTree::prune(Node *node)
+{
+    while (node->parent && node->isEmpty()) {
+        Node *parent = node->parent;
+        // erasing destroys node and its key
+        const QString key = node->key;
+        parent->children.erase(key);
+        node = parent;
+    }
+}
+
+void SyncFileStatusTree::setProblem(const QString &path, Tag problem)
+{
+    Node *node = problem == SyncFileStatus::StatusNone ? const_cast<Node *>(find(path)) : findOrCreate(path);
+    if (!node) {
+        return;
+    }
+    const bool wasError = node->problem == SyncFileStatus::StatusError;
+    const bool isError = problem == SyncFileStatus::StatusError;
+    if (wasError != isError) {
+        for (Node *ancestor = node->parent; ancestor; ancestor = ancestor->parent) {
+            ancestor->errorsBelow += isError ? 1 : -1;
+        }
+    }
+    node->problem = problem;
+    prune(node);
+}
+
+SyncFileStatusTree::Tag SyncFileStatusTree::problem(const QString &path) const
+{
+    const Node *node = find(path);
+    return node ? node->problem : SyncFileStatus::StatusNone;
+}
+
+SyncFileStatusTree::Tag SyncFileStatusTree::lookupProblem(const QString &path) const
+{
+    const Node *node = find(path);
+    if (!node) {
+        return SyncFileStatus::StatusNone;
+    }
+    if (node->problem != SyncFileStatus::StatusNone) {
+        return node->problem;
+    }
+    return node->errorsBelow > 0 ? SyncFileStatus::StatusWarning : SyncFileStatus::StatusNone;
+}
+
+QHash<QString, SyncFileStatusTree::Tag> SyncFileStatusTree::takeProblems()
+{
+    QHash<QString, Tag> out;
+    std::function<void(Node *, const QString &)> take = [&](Node *node, const QString &path) {
+        if (node->problem != SyncFileStatus::StatusNone) {
+            out.insert(path, node->problem);
+            node->problem = SyncFileStatus::StatusNone;
+        }
+        node->errorsBelow = 0;
+        for (auto it = node->children.begin(); it != node->children.end();) {
+            take(it->second.get(), path.isEmpty() ? it->second->name : path + QLatin1Char('/') + it->second->name);
+            if (it->second->isEmpty()) {
+                it = node->children.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+    take(_root.get(), QString());
+    return out;
+}
+
+int SyncFileStatusTree::incSyncCount(const QString &path)
+{
+    Node *node = findOrCreate(path);
+    const int previous = node->syncCount++;
+    updateSyncing(node, previous);
+    return previous;
+}
+
+int SyncFileStatusTree::decSyncCount(const QString &path)
+{
+    Node *node = findOrCreate(path);
+    const int previous = node->syncCount--;
+    const int count = node->syncCount;
+    updateSyncing(node, previous);
+    return count;
+}
+
+void SyncFileStatusTree::updateSyncing(Node *node, int previousCount)
+{
+    if (previousCount == 0) {
+        ++_syncingNodes;
+    } else if (node->syncCount == 0) {
+        --_syncingNodes;
+        prune(node);
+    }
+}
+
+int SyncFileStatusTree::syncCount(const QString &path) const
+{
+    const Node *node = find(path);
+    return node ? node->syncCount : 0;
+}
+
+QStringList SyncFileStatusTree::takeSyncCounts()
+{
+    QStringList out;
+    std::function<void(Node *, const QString &)> take = [&](Node *node, const QString &path) {
+        if (node->syncCount != 0) {
+            out.append(path);
+            node->syncCount = 0;
+        }
+        for (auto it = node->children.begin(); it != node->children.end();) {
+            take(it->second.get(), path.isEmpty() ? it->second->name : path + QLatin1Char('/') + it->second->name);
+            if (it->second->isEmpty()) {
+                it = node->children.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+    take(_root.get(), QString());
+    _syncingNodes = 0;
+    return out;
+}
+
+}
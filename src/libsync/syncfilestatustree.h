@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#pragma once
+
+#include "common/syncfilestatus.h"
+#include "owncloudlib.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+namespace OCC {
+
+/**
+ * @brief The sync counts and problems of the paths of a sync folder
+ *
+ * The paths are kept in a tree with a node per path component. Every node
+ * knows how many errors are below it, so the status of a directory and
+ * updates of a path only touch the nodes of its ancestors, no matter how
+ * many paths are below them.
+ *
+ * Paths are relative to the sync folder, the root is the empty path.
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT SyncFileStatusTree
+{
+public:
+    using Tag = SyncFileStatus::SyncFileStatusTag;
+
+    explicit SyncFileStatusTree(Qt::CaseSensitivity caseSensitivity);
+    ~SyncFileStatusTree();
+
+    /** Sets the problem of path, StatusNone removes it */
+    void setProblem(const QString &path, Tag problem);
+    void removeProblem(const QString &path) { setProblem(path, SyncFileStatus::StatusNone); }
+
+    /** The problem that was set for path */
+    Tag problem(const QString &path) const;
+
+    /** Like problem, but StatusWarning if path has none and a path below it has an error */
+    Tag lookupProblem(const QString &path) const;
+
+    /** Removes all problems and returns them */
+    QHash<QString, Tag> takeProblems();
+
+    /** Increments the sync count of path and returns the previous count */
+    int incSyncCount(const QString &path);
+    /** Decrements the sync count of path and returns the new count */
+    int decSyncCount(const QString &path);
+    int syncCount(const QString &path) const;
+
+    /** Resets all sync counts and returns the paths that had one */
+    QStringList takeSyncCounts();
+    bool hasSyncCounts() const { return _syncingNodes > 0; }
+
+private:
+    struct Node;
+
+    QString key(QStringView component) const;
+    const Node *find(const QString &path) const;
+    Node *findOrCreate(const QString &path);
+    /// Removes node and its ancestors as long as they hold nothing
+    void prune(Node *node);
+    /// Counts the nodes with a sync count, node may be destroyed
+    void updateSyncing(Node *node, int previousCount);
+
+    const Qt::CaseSensitivity _caseSensitivity;
+    std::unique_ptr<Node> _root;
+    int _syncingNodes = 0;
+};
+
+}
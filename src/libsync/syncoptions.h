@@ -26,6 +26,7 @@
 
 
 namespace OCC {
+class TransferBudget;
 
 /**
  * Value class containing the options given to the sync engine
@@ -49,6 +50,12 @@ public:
     /** Create a virtual file for new files instead of downloading. May not be null */
     QSharedPointer<Vfs> _vfs;
 
+    /** Limits the active jobs of all syncs sharing the budget. May be null */
+    QSharedPointer<TransferBudget> _transferBudget;
+
+    /** The share of the budget this sync gets relative to the other syncs */
+    int _transferWeight = 1;
+
     /** The initial un-adjusted chunk size in bytes for chunked uploads, both
      * for old and new chunking algorithm, which classifies the item to be chunked
      *
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#include "syncplan.h"
+
+#include "common/utility.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace OCC {
+
+namespace {
+    bool transfersData(const SyncFileItem &item)
+    {
+        // copies on the server don't upload the file
+        if (item.isDirectory() || !item._copySource.isEmpty()) {
+            return false;
+        }
+        switch (item._instruction) {
+        case CSYNC_INSTRUCTION_NEW:
+        case CSYNC_INSTRUCTION_SYNC:
+        case CSYNC_INSTRUCTION_CONFLICT:
+        case CSYNC_INSTRUCTION_TYPE_CHANGE:
+            // placeholders are created without a download
+            return item._type != ItemTypeVirtualFile;
+        default:
+            return false;
+        }
+    }
+}
+
+SyncPlan SyncPlan::fromItems(const SyncFileItemSet &items)
+{
+    SyncPlan plan;
+    for (const auto &item : items) {
+        plan.addItem(*item);
+    }
+    return plan;
+}
+
+bool SyncPlan::isPlanned(const SyncFileItem &item)
+{
+    return item._instruction != CSYNC_INSTRUCTION_NONE && item._instruction != CSYNC_INSTRUCTION_UPDATE_METADATA;
+}
+
+void SyncPlan::addItem(const SyncFileItem &item)
+{
+    if (!isPlanned(item)) {
+        return;
+    }
+    ++_itemCount;
+    auto &operations = _operations[{ static_cast<SyncInstruction>(int(item._instruction)), item._direction }];
+    ++operations.count;
+    if (transfersData(item)) {
+        operations.bytes += item._size;
+        if (item._direction == SyncFileItem::Up) {
+            _uploadBytes += item._size;
+        } else if (item._direction == SyncFileItem::Down) {
+            _downloadBytes += item._size;
+        }
+    }
+}
+
+QJsonObject SyncPlan::toJson() const
+{
+    QJsonArray operations;
+    for (auto it = _operations.cbegin(); it != _operations.cend(); ++it) {
+        operations.append(QJsonObject {
+            { QStringLiteral("instruction"), instructionName(it.key().first) },
+            { QStringLiteral("direction"), Utility::enumToString(it.key().second) },
+            { QStringLiteral("count"), it->count },
+            { QStringLiteral("bytes"), it->bytes },
+        });
+    }
+    return {
+        { QStringLiteral("items"), _itemCount },
+        { QStringLiteral("uploadBytes"), _uploadBytes },
+        { QStringLiteral("downloadBytes"), _downloadBytes },
+        { QStringLiteral("operations"), operations },
+    };
+}
+
+QByteArray SyncPlan::itemToJson(const SyncFileItem &item)
+{
+    QJsonObject obj {
+        { QStringLiteral("path"), item._file },
+        { QStringLiteral("instruction"), instructionName(item._instruction) },
+        { QStringLiteral("direction"), Utility::enumToString(item._direction) },
+        { QStringLiteral("type"), Utility::enumToString(item._type) },
+        { QStringLiteral("size"), item._size },
+    };
+    if (item._file != item.destination()) {
+        obj.insert(QStringLiteral("destination"), item.destination());
+    }
+    if (!item._copySource.isEmpty()) {
+        obj.insert(QStringLiteral("copySource"), item._copySource);
+    }
+    if (!item._errorString.isEmpty()) {
+        obj.insert(QStringLiteral("error"), item._errorString);
+    }
+    return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+QString SyncPlan::instructionName(SyncInstructions instruction)
+{
+    static const auto prefix = QStringLiteral("CSYNC_INSTRUCTION_");
+    QString name = Utility::enumToString(static_cast<SyncInstruction>(int(instruction)));
+    if (name.startsWith(prefix)) {
+        name.remove(0, prefix.size());
+    }
+    return name.toLower();
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#pragma once
+
+#include "owncloudlib.h"
+#include "syncfileitem.h"
+
+#include <QJsonObject>
+#include <QMap>
+#include <QPair>
+
+namespace OCC {
+
+/**
+ * @brief Summary of the operations a sync would perform
+ *
+ * Created from the reconciled items of a plan-only sync, see
+ * SyncEngine::setPlanOnly().
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT SyncPlan
+{
+public:
+    struct Operations
+    {
+        qint64 count = 0;
+        qint64 bytes = 0;
+    };
+    using Key = QPair<SyncInstruction, SyncFileItem::Direction>;
+
+    static SyncPlan fromItems(const SyncFileItemSet &items);
+
+    /// Whether the item is part of the plan, items that are only updated in the journal are not
+    static bool isPlanned(const SyncFileItem &item);
+
+    void addItem(const SyncFileItem &item);
+
+    /// The operations by instruction and direction
+    const QMap<Key, Operations> &operations() const { return _operations; }
+
+    qint64 itemCount() const { return _itemCount; }
+    qint64 uploadBytes() const { return _uploadBytes; }
+    qint64 downloadBytes() const { return _downloadBytes; }
+
+    QJsonObject toJson() const;
+
+    /// A single line JSON object describing the item
+    static QByteArray itemToJson(const SyncFileItem &item);
+
+    /// The short name of the instruction, "new" for CSYNC_INSTRUCTION_NEW
+    static QString instructionName(SyncInstructions instruction);
+
+private:
+    QMap<Key, Operations> _operations;
+    qint64 _itemCount = 0;
+    qint64 _uploadBytes = 0;
+    qint64 _downloadBytes = 0;
+};
+
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#include "syncschedulingpolicy.h"
+
+#include "syncengine.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std::chrono_literals;
+
+namespace {
+// the time after which the influence of a change on the rate dropped to 1/e
+constexpr std::chrono::duration<double> rateTimeConstant = 10s;
+
+// limits the growth of the minimum sync interval
+constexpr int maxBackoff = 8;
+}
+
+namespace OCC {
+
+SyncSchedulingPolicy::SyncSchedulingPolicy()
+    : SyncSchedulingPolicy(SyncEngine::minimumFileAgeForUpload, 1min)
+{
+}
+
+SyncSchedulingPolicy::SyncSchedulingPolicy(std::chrono::milliseconds minimumDelay, std::chrono::milliseconds maximumDelay)
+    : _minimumDelay(minimumDelay)
+    , _maximumDelay(std::max(minimumDelay, maximumDelay))
+{
+}
+
+void SyncSchedulingPolicy::addChange(Clock::time_point now)
+{
+    _changeRate = changeRate(now) + 1.0 / rateTimeConstant.count();
+    _lastChange = std::max(_lastChange, now);
+    ++_changeCount;
+}
+
+bool SyncSchedulingPolicy::requestSync(Clock::time_point now)
+{
+    if (_pending) {
+        ++_avoidedSyncs;
+        return false;
+    }
+    _pending = true;
+    _firstPendingRequest = now;
+    return true;
+}
+
+std::chrono::milliseconds SyncSchedulingPolicy::delay(Clock::time_point now) const
+{
+    if (!_pending) {
+        return 0ms;
+    }
+
+    // wait for a quiet period that grows with the change rate
+    const auto quietPeriod = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::duration<double, std::milli>(_minimumDelay) * (1.0 + changeRate(now)));
+    auto due = _firstPendingRequest + _minimumDelay;
+    if (_changeCount > 0) {
+        // but don't let constant changes postpone the sync indefinitely
+        due = std::max(due, std::min(_lastChange + std::min(quietPeriod, _maximumDelay), _firstPendingRequest + _maximumDelay));
+    }
+    if (_hasSynced) {
+        due = std::max(due, _lastSyncStart + minimumSyncInterval());
+    }
+    return std::max(0ms, std::chrono::duration_cast<std::chrono::milliseconds>(due - now));
+}
+
+void SyncSchedulingPolicy::syncScheduled()
+{
+    _pending = false;
+}
+
+void SyncSchedulingPolicy::syncStarted(Clock::time_point now)
+{
+    if (_pending) {
+        // the sync that was started for a different reason will pick up the changes
+        _pending = false;
+        ++_avoidedSyncs;
+    }
+    if (isBusy(now)) {
+        _backoff = std::min(_backoff + 1, maxBackoff);
+    } else {
+        _backoff = 0;
+    }
+    _lastSyncStart = now;
+    _hasSynced = true;
+}
+
+double SyncSchedulingPolicy::changeRate(Clock::time_point now) const
+{
+    if (_changeCount == 0) {
+        return 0;
+    }
+    const std::chrono::duration<double> elapsed = std::max(Clock::duration::zero(), now - _lastChange);
+    return _changeRate * std::exp(-elapsed / rateTimeConstant);
+}
+
+std::chrono::milliseconds SyncSchedulingPolicy::minimumSyncInterval() const
+{
+    if (_backoff == 0) {
+        return 0ms;
+    }
+    return std::min(_maximumDelay, _minimumDelay * ((1 << _backoff) - 1));
+}
+
+} // namespace OCC
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QtGlobal>
+
+#include <chrono>
+
+namespace OCC {
+
+/**
+ * @brief Decides when a folder should be synced after local changes
+ *
+ * The folder watcher reports every write. For folders where tools write
+ * constantly (build directories, caches) a fixed delay results in
+ * back-to-back syncs that each run discovery again.
+ *
+ * This policy is notified about
+ * - changes reported by the folder watcher (addChange())
+ * - requests to sync the folder soon (requestSync())
+ * - the pending request being handed to the FolderMan (syncScheduled())
+ * - starting syncs (syncStarted())
+ *
+ * It keeps an exponentially decaying change rate and uses it to
+ * - wait for a quiet period that grows with the change rate, but never
+ *   longer than maximumDelay() after the first pending change
+ * - increase the minimum interval between two syncs while the folder
+ *   stays busy
+ *
+ * Requests that are coalesced into an already pending or started sync are
+ * counted in avoidedSyncs().
+ *
+ * All methods take the current time as an argument to keep the class
+ * deterministic for testing purposes.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT SyncSchedulingPolicy
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** Changes per second above which a folder is considered busy */
+    static constexpr double busyChangeRate = 0.5;
+
+    /** The default minimum delay is SyncEngine::minimumFileAgeForUpload */
+    SyncSchedulingPolicy();
+    SyncSchedulingPolicy(std::chrono::milliseconds minimumDelay, std::chrono::milliseconds maximumDelay);
+
+    std::chrono::milliseconds minimumDelay() const { return _minimumDelay; }
+    std::chrono::milliseconds maximumDelay() const { return _maximumDelay; }
+
+    /** A change was reported by the folder watcher */
+    void addChange(Clock::time_point now);
+
+    /** Request a sync of the folder after a delay.
+     *
+     * Returns false if a sync was already pending and the request was
+     * coalesced into it.
+     */
+    bool requestSync(Clock::time_point now);
+
+    /** Whether a requested sync has not been handed to the FolderMan yet */
+    bool hasPendingSync() const { return _pending; }
+
+    /** The time to wait before the pending sync should be scheduled */
+    std::chrono::milliseconds delay(Clock::time_point now) const;
+
+    /** The pending sync was handed to the FolderMan */
+    void syncScheduled();
+
+    /** Call when a sync run starts, a pending request is satisfied by it */
+    void syncStarted(Clock::time_point now);
+
+    /** The decayed number of changes per second */
+    double changeRate(Clock::time_point now) const;
+
+    bool isBusy(Clock::time_point now) const { return changeRate(now) >= busyChangeRate; }
+
+    /** The minimum interval between two syncs, grows while the folder stays busy */
+    std::chrono::milliseconds minimumSyncInterval() const;
+
+    /** The number of sync requests that were coalesced with other syncs */
+    qint64 avoidedSyncs() const { return _avoidedSyncs; }
+
+    /** The number of changes reported through addChange() */
+    qint64 changeCount() const { return _changeCount; }
+
+private:
+    std::chrono::milliseconds _minimumDelay;
+    std::chrono::milliseconds _maximumDelay;
+
+    double _changeRate = 0;
+    Clock::time_point _lastChange;
+    Clock::time_point _firstPendingRequest;
+    Clock::time_point _lastSyncStart;
+    bool _hasSynced = false;
+    bool _pending = false;
+
+    /// Number of consecutive syncs that started while the folder was busy
+    int _backoff = 0;
+
+    qint64 _avoidedSyncs = 0;
+    qint64 _changeCount = 0;
+};
+
+} // namespace OCC
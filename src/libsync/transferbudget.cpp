@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#include "transferbudget.h"
+
+#include "account.h"
+#include "owncloudpropagator.h"
+
+#include <QLoggingCategory>
+
+#include <algorithm>
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcTransferBudget, "sync.transferbudget", QtInfoMsg)
+
+TransferBudget::TransferBudget(int maximumActiveJobs, QObject *parent)
+    : QObject(parent)
+    , _maximumActiveJobs(qMax(1, maximumActiveJobs))
+{
+}
+
+int TransferBudget::maximumActiveJobs() const
+{
+    return _maximumActiveJobs;
+}
+
+void TransferBudget::setMaximumActiveJobs(int maximumActiveJobs)
+{
+    _maximumActiveJobs = qMax(1, maximumActiveJobs);
+    wakeWaiting();
+}
+
+int TransferBudget::maximumActiveJobsPerHost() const
+{
+    return _maximumActiveJobsPerHost;
+}
+
+void TransferBudget::setMaximumActiveJobsPerHost(int maximumActiveJobsPerHost)
+{
+    _maximumActiveJobsPerHost = qMax(0, maximumActiveJobsPerHost);
+    wakeWaiting();
+}
+
+int TransferBudget::activeJobs() const
+{
+    int out = 0;
+    for (const auto &p : _propagators) {
+        if (p) {
+            out += p->_activeJobList.count();
+        }
+    }
+    return out;
+}
+
+int TransferBudget::activeJobs(const QString &host) const
+{
+    int out = 0;
+    for (const auto &p : _propagators) {
+        if (p && TransferBudget::host(p) == host) {
+            out += p->_activeJobList.count();
+        }
+    }
+    return out;
+}
+
+int TransferBudget::waitingPropagators() const
+{
+    return static_cast<int>(std::count_if(_waiting.cbegin(), _waiting.cend(), [](const auto &p) { return !p.isNull(); }));
+}
+
+void TransferBudget::registerPropagator(OwncloudPropagator *propagator, int weight)
+{
+    if (!_propagators.contains(propagator)) {
+        _propagators.append(propagator);
+    }
+    _weights.insert(propagator, qMax(1, weight));
+}
+
+void TransferBudget::unregisterPropagator(OwncloudPropagator *propagator)
+{
+    _propagators.removeAll(propagator);
+    _waiting.removeAll(propagator);
+    _weights.remove(propagator);
+    // its slots are free now
+    wakeWaiting();
+}
+
+bool TransferBudget::tryAcquire(OwncloudPropagator *propagator)
+{
+    _waiting.removeAll(nullptr);
+    if (!isHostSaturated(propagator)) {
+        // the slots needed by the propagators served before us
+        const auto servedBefore = std::count_if(_waiting.cbegin(), _waiting.cend(), [propagator, this](const auto &p) {
+            return p != propagator && !isHostSaturated(p) && isServedBefore(p, propagator);
+        });
+        if (activeJobs() + servedBefore < _maximumActiveJobs) {
+            _waiting.removeAll(propagator);
+            return true;
+        }
+    }
+    if (!_waiting.contains(propagator)) {
+        qCDebug(lcTransferBudget) << "No free transfer slot, queueing" << propagator << "active jobs:" << activeJobs();
+        _waiting.append(propagator);
+    }
+    return false;
+}
+
+void TransferBudget::wakeWaiting()
+{
+    _waiting.removeAll(nullptr);
+    int free = _maximumActiveJobs - activeJobs();
+    if (free <= 0) {
+        return;
+    }
+    auto waiting = _waiting;
+    std::sort(waiting.begin(), waiting.end(), [this](const auto &a, const auto &b) { return isServedBefore(a, b); });
+    for (const auto &p : qAsConst(waiting)) {
+        if (free == 0) {
+            break;
+        }
+        if (!isHostSaturated(p)) {
+            p->scheduleNextJob();
+            --free;
+        }
+    }
+}
+
+QString TransferBudget::host(OwncloudPropagator *propagator)
+{
+    return propagator->account()->url().host();
+}
+
+bool TransferBudget::isHostSaturated(OwncloudPropagator *propagator) const
+{
+    return _maximumActiveJobsPerHost > 0 && activeJobs(host(propagator)) >= _maximumActiveJobsPerHost;
+}
+
+bool TransferBudget::isServedBefore(OwncloudPropagator *a, OwncloudPropagator *b) const
+{
+    // compare the active jobs per weight without dividing
+    const qint64 aShare = qint64(a->_activeJobList.count()) * _weights.value(b, 1);
+    const qint64 bShare = qint64(b->_activeJobList.count()) * _weights.value(a, 1);
+    if (aShare != bShare) {
+        return aShare < bShare;
+    }
+    // propagators that aren't waiting come last
+    const auto waitingIndex = [this](OwncloudPropagator *p) {
+        const int index = _waiting.indexOf(p);
+        return index == -1 ? _waiting.size() : index;
+    };
+    return waitingIndex(a) < waitingIndex(b);
+}
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) by Hannah von Reth <hannah.vonreth@owncloud.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+
+namespace OCC {
+
+class OwncloudPropagator;
+
+/**
+ * @brief Limits the number of active jobs of several concurrently running propagators
+ *
+ * Each propagator still applies its own limits, the budget only decides whether
+ * there is room left for another job in total and on the server of the propagator.
+ *
+ * Freed slots are shared by weight: the waiting propagator with the fewest active
+ * jobs per weight is served first, ties are served in the order they started waiting.
+ * A propagator doesn't get a freed slot while others are waiting before it.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT TransferBudget : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TransferBudget(int maximumActiveJobs, QObject *parent = nullptr);
+
+    int maximumActiveJobs() const;
+    void setMaximumActiveJobs(int maximumActiveJobs);
+
+    /// The maximal number of active jobs on one host, 0 means no limit
+    int maximumActiveJobsPerHost() const;
+    void setMaximumActiveJobsPerHost(int maximumActiveJobsPerHost);
+
+    /// The number of active jobs of all registered propagators
+    int activeJobs() const;
+
+    /// The number of active jobs of the registered propagators syncing with host
+    int activeJobs(const QString &host) const;
+
+    /// The number of propagators waiting for a free slot
+    int waitingPropagators() const;
+
+    /// A propagator with weight 2 gets twice the slots of one with weight 1 if both are waiting
+    void registerPropagator(OwncloudPropagator *propagator, int weight = 1);
+    void unregisterPropagator(OwncloudPropagator *propagator);
+
+    /**
+     * Returns whether propagator may start another job.
+     * If not, the propagator is queued and will be rescheduled once a slot is available.
+     */
+    bool tryAcquire(OwncloudPropagator *propagator);
+
+    /// Reschedules waiting propagators if there are free slots
+    void wakeWaiting();
+
+private:
+    static QString host(OwncloudPropagator *propagator);
+    bool isHostSaturated(OwncloudPropagator *propagator) const;
+    /// Whether a is served before b
+    bool isServedBefore(OwncloudPropagator *a, OwncloudPropagator *b) const;
+
+    int _maximumActiveJobs;
+    int _maximumActiveJobsPerHost = 0;
+    QList<QPointer<OwncloudPropagator>> _propagators;
+    QHash<OwncloudPropagator *, int> _weights;
+    QList<QPointer<OwncloudPropagator>> _waiting;
+};
+}
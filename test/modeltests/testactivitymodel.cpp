@@ -7,10 +7,12 @@
  */
 
 #include "gui/models/activitylistmodel.h"
+#include "gui/activitystore.h"
 #include "gui/accountmanager.h"
 
 #include "testutils/testutils.h"
 
+#include <QSignalSpy>
 #include <QTest>
 #include <QAbstractItemModelTester>
 
@@ -42,6 +44,47 @@ private Q_SLOTS:
         });
         model->slotRemoveAccount(AccountManager::instance()->accounts().first());
     }
+
+    void testMerge()
+    {
+        auto model = new ActivityListModel(this);
+
+        new QAbstractItemModelTester(model, this);
+
+        auto acc1 = TestUtils::createDummyAccount();
+        auto acc2 = TestUtils::createDummyAccount();
+        const auto ast1 = AccountManager::instance()->account(acc1->uuid());
+        const auto ast2 = AccountManager::instance()->account(acc2->uuid());
+
+        const auto activities = [](const AccountPtr &acc, Activity::Identifier first, Activity::Identifier last) {
+            ActivityList out;
+            for (auto id = last; id >= first; --id) {
+                out.append(Activity { Activity::ActivityType, id, acc, "test", "test", "foo.cpp", QUrl::fromUserInput("https://owncloud.com"), QDateTime::currentDateTime() });
+            }
+            return out;
+        };
+
+        QSignalSpy resetSpy(model, &QAbstractItemModel::modelReset);
+        QSignalSpy insertSpy(model, &QAbstractItemModel::rowsInserted);
+
+        model->mergeActivities(ast1, activities(acc1, 1, 3));
+        model->mergeActivities(ast2, activities(acc2, 1, 2));
+        model->mergeActivities(ast1, activities(acc1, 4, 5));
+        QCOMPARE(model->rowCount(), 7);
+        QCOMPARE(model->activityList().first().id(), Activity::Identifier(5));
+        QCOMPARE(model->_activityLists[ast1].first().id(), Activity::Identifier(5));
+        QCOMPARE(model->_activityLists[ast1].last().id(), Activity::Identifier(1));
+        QCOMPARE(insertSpy.count(), 3);
+        QCOMPARE(resetSpy.count(), 0);
+
+        // only the newest activities of an account are kept
+        model->mergeActivities(ast1, activities(acc1, 6, ActivityStore::MaxActivities + 2));
+        QCOMPARE(model->_activityLists[ast1].size(), ActivityStore::MaxActivities);
+        QCOMPARE(model->_activityLists[ast1].last().id(), Activity::Identifier(3));
+        QCOMPARE(model->_activityLists[ast2].size(), 2);
+        QCOMPARE(model->rowCount(), ActivityStore::MaxActivities + 2);
+        QCOMPARE(resetSpy.count(), 0);
+    }
 };
 }
 
@@ -13,6 +13,7 @@
 
 #include "testutils/testutils.h"
 
+#include <QSignalSpy>
 #include <QTest>
 #include <QAbstractItemModelTester>
 #include <folder.h>
@@ -99,6 +100,161 @@ private Q_SLOTS:
             QCOMPARE(model->protocolItem(model->index(i, 0)).folder(), copy[i].folder());
         }
     }
+
+    void testBatchInsertAndFolderRemoval()
+    {
+        auto model = new ProtocolItemModel(100, false, this);
+
+        new QAbstractItemModelTester(model, this);
+
+        auto dir = TestUtils::createTempDir();
+        auto account = TestUtils::createDummyAccount();
+        AccountStatePtr newAccountState = AccountState::fromNewAccount(account);
+        const QDir d(dir.path());
+        QVERIFY(d.mkdir("foo"));
+        QVERIFY(d.mkdir("bar"));
+        auto foo = TestUtils::folderMan()->addFolder(newAccountState, TestUtils::createDummyFolderDefinition(newAccountState->account(), dir.path() + QStringLiteral("/foo")));
+        auto bar = TestUtils::folderMan()->addFolder(newAccountState, TestUtils::createDummyFolderDefinition(newAccountState->account(), dir.path() + QStringLiteral("/bar")));
+        QVERIFY(foo);
+        QVERIFY(bar);
+
+        QSignalSpy insertSpy(model, &ProtocolItemModel::rowsInserted);
+        QSignalSpy removeSpy(model, &ProtocolItemModel::rowsRemoved);
+        QSignalSpy resetSpy(model, &ProtocolItemModel::modelReset);
+
+        // insert more items than the model can hold, alternating between the folders
+        auto item = SyncFileItemPtr::create();
+        std::vector<ProtocolItem> batch;
+        for (int i = 0; i < 150; ++i) {
+            item->_file = QString::number(i);
+            batch.emplace_back(i % 2 ? bar : foo, item);
+        }
+        model->addProtocolItems(std::move(batch));
+        QCOMPARE(insertSpy.count(), 1);
+        QCOMPARE(model->rowCount(), 100);
+        // the oldest items were dropped
+        QCOMPARE(model->protocolItem(model->index(0, 0)).path(), QStringLiteral("50"));
+
+        // overflowing the full model removes the oldest rows in one go
+        batch.clear();
+        for (int i = 150; i < 160; ++i) {
+            item->_file = QString::number(i);
+            batch.emplace_back(i % 2 ? bar : foo, item);
+        }
+        model->addProtocolItems(std::move(batch));
+        QCOMPARE(insertSpy.count(), 2);
+        QCOMPARE(removeSpy.count(), 1);
+        QCOMPARE(model->protocolItem(model->index(0, 0)).path(), QStringLiteral("60"));
+
+        int fooItems = 0;
+        model->forEachItem(foo, [&](const ProtocolItem &pi) {
+            QCOMPARE(pi.folder(), foo);
+            ++fooItems;
+        });
+        QCOMPARE(fooItems, 50);
+
+        // a contiguous block of foo is removed with a single notification
+        removeSpy.clear();
+        model->remove_if(bar, [](const ProtocolItem &) { return false; });
+        QCOMPARE(removeSpy.count(), 0);
+        model->remove_if(foo, [](const ProtocolItem &pi) { return pi.path().toInt() >= 150; });
+        QCOMPARE(removeSpy.count(), 5);
+        QCOMPARE(resetSpy.count(), 0);
+        QCOMPARE(model->rowCount(), 95);
+
+        // removing all items of a folder is too fragmented for notifications per row
+        model->remove_if(foo, [](const ProtocolItem &) { return true; });
+        QCOMPARE(resetSpy.count(), 1);
+        QCOMPARE(model->rowCount(), 50);
+        for (int i = 0; i < model->rowCount(); ++i) {
+            const auto &pi = model->protocolItem(model->index(i, 0));
+            QCOMPARE(pi.folder(), bar);
+            QCOMPARE(pi.path(), QString::number(61 + 2 * i));
+        }
+        fooItems = 0;
+        model->forEachItem(foo, [&](const ProtocolItem &) { ++fooItems; });
+        QCOMPARE(fooItems, 0);
+    }
+
+    void testQueuedItems()
+    {
+        auto model = new ProtocolItemModel(100, false, this);
+
+        new QAbstractItemModelTester(model, this);
+
+        auto dir = TestUtils::createTempDir();
+        auto account = TestUtils::createDummyAccount();
+        AccountStatePtr newAccountState = AccountState::fromNewAccount(account);
+        const QDir d(dir.path());
+        QVERIFY(d.mkdir("foo"));
+        auto foo = TestUtils::folderMan()->addFolder(newAccountState, TestUtils::createDummyFolderDefinition(newAccountState->account(), dir.path() + QStringLiteral("/foo")));
+        QVERIFY(foo);
+
+        QSignalSpy insertSpy(model, &ProtocolItemModel::rowsInserted);
+        auto item = SyncFileItemPtr::create();
+        const auto queue = [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                item->_file = QString::number(i);
+                model->queueProtocolItem(ProtocolItem { foo, item });
+            }
+        };
+
+        // queued items are added in one batch after a delay
+        queue(0, 10);
+        QCOMPARE(model->rowCount(), 0);
+        QTRY_COMPARE(model->rowCount(), 10);
+        QCOMPARE(insertSpy.count(), 1);
+
+        // or right away when flushed
+        queue(10, 20);
+        model->flushQueuedItems();
+        QCOMPARE(model->rowCount(), 20);
+        QCOMPARE(insertSpy.count(), 2);
+
+        // the queued items are added before items are removed
+        queue(20, 30);
+        model->remove_if(foo, [](const ProtocolItem &pi) { return pi.path().toInt() >= 15; });
+        QCOMPARE(model->rowCount(), 15);
+        QCOMPARE(insertSpy.count(), 3);
+    }
+
+    void testBenchmarkManyItems()
+    {
+        // push 100k items through a model the size of the issues view and purge folders,
+        // similar to what happens on each sync of a folder with many errors
+        auto dir = TestUtils::createTempDir();
+        auto account = TestUtils::createDummyAccount();
+        AccountStatePtr newAccountState = AccountState::fromNewAccount(account);
+        const QDir d(dir.path());
+        std::vector<Folder *> folders;
+        for (int i = 0; i < 10; ++i) {
+            const auto name = QStringLiteral("folder%1").arg(i);
+            QVERIFY(d.mkdir(name));
+            folders.push_back(TestUtils::folderMan()->addFolder(newAccountState, TestUtils::createDummyFolderDefinition(newAccountState->account(), dir.filePath(name))));
+            QVERIFY(folders.back());
+        }
+
+        auto model = new ProtocolItemModel(20000, true, this);
+        auto item = SyncFileItemPtr::create();
+        item->_status = SyncFileItem::NormalError;
+        QBENCHMARK {
+            for (int batch = 0; batch < 100; ++batch) {
+                std::vector<ProtocolItem> items;
+                items.reserve(1000);
+                for (int i = 0; i < 1000; ++i) {
+                    item->_file = QString::number(batch * 1000 + i);
+                    items.emplace_back(folders[(batch + i / 100) % folders.size()], item);
+                }
+                model->addProtocolItems(std::move(items));
+                if (batch % 10 == 9) {
+                    model->remove_if(folders[batch % folders.size()], [](const ProtocolItem &pi) {
+                        return pi.path().toInt() % 2;
+                    });
+                }
+            }
+        }
+        QVERIFY(model->rowCount() <= 20000);
+    }
 };
 }
 
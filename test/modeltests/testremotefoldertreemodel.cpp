@@ -0,0 +1,118 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "gui/models/remotefoldertreemodel.h"
+
+#include "testutils/syncenginetestutils.h"
+#include "testutils/testutils.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+namespace OCC {
+
+class TestRemoteFolderTreeModel : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testPagingAndBlackList()
+    {
+        // the model filters hidden folders based on the FolderMan settings
+        TestUtils::folderMan();
+
+        FakeFolder fakeFolder { FileInfo {} };
+        const int folderCount = RemoteFolderTreeModel::pageSize * 2 + 10;
+        for (int i = 0; i < folderCount; ++i) {
+            fakeFolder.remoteModifier().mkdir(QStringLiteral("dir%1").arg(i));
+        }
+        fakeFolder.remoteModifier().mkdir(QStringLiteral("dir1/sub1"));
+        fakeFolder.remoteModifier().mkdir(QStringLiteral("dir1/sub2"));
+
+        RemoteFolderTreeModel model(fakeFolder.account(), QStringLiteral("/"), QStringLiteral("/"), { QStringLiteral("dir2/"), QStringLiteral("dir2/foo/"), QStringLiteral("dir1/sub1/") }, nullptr);
+        QSignalSpy loaded(&model, &RemoteFolderTreeModel::loaded);
+        model.load();
+        QVERIFY(loaded.wait());
+        QCOMPARE(loaded.first().first().toBool(), true);
+
+        // the folders are handed out in pages
+        const auto root = model.index(0, 0);
+        QCOMPARE(model.rowCount(root), RemoteFolderTreeModel::pageSize);
+        QVERIFY(model.canFetchMore(root));
+        model.fetchMore(root);
+        QCOMPARE(model.rowCount(root), RemoteFolderTreeModel::pageSize * 2);
+        model.fetchMore(root);
+        QCOMPARE(model.rowCount(root), folderCount);
+        QVERIFY(!model.canFetchMore(root));
+
+        // natural sort order
+        QCOMPARE(model.index(2, 0, root).data().toString(), QStringLiteral("dir2"));
+        QCOMPARE(model.index(10, 0, root).data().toString(), QStringLiteral("dir10"));
+
+        // the check states are derived from the old blacklist, redundant entries are dropped
+        const auto checkState = [](const QModelIndex &index) {
+            return static_cast<Qt::CheckState>(index.data(Qt::CheckStateRole).toInt());
+        };
+        const auto dir1 = model.index(1, 0, root);
+        QCOMPARE(checkState(root), Qt::PartiallyChecked);
+        QCOMPARE(checkState(dir1), Qt::PartiallyChecked);
+        QCOMPARE(checkState(model.index(2, 0, root)), Qt::Unchecked);
+        QCOMPARE(checkState(model.index(3, 0, root)), Qt::Checked);
+        QCOMPARE(model.createBlackList(), QStringList({ QStringLiteral("dir1/sub1/"), QStringLiteral("dir2/") }));
+
+        // sub folders are listed on demand
+        QVERIFY(model.canFetchMore(dir1));
+        model.fetchMore(dir1);
+        QTRY_COMPARE(model.rowCount(dir1), 2);
+        const auto sub1 = model.index(0, 0, dir1);
+        const auto sub2 = model.index(1, 0, dir1);
+        QCOMPARE(checkState(sub1), Qt::Unchecked);
+        QCOMPARE(checkState(sub2), Qt::Checked);
+
+        QVERIFY(model.setData(sub1, Qt::Checked, Qt::CheckStateRole));
+        QCOMPARE(checkState(dir1), Qt::Checked);
+        QCOMPARE(model.createBlackList(), QStringList({ QStringLiteral("dir2/") }));
+
+        QVERIFY(model.setData(dir1, Qt::Unchecked, Qt::CheckStateRole));
+        QCOMPARE(checkState(sub1), Qt::Unchecked);
+        QCOMPARE(checkState(sub2), Qt::Unchecked);
+        QCOMPARE(model.createBlackList(), QStringList({ QStringLiteral("dir1/"), QStringLiteral("dir2/") }));
+
+        // checking a child of an excluded folder excludes its siblings instead
+        QVERIFY(model.setData(sub2, Qt::Checked, Qt::CheckStateRole));
+        QCOMPARE(checkState(dir1), Qt::PartiallyChecked);
+        QCOMPARE(checkState(sub1), Qt::Unchecked);
+        QCOMPARE(model.createBlackList(), QStringList({ QStringLiteral("dir1/sub1/"), QStringLiteral("dir2/") }));
+
+        // the root can't be unchecked, all top level folders are excluded instead
+        QVERIFY(model.setData(root, Qt::Unchecked, Qt::CheckStateRole));
+        QCOMPARE(checkState(root), Qt::PartiallyChecked);
+        QCOMPARE(model.createBlackList().size(), folderCount);
+        QVERIFY(model.setData(root, Qt::Checked, Qt::CheckStateRole));
+        QCOMPARE(checkState(root), Qt::Checked);
+        QVERIFY(model.createBlackList().isEmpty());
+    }
+
+    void testExpandRootBlackList()
+    {
+        TestUtils::folderMan();
+
+        FakeFolder fakeFolder { FileInfo::A12_B12_C12_S12() };
+        RemoteFolderTreeModel model(fakeFolder.account(), QStringLiteral("/"), QStringLiteral("/"), { QStringLiteral("/") }, nullptr);
+        QSignalSpy loaded(&model, &RemoteFolderTreeModel::loaded);
+        model.load();
+        QVERIFY(loaded.wait());
+
+        const QStringList expected { QStringLiteral("A/"), QStringLiteral("B/"), QStringLiteral("C/"), QStringLiteral("S/") };
+        QCOMPARE(model.oldBlackList(), expected);
+        QCOMPARE(model.createBlackList(), expected);
+    }
+};
+}
+
+QTEST_MAIN(OCC::TestRemoteFolderTreeModel)
+#include "testremotefoldertreemodel.moc"
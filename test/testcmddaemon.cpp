@@ -0,0 +1,86 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "cmd/cmddaemon.h"
+
+#include "testutils/syncenginetestutils.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QTest>
+
+using namespace OCC;
+
+class TestCmdDaemon : public QObject
+{
+    Q_OBJECT
+
+    // Sends the chunks one after the other and collects everything until the daemon disconnects
+    static void request(const QString &serverName, const QList<QByteArray> &chunks, QByteArray *reply)
+    {
+        QLocalSocket socket;
+        connect(&socket, &QLocalSocket::readyRead, &socket, [&socket, reply] { reply->append(socket.readAll()); });
+        socket.connectToServer(serverName);
+        QTRY_COMPARE(socket.state(), QLocalSocket::ConnectedState);
+        for (int i = 0; i < chunks.size(); ++i) {
+            socket.write(chunks.at(i));
+            socket.flush();
+            if (i < chunks.size() - 1) {
+                // the daemon waits for the end of the line
+                QTest::qWait(100);
+                QCOMPARE(socket.state(), QLocalSocket::ConnectedState);
+                QVERIFY(reply->isEmpty());
+            }
+        }
+        QTRY_COMPARE(socket.state(), QLocalSocket::UnconnectedState);
+        reply->append(socket.readAll());
+    }
+
+private Q_SLOTS:
+    void testStatusProtocol()
+    {
+        FakeFolder fakeFolder { FileInfo::A12_B12_C12_S12() };
+
+        CmdDaemon::Settings settings;
+        settings.folders.append({ fakeFolder.localPath(), QString() });
+        settings.socketName = QStringLiteral("testcmddaemon-%1").arg(QCoreApplication::applicationPid());
+        CmdDaemon daemon(fakeFolder.account(), fakeFolder.account()->davUrl(), settings, [](SyncEngine *) {});
+        QVERIFY(daemon.start());
+
+        // a command split over several writes
+        QByteArray reply;
+        request(settings.socketName, { QByteArrayLiteral("sta"), QByteArrayLiteral("tus\n") }, &reply);
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+        const auto folders = QJsonDocument::fromJson(reply).object().value(QStringLiteral("folders")).toArray();
+        QCOMPARE(folders.size(), 1);
+        QCOMPARE(folders.at(0).toObject().value(QStringLiteral("localPath")).toString(), fakeFolder.localPath());
+
+        reply.clear();
+        request(settings.socketName, { QByteArrayLiteral("foo\n") }, &reply);
+        QVERIFY(reply.startsWith("unknown command"));
+
+        // the startup sync is reported once it is done
+        const QByteArray syncs = "owncloudcmd_syncs_total{folder=\"" + fakeFolder.localPath().toUtf8() + "\"} 1\n";
+        for (int i = 0; i < 50 && !reply.contains(syncs); ++i) {
+            reply.clear();
+            request(settings.socketName, { QByteArrayLiteral("metrics\n") }, &reply);
+            if (QTest::currentTestFailed()) {
+                return;
+            }
+            QVERIFY(reply.contains("owncloudcmd_uptime_seconds "));
+            QTest::qWait(100);
+        }
+        QVERIFY(reply.contains(syncs));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestCmdDaemon)
+#include "testcmddaemon.moc"
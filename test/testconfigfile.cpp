@@ -0,0 +1,57 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "configfile.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+using namespace OCC;
+
+class TestConfigFile : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testSnapshot()
+    {
+        ConfigFile cfg;
+        QSignalSpy changedSpy(ConfigFileNotifier::instance(), &ConfigFileNotifier::changed);
+        QSignalSpy networkLimitsSpy(ConfigFileNotifier::instance(), &ConfigFileNotifier::networkLimitsChanged);
+
+        cfg.setUploadLimit(42);
+        QCOMPARE(ConfigFile().uploadLimit(), 42);
+        QCOMPARE(changedSpy.count(), 1);
+        QCOMPARE(changedSpy.first().first().toString(), QStringLiteral("BWLimit/uploadLimit"));
+        QCOMPARE(networkLimitsSpy.count(), 1);
+
+        // the value is written to the file
+        QCOMPARE(ConfigFile::makeQSettings().value(QStringLiteral("BWLimit/uploadLimit")).toInt(), 42);
+
+        // writing the same value again changes nothing
+        cfg.setUploadLimit(42);
+        QCOMPARE(changedSpy.count(), 1);
+
+        cfg.setPromptDeleteFiles(false);
+        QVERIFY(!cfg.promptDeleteFiles());
+        QCOMPARE(changedSpy.count(), 2);
+        QCOMPARE(networkLimitsSpy.count(), 1);
+
+        // values written around ConfigFile are read after a reload
+        {
+            auto settings = ConfigFile::makeQSettings();
+            settings.setValue(QStringLiteral("BWLimit/uploadLimit"), 7);
+        }
+        QCOMPARE(cfg.uploadLimit(), 42);
+        ConfigFile::reload();
+        QCOMPARE(cfg.uploadLimit(), 7);
+        QVERIFY(!cfg.promptDeleteFiles());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestConfigFile)
+#include "testconfigfile.moc"
@@ -6,6 +6,7 @@
  */
 
 
+#include "filesystem.h"
 #include "owncloudpropagator.h"
 #include "syncengine.h"
 #include "testutils/syncenginetestutils.h"
@@ -370,6 +371,26 @@ private slots:
             QVERIFY(getItem(completeSpy, "A/resendme")->_errorString.contains(serverMessage));
         }
     }
+
+    void testPreallocate()
+    {
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        QCOMPARE(file.write("0123456789"), qint64(10));
+        QVERIFY(file.flush());
+
+        const auto result = FileSystem::preallocate(file, 10, 1024 * 1024);
+        if (result == FileSystem::PreallocateResult::Unsupported) {
+            QSKIP("The file system can't preallocate");
+        }
+        QCOMPARE(result, FileSystem::PreallocateResult::Ok);
+
+        // the size is used to resume downloads, it must not change
+        QCOMPARE(file.size(), qint64(10));
+        QCOMPARE(file.write("a"), qint64(1));
+        QVERIFY(file.flush());
+        QCOMPARE(file.size(), qint64(11));
+    }
 };
 
 QTEST_GUILESS_MAIN(TestDownload)
@@ -0,0 +1,132 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "imagecache.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace OCC;
+
+class TestImageCache : public QObject
+{
+    Q_OBJECT
+
+    static QByteArray png(const QSize &size)
+    {
+        QImage image(size, QImage::Format_ARGB32);
+        image.fill(Qt::red);
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "PNG");
+        return data;
+    }
+
+    // waits for the callback of an image that isn't in memory
+    static QPixmap lookup(ImageCache &cache, const ImageCache::Key &key)
+    {
+        QPixmap out;
+        bool done = false;
+        QObject context;
+        cache.lookup(key, &context, [&](const QPixmap &pixmap) {
+            out = pixmap;
+            done = true;
+        });
+        if (!QTest::qWaitFor([&] { return done; })) {
+            qWarning() << "lookup timed out";
+        }
+        return out;
+    }
+
+private Q_SLOTS:
+    void testLookup()
+    {
+        QTemporaryDir dir;
+        const ImageCache::Key key { QStringLiteral("fileid"), "etag1", QSize(64, 64) };
+        {
+            ImageCache cache(dir.path());
+            QVERIFY(lookup(cache, key).isNull());
+
+            // images are scaled down to the requested size
+            cache.insert(key, png(QSize(128, 32)));
+            QCOMPARE(lookup(cache, key).size(), QSize(64, 16));
+            QCOMPARE(cache.statistics().memoryHits, qint64(0));
+            QCOMPARE(lookup(cache, key).size(), QSize(64, 16));
+            QCOMPARE(cache.statistics().memoryHits, qint64(1));
+            QTRY_COMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 1);
+
+            // another etag or size is another image
+            QVERIFY(lookup(cache, { key.id, "etag2", key.size }).isNull());
+            QVERIFY(lookup(cache, { key.id, key.etag, QSize(32, 32) }).isNull());
+        }
+
+        // the data is kept on disk
+        ImageCache cache(dir.path());
+        QCOMPARE(lookup(cache, key).size(), QSize(64, 16));
+        QCOMPARE(cache.statistics().diskHits, qint64(1));
+        QCOMPARE(cache.statistics().memoryHits, qint64(0));
+        lookup(cache, key);
+        QCOMPARE(cache.statistics().memoryHits, qint64(1));
+    }
+
+    void testEviction()
+    {
+        QTemporaryDir dir;
+        const auto data = png(QSize(16, 16));
+        // room for three images
+        ImageCache cache(dir.path(), data.size() * 3 + 1);
+        const auto key = [](int i) {
+            return ImageCache::Key { QString::number(i), "etag", QSize(16, 16) };
+        };
+        for (int i = 0; i < 3; ++i) {
+            cache.insert(key(i), data);
+            QTest::qWait(5);
+        }
+        QCOMPARE(cache.diskSize(), qint64(data.size()) * 3);
+        QTRY_COMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 3);
+
+        // the least recently used image is evicted
+        QVERIFY(!lookup(cache, key(0)).isNull());
+        cache.insert(key(3), data);
+        QCOMPARE(cache.diskSize(), qint64(data.size()) * 3);
+        QTRY_COMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 3);
+
+        ImageCache reopened(dir.path(), data.size() * 3 + 1);
+        QVERIFY(lookup(reopened, key(1)).isNull());
+        QVERIFY(!lookup(reopened, key(0)).isNull());
+        QVERIFY(!lookup(reopened, key(2)).isNull());
+        QVERIFY(!lookup(reopened, key(3)).isNull());
+    }
+
+    void testEvictionDuringWrite()
+    {
+        QTemporaryDir dir;
+        const auto data = png(QSize(16, 16));
+        // room for one image
+        ImageCache cache(dir.path(), data.size() + 1);
+        const auto key = [](int i) {
+            return ImageCache::Key { QString::number(i), "etag", QSize(16, 16) };
+        };
+        // the first image is evicted while it might still be written
+        cache.insert(key(0), data);
+        cache.insert(key(1), data);
+        QTRY_COMPARE(cache.diskSize(), qint64(data.size()));
+        QVERIFY(!lookup(cache, key(1)).isNull());
+        QTRY_COMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 1);
+
+        ImageCache reopened(dir.path(), data.size() + 1);
+        QCOMPARE(reopened.diskSize(), qint64(data.size()));
+        QVERIFY(lookup(reopened, key(0)).isNull());
+        QVERIFY(!lookup(reopened, key(1)).isNull());
+    }
+};
+
+QTEST_MAIN(TestImageCache)
+#include "testimagecache.moc"
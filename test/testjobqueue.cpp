@@ -8,9 +8,13 @@
 
 #include "abstractnetworkjob.h"
 #include "account.h"
+#include "creds/httpcredentials.h"
+#include "networkjobs.h"
+#include "retrybudget.h"
 
 #include "testutils/syncenginetestutils.h"
 
+#include <QSignalSpy>
 #include <QTest>
 
 using namespace OCC;
@@ -44,9 +48,26 @@ public:
         AbstractNetworkJob::start();
     }
 
+    std::function<void(TestJob *)> onFinished;
+
 protected:
     void finished() override
     {
+        if (onFinished) {
+            onFinished(this);
+        }
+    }
+};
+
+// Breaks off in the middle of the listing with an error that is retried
+struct FakeResentPropfindReply : FakePropfindReply {
+    FakeResentPropfindReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op,
+                            const QNetworkRequest &request, QObject *parent)
+        : FakePropfindReply(remoteRootFileInfo, op, request, parent)
+    {
+        payload.truncate(payload.size() / 2);
+        setAttribute(QNetworkRequest::Http2WasUsedAttribute, true);
+        setError(ContentReSendError, QStringLiteral("Resend"));
     }
 };
 
@@ -128,6 +149,178 @@ private Q_SLOTS:
         }
         QVERIFY(!queue->isBlocked());
     }
+
+    void testRetryBudget()
+    {
+        using namespace std::chrono_literals;
+
+        RetryBudget budget(2, 1s);
+        const auto start = RetryBudget::Clock::now();
+        const QString host = QStringLiteral("cloud.example.com");
+        QVERIFY(budget.tryAcquire(host, start));
+        QVERIFY(budget.tryAcquire(host, start));
+        QVERIFY(!budget.tryAcquire(host, start));
+        // every host has its own budget
+        QVERIFY(budget.tryAcquire(QStringLiteral("other.example.com"), start));
+
+        // tokens are refilled over time
+        QVERIFY(!budget.tryAcquire(host, start + 500ms));
+        QVERIFY(budget.tryAcquire(host, start + 1s));
+        QCOMPARE(budget.tokens(host, start + 1h), 2.0);
+        QCOMPARE(budget.grantedRetries(), qint64(4));
+        QCOMPARE(budget.deniedRetries(), qint64(2));
+
+        // the backoff grows exponentially, jittered between half and the full delay
+        QCOMPARE(RetryBudget::backoff(0, 0.0), 125ms);
+        QCOMPARE(RetryBudget::backoff(0, 1.0), 250ms);
+        QCOMPARE(RetryBudget::backoff(3, 0.0), 1000ms);
+        QCOMPARE(RetryBudget::backoff(20, 1.0), RetryBudget::MaxDelay);
+        for (int i = 0; i < 100; ++i) {
+            const auto delay = RetryBudget::backoff(2);
+            QVERIFY(delay >= 500ms && delay <= 1000ms);
+        }
+    }
+
+    void testCoalescing()
+    {
+        FakeFolder fakeFolder { FileInfo::A12_B12_C12_S12() };
+        int propfinds = 0;
+        fakeFolder.setServerOverride([&propfinds](QNetworkAccessManager::Operation, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray() == "PROPFIND") {
+                ++propfinds;
+            }
+            return nullptr;
+        });
+
+        auto queue = fakeFolder.account()->jobQueue();
+        QVector<QByteArray> bodies;
+        auto startJob = [&] {
+            auto job = new TestJob(fakeFolder.account());
+            job->onFinished = [&bodies](TestJob *finishedJob) {
+                QCOMPARE(finishedJob->reply()->error(), QNetworkReply::NoError);
+                bodies.append(finishedJob->reply()->readAll());
+            };
+            job->start();
+            return job;
+        };
+
+        // identical requests in flight are sent once
+        startJob();
+        startJob();
+        QCOMPARE(propfinds, 1);
+        QCOMPARE(queue->coalescedRequests(), qint64(1));
+        QTRY_COMPARE(bodies.size(), 2);
+        QVERIFY(!bodies[0].isEmpty());
+        QCOMPARE(bodies[0], bodies[1]);
+
+        // the request isn't in flight anymore
+        startJob();
+        QCOMPARE(propfinds, 2);
+        QTRY_COMPARE(bodies.size(), 3);
+        QCOMPARE(bodies[2], bodies[0]);
+
+        // aborting one job doesn't abort the shared request
+        auto aborted = new TestJob(fakeFolder.account());
+        aborted->start();
+        startJob();
+        QCOMPARE(propfinds, 3);
+        QCOMPARE(queue->coalescedRequests(), qint64(2));
+        aborted->abort();
+        QTRY_COMPARE(bodies.size(), 4);
+        QCOMPARE(bodies[3], bodies[0]);
+    }
+
+    // The credentials see the authentication failure of a shared request
+    void testCoalescedAuthenticationFailure()
+    {
+        FakeFolder fakeFolder { FileInfo::A12_B12_C12_S12() };
+        fakeFolder.setServerOverride([this](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray() == "PROPFIND") {
+                auto reply = new FakeErrorReply(op, request, this, 401);
+                // what HttpCredentials::slotAuthentication() does to the network reply
+                reply->setProperty("owncloud-authentication-failed", true);
+                reply->setError(QNetworkReply::OperationCanceledError, QStringLiteral("Operation canceled"));
+                return reply;
+            }
+            return nullptr;
+        });
+
+        HttpCredentials credentials(DetermineAuthTypeJob::AuthType::Basic, QStringLiteral("admin"), QStringLiteral("secret"));
+        QVector<bool> stillValid;
+        for (int i = 0; i < 2; ++i) {
+            auto job = new TestJob(fakeFolder.account());
+            job->onFinished = [&](TestJob *finishedJob) {
+                stillValid.append(credentials.stillValid(finishedJob->reply()));
+            };
+            job->start();
+        }
+        QCOMPARE(fakeFolder.account()->jobQueue()->coalescedRequests(), qint64(1));
+        QTRY_COMPARE(stillValid.size(), 2);
+        QCOMPARE(stillValid, QVector<bool>({ false, false }));
+    }
+
+    // A request sent when an identical one finishes isn't joined to it
+    void testCoalescingRequestFromFinished()
+    {
+        FakeFolder fakeFolder { FileInfo::A12_B12_C12_S12() };
+        int propfinds = 0;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray() == "PROPFIND") {
+                ++propfinds;
+                // no data that would end the joining
+                return new FakePayloadReply(op, request, QByteArray(), this);
+            }
+            return nullptr;
+        });
+
+        QVector<QNetworkReply::NetworkError> errors;
+        auto second = new TestJob(fakeFolder.account());
+        second->onFinished = [&errors](TestJob *finishedJob) {
+            errors.append(finishedJob->reply()->error());
+        };
+        auto first = new TestJob(fakeFolder.account());
+        first->onFinished = [&errors, second](TestJob *finishedJob) {
+            errors.append(finishedJob->reply()->error());
+            second->start();
+        };
+        first->start();
+
+        QTRY_COMPARE(errors.size(), 2);
+        QCOMPARE(errors, QVector<QNetworkReply::NetworkError>({ QNetworkReply::NoError, QNetworkReply::NoError }));
+        QCOMPARE(propfinds, 2);
+        QCOMPARE(fakeFolder.account()->jobQueue()->coalescedRequests(), qint64(0));
+    }
+
+    // A retried PROPFIND parses the new reply from its start
+    void testPropfindRetryMidStream()
+    {
+        FakeFolder fakeFolder { FileInfo::A12_B12_C12_S12() };
+        int propfinds = 0;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray() == "PROPFIND" && ++propfinds == 1) {
+                return new FakeResentPropfindReply(fakeFolder.remoteModifier(), op, request, this);
+            }
+            return nullptr;
+        });
+
+        auto job = new PropfindJob(fakeFolder.account(), fakeFolder.account()->davUrl(), QStringLiteral("/A"), PropfindJob::Depth::One, this);
+        job->setProperties({ QByteArrayLiteral("resourcetype"), QByteArrayLiteral("getetag") });
+        QStringList listed;
+        connect(job, &PropfindJob::directoryListingIterated, this, [&listed](const QString &name, const QMap<QString, QString> &) {
+            listed.append(name);
+        });
+        QSignalSpy finishedSpy(job, &PropfindJob::finishedWithoutError);
+        QSignalSpy errorSpy(job, &PropfindJob::finishedWithError);
+        job->start();
+
+        QVERIFY(finishedSpy.wait());
+        QCOMPARE(propfinds, 2);
+        QVERIFY(errorSpy.isEmpty());
+        QVERIFY(listed.size() >= 3);
+        QVERIFY(listed.at(listed.size() - 3).endsWith(QLatin1String("/A")));
+        QVERIFY(listed.at(listed.size() - 2).endsWith(QLatin1String("/A/a1")));
+        QVERIFY(listed.last().endsWith(QLatin1String("/A/a2")));
+    }
 };
 
 QTEST_GUILESS_MAIN(TestJobQueue)
@@ -237,6 +237,35 @@ private slots:
         QVERIFY(!fakeFolder.currentRemoteState().find("C/.foo"));
         QVERIFY(!fakeFolder.currentRemoteState().find("C/bar"));
     }
+
+    // Measures the reconcile of a directory with many entries
+    void testLargeDirectoryDiscovery()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        FakeFolder fakeFolder(FileInfo {}, vfsMode, filesAreDehydrated);
+        const int fileCount = 10000;
+        fakeFolder.remoteModifier().mkdir(QStringLiteral("big"));
+        for (int i = 0; i < fileCount; ++i) {
+            fakeFolder.remoteModifier().insert(QStringLiteral("big/file%1").arg(i), 1_b);
+        }
+        QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+
+        // new entries on both sides between the existing ones
+        fakeFolder.remoteModifier().insert(QStringLiteral("big/Remote"), 1_b);
+        fakeFolder.localModifier().insert(QStringLiteral("big/local"), 1_b);
+        QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        QBENCHMARK {
+            // reconcile the server, db and local entries of all files
+            fakeFolder.syncJournal().forceRemoteDiscoveryNextSync();
+            QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+        }
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QCOMPARE(fakeFolder.currentRemoteState().find(QStringLiteral("big"))->children.size(), fileCount + 2);
+    }
 };
 
 QTEST_GUILESS_MAIN(TestLocalDiscovery)
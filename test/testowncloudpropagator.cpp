@@ -7,6 +7,9 @@
 #include <QtTest>
 #include <QDebug>
 
+#include "account.h"
+#include "common/syncjournaldb.h"
+#include "common/vfs.h"
 #include "propagatedownload.h"
 #include "owncloudpropagator_p.h"
 
@@ -62,7 +65,65 @@ private slots:
             QVERIFY( tmpFileName.length() <= 254);
         }
     }
+
+    void testTypeChangeScaling_data()
+    {
+        QTest::addColumn<int>("directoryCount");
+
+        QTest::newRow("100") << 100;
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("10000") << 10000;
+    }
+
+    // Uploads into folders that replace files are skipped, building the job
+    // tree must stay linear in the number of items nevertheless
+    void testTypeChangeScaling()
+    {
+        QFETCH(int, directoryCount);
+        const int filesPerDirectory = 10;
+
+        auto makeItem = [](const QString &file, ItemType type, SyncInstructions instruction) {
+            auto item = SyncFileItemPtr::create();
+            item->_file = file;
+            item->_type = type;
+            item->_instruction = instruction;
+            item->_direction = SyncFileItem::Up;
+            return item;
+        };
+        SyncFileItemSet items;
+        for (int i = 0; i < directoryCount; ++i) {
+            const QString dirName = QStringLiteral("dir%1").arg(i);
+            items.insert(makeItem(dirName, ItemTypeDirectory, CSYNC_INSTRUCTION_TYPE_CHANGE));
+            for (int j = 0; j < filesPerDirectory; ++j) {
+                items.insert(makeItem(dirName + QStringLiteral("/file%1").arg(j), ItemTypeFile, CSYNC_INSTRUCTION_NEW));
+            }
+            // sorts directly after the contents of the folder
+            items.insert(makeItem(dirName + QStringLiteral("-file"), ItemTypeFile, CSYNC_INSTRUCTION_NEW));
+        }
+
+        QTemporaryDir dir;
+        SyncJournalDb journal(dir.path() + QStringLiteral("/.sync_test.db"));
+        OwncloudPropagator propagator(Account::create(),
+            SyncOptions(QSharedPointer<Vfs>(createVfsFromPlugin(Vfs::Off).release())),
+            QUrl(QStringLiteral("http://example.com/remote.php/webdav/")), dir.path(), QStringLiteral("/"), &journal);
+
+        // the propagator can only be started once, compare the rows to see the scaling
+        QBENCHMARK_ONCE {
+            propagator.start(SyncFileItemSet(items));
+        }
+
+        QVERIFY(propagator._anotherSyncNeeded);
+        for (const auto &item : items) {
+            if (item->_file.contains(QLatin1Char('/'))) {
+                QCOMPARE(item->_instruction, CSYNC_INSTRUCTION_NONE);
+            } else if (item->isDirectory()) {
+                QCOMPARE(item->_instruction, CSYNC_INSTRUCTION_TYPE_CHANGE);
+            } else {
+                QCOMPARE(item->_instruction, CSYNC_INSTRUCTION_NEW);
+            }
+        }
+    }
 };
 
-QTEST_APPLESS_MAIN(TestOwncloudPropagator)
+QTEST_GUILESS_MAIN(TestOwncloudPropagator)
 #include "testowncloudpropagator.moc"
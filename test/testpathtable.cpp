@@ -0,0 +1,109 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "common/pathtable.h"
+
+#include <QTest>
+
+using namespace OCC;
+
+class TestPathTable : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testIntern()
+    {
+        PathTable table;
+        QCOMPARE(table.intern(QString()), PathTable::root);
+        QCOMPARE(table.path(PathTable::root), QString());
+
+        const auto file = table.intern(QStringLiteral("A/B/file"));
+        QCOMPARE(table.path(file), QStringLiteral("A/B/file"));
+        QCOMPARE(table.pathUtf8(file), QByteArray("A/B/file"));
+        QCOMPARE(table.name(file), QStringLiteral("file"));
+        QCOMPARE(table.path(table.parent(file)), QStringLiteral("A/B"));
+        QCOMPARE(table.size(), 4);
+
+        // the same path gives the same handle, whatever form it has
+        QCOMPARE(table.intern(QStringLiteral("A/B/file")), file);
+        QCOMPARE(table.intern(QByteArray("A/B/file")), file);
+        QCOMPARE(table.find(QStringLiteral("A/B/file")), file);
+        QCOMPARE(table.child(table.intern(QStringLiteral("A/B")), QStringLiteral("file")), file);
+        QCOMPARE(table.size(), 4);
+
+        QCOMPARE(table.find(QStringLiteral("A/C")), PathTable::invalid);
+        QCOMPARE(table.find(QStringLiteral("file")), PathTable::invalid);
+        QCOMPARE(table.size(), 4);
+    }
+
+    void testSharedNames()
+    {
+        PathTable table;
+        for (int i = 0; i < 100; ++i) {
+            for (int j = 0; j < 10; ++j) {
+                table.intern(QStringLiteral("dir%1/file%2").arg(i).arg(j));
+            }
+        }
+        QCOMPARE(table.size(), 1 + 100 + 100 * 10);
+        // the root, the directories and the file names
+        QCOMPARE(table.nameCount(), 1 + 100 + 10);
+    }
+
+    void testUtf8()
+    {
+        PathTable table;
+        const QString path = QString::fromUtf8("dä/über/文件");
+        const auto handle = table.intern(path.toUtf8());
+        QCOMPARE(table.path(handle), path);
+        QCOMPARE(table.pathUtf8(handle), path.toUtf8());
+        QCOMPARE(table.find(path), handle);
+    }
+
+    void testIsBelow()
+    {
+        PathTable table;
+        const auto a = table.intern(QStringLiteral("A"));
+        const auto ab = table.intern(QStringLiteral("A/B"));
+        const auto abc = table.intern(QStringLiteral("A/B/c"));
+        const auto ab2 = table.intern(QStringLiteral("AB"));
+
+        QVERIFY(table.isBelow(abc, a));
+        QVERIFY(table.isBelow(abc, ab));
+        QVERIFY(table.isBelow(a, PathTable::root));
+        QVERIFY(!table.isBelow(a, a));
+        QVERIFY(!table.isBelow(ab, abc));
+        QVERIFY(!table.isBelow(ab2, a));
+        QVERIFY(!table.isBelow(PathTable::root, PathTable::root));
+    }
+
+    void testMemoryUsage()
+    {
+        // 20 top level directories with 50 subdirectories of 100 files each
+        PathTable table;
+        QStringList paths;
+        qint64 pathsUsage = 0;
+        for (int i = 0; i < 20; ++i) {
+            for (int j = 0; j < 50; ++j) {
+                for (int k = 0; k < 100; ++k) {
+                    const QString path = QStringLiteral("Documents %1/Project %2/file %3.txt").arg(i).arg(j).arg(k);
+                    table.intern(path);
+                    paths.append(path);
+                    pathsUsage += qint64(sizeof(QString)) + qint64(sizeof(QArrayData)) + (path.capacity() + 1) * qint64(sizeof(QChar));
+                }
+            }
+        }
+        QCOMPARE(table.size(), 1 + 20 + 20 * 50 + 20 * 50 * 100);
+
+        // the table also holds every directory and the UTF-8 form of the names
+        qInfo() << "QString paths:" << pathsUsage << "bytes, PathTable:" << table.memoryUsage() << "bytes";
+        QVERIFY(table.memoryUsage() < pathsUsage);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestPathTable)
+#include "testpathtable.moc"
@@ -35,6 +35,16 @@ struct MissingPermissionsPropfindReply : FakePropfindReply {
     }
 };
 
+// Answers a sync-collection REPORT with a fixed multistatus body
+struct FakeMultiStatusReply : FakePropfindReply {
+    FakeMultiStatusReply(const QByteArray &body, QNetworkAccessManager::Operation op,
+                         const QNetworkRequest &request, QObject *parent)
+        : FakePropfindReply(op, request, parent) {
+        payload = body;
+        QMetaObject::invokeMethod(this, "respond", Qt::QueuedConnection);
+    }
+};
+
 enum ErrorKind : int {
     // Lower code are corresponding to HTML error code
     InvalidXML = 1000,
@@ -194,6 +204,153 @@ private slots:
         QVERIFY(completeSpy.findItem("nofileid")->_errorString.contains("file id"));
         QVERIFY(completeSpy.findItem("nopermissions/A")->_errorString.contains("permissions"));
     }
+
+    // With a sync token the changes are fetched with a single REPORT instead of listing directories
+    void testRemoteDelta()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        FakeFolder fakeFolder(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        fakeFolder.enableSyncCollection();
+
+        QStringList listedDirectories;
+        int reports = 0;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation, const QNetworkRequest &req, QIODevice *) -> QNetworkReply * {
+            const auto verb = req.attribute(QNetworkRequest::CustomVerbAttribute).toString();
+            if (verb == QLatin1String("PROPFIND") && req.rawHeader("Depth") == "1") {
+                listedDirectories.append(getFilePathFromUrl(req.url()));
+            } else if (verb == QLatin1String("REPORT")) {
+                ++reports;
+            }
+            return nullptr;
+        });
+        auto resetCounters = [&] {
+            listedDirectories.clear();
+            reports = 0;
+        };
+
+        // Without a token the tree is listed
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(reports, 0);
+        QCOMPARE(listedDirectories.size(), 1);
+        auto token = fakeFolder.syncJournal().syncToken();
+        QVERIFY(!token.isEmpty());
+
+        // Nothing changed
+        resetCounters();
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(reports, 1);
+        QVERIFY(listedDirectories.isEmpty());
+        QVERIFY(fakeFolder.syncJournal().syncToken() != token);
+
+        // Changes, a removal and a move
+        fakeFolder.remoteModifier().appendByte(QStringLiteral("A/a1"));
+        fakeFolder.remoteModifier().insert(QStringLiteral("B/b3"));
+        fakeFolder.remoteModifier().mkdir(QStringLiteral("C/new"));
+        fakeFolder.remoteModifier().insert(QStringLiteral("C/new/c"));
+        fakeFolder.remoteModifier().remove(QStringLiteral("S/s1"));
+        fakeFolder.remoteModifier().rename(QStringLiteral("B/b1"), QStringLiteral("A/b1"));
+        resetCounters();
+        ItemCompletedSpy completeSpy(fakeFolder);
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(reports, 1);
+        // Only the directory that is not in the db yet is listed
+        QCOMPARE(listedDirectories, QStringList { QStringLiteral("C/new") });
+        QCOMPARE(completeSpy.findItem(QStringLiteral("S/s1"))->_instruction, CSYNC_INSTRUCTION_REMOVE);
+        QCOMPARE(completeSpy.findItem(QStringLiteral("C/new/c"))->_instruction, CSYNC_INSTRUCTION_NEW);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        // Forcing a remote discovery drops the token
+        fakeFolder.syncJournal().forceRemoteDiscoveryNextSync();
+        QVERIFY(fakeFolder.syncJournal().syncToken().isEmpty());
+        resetCounters();
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(reports, 0);
+        QCOMPARE(listedDirectories.size(), 6);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
+
+    void testRemoteDeltaFallback()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        FakeFolder fakeFolder(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        fakeFolder.enableSyncCollection();
+        QVERIFY(fakeFolder.syncOnce());
+        auto token = fakeFolder.syncJournal().syncToken();
+        QVERIFY(!token.isEmpty());
+
+        // The server doesn't know the token anymore, the tree is listed
+        fakeFolder.expireSyncTokens();
+        fakeFolder.remoteModifier().insert(QStringLiteral("A/a3"));
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QVERIFY(!fakeFolder.syncJournal().syncToken().isEmpty());
+        QVERIFY(fakeFolder.syncJournal().syncToken() != token);
+
+        // A failed download keeps the old token so the next delta reports the file again
+        token = fakeFolder.syncJournal().syncToken();
+        fakeFolder.remoteModifier().insert(QStringLiteral("B/b3"));
+        fakeFolder.serverErrorPaths().append(QStringLiteral("B/b3"), 500);
+        fakeFolder.syncOnce();
+        QCOMPARE(fakeFolder.syncJournal().syncToken(), token);
+        QVERIFY(!fakeFolder.currentLocalState().find(QStringLiteral("B/b3")));
+
+        fakeFolder.serverErrorPaths().clear();
+        fakeFolder.syncJournal().wipeErrorBlacklist();
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QVERIFY(fakeFolder.syncJournal().syncToken() != token);
+    }
+
+    // Reports the delta can't be applied from must not remove anything
+    void testRemoteDeltaUnusableReport()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        FakeFolder fakeFolder(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        fakeFolder.enableSyncCollection();
+        QVERIFY(fakeFolder.syncOnce());
+        QVERIFY(!fakeFolder.syncJournal().syncToken().isEmpty());
+
+        // a truncated result and a member with a status other than 404
+        const QByteArray truncated = QByteArrayLiteral("<response><href>%1</href><status>HTTP/1.1 507 Insufficient Storage</status></response>"
+                                                       "<response><href>%1/A/a1</href><status>HTTP/1.1 404 Not Found</status></response>");
+        const QByteArray forbidden = QByteArrayLiteral("<response><href>%1/A/a1</href><status>HTTP/1.1 403 Forbidden</status></response>");
+        for (const auto &responses : { truncated, forbidden }) {
+            int reports = 0;
+            QStringList listedDirectories;
+            fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &req, QIODevice *) -> QNetworkReply * {
+                const auto verb = req.attribute(QNetworkRequest::CustomVerbAttribute).toString();
+                if (verb == QLatin1String("PROPFIND") && req.rawHeader("Depth") == "1") {
+                    listedDirectories.append(getFilePathFromUrl(req.url()));
+                } else if (verb == QLatin1String("REPORT")) {
+                    ++reports;
+                    const QByteArray body = QByteArrayLiteral("<?xml version=\"1.0\" encoding=\"utf-8\"?><multistatus xmlns=\"DAV:\">")
+                        + QString::fromUtf8(responses).arg(req.url().path()).toUtf8()
+                        + QByteArrayLiteral("<sync-token>unusable</sync-token></multistatus>");
+                    return new FakeMultiStatusReply(body, op, req, this);
+                }
+                return nullptr;
+            });
+
+            fakeFolder.remoteModifier().insert(QStringLiteral("B/b3"));
+            QVERIFY(fakeFolder.syncOnce());
+            QCOMPARE(reports, 1);
+            // the tree was listed instead
+            QVERIFY(!listedDirectories.isEmpty());
+            QVERIFY(fakeFolder.currentLocalState().find(QStringLiteral("A/a1")));
+            QVERIFY(fakeFolder.currentLocalState().find(QStringLiteral("B/b3")));
+            QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+            QVERIFY(fakeFolder.syncJournal().syncToken() != "unusable");
+            fakeFolder.remoteModifier().remove(QStringLiteral("B/b3"));
+            fakeFolder.setServerOverride(nullptr);
+            QVERIFY(fakeFolder.syncOnce());
+        }
+    }
 };
 
 QTEST_GUILESS_MAIN(TestRemoteDiscovery)
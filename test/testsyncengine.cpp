@@ -6,12 +6,20 @@
  */
 
 #include <syncengine.h>
+#include <syncplan.h>
+#include <transferbudget.h>
 
 #include "testutils/syncenginetestutils.h"
 #include "testutils/testutils.h"
 
+#include <QJsonArray>
 #include <QtTest>
 
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
 using namespace std::chrono_literals;
 using namespace OCC::FileSystem::SizeLiterals;
 using namespace OCC;
@@ -38,6 +46,46 @@ bool itemDidCompleteSuccessfully(const ItemCompletedSpy &spy, const QString &pat
     return false;
 }
 
+/** Uploads `files` new files in each of the folders, their syncs run in parallel on budget
+ *
+ * onPut is called with the index of the folder when an upload starts, the uploads take 20ms.
+ */
+void syncWithTransferBudget(const QVector<FakeFolder *> &folders, const QSharedPointer<TransferBudget> &budget, int files, const std::function<void(int)> &onPut)
+{
+    for (int index = 0; index < folders.size(); ++index) {
+        auto *fakeFolder = folders.at(index);
+        auto options = fakeFolder->syncEngine().syncOptions();
+        options._transferBudget = budget;
+        fakeFolder->syncEngine().setSyncOptions(options);
+        for (int i = 0; i < files; ++i) {
+            fakeFolder->localModifier().insert(QStringLiteral("A/new%1").arg(i), 100);
+        }
+        fakeFolder->setServerOverride([index, fakeFolder, onPut](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *outgoingData) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::PutOperation) {
+                onPut(index);
+                return new DelayedReply<FakePutReply>(20ms, fakeFolder->remoteModifier(), op, request, outgoingData->readAll(), &fakeFolder->syncEngine());
+            }
+            return nullptr;
+        });
+        QVERIFY(fakeFolder->applyLocalModificationsWithoutSync());
+    }
+
+    std::vector<std::unique_ptr<QSignalSpy>> finished;
+    for (auto *fakeFolder : folders) {
+        finished.push_back(std::make_unique<QSignalSpy>(&fakeFolder->syncEngine(), &SyncEngine::finished));
+        fakeFolder->scheduleSync();
+    }
+    for (const auto &spy : finished) {
+        QTRY_COMPARE_WITH_TIMEOUT(spy->count(), 1, 60000);
+        QVERIFY(spy->first().first().toBool());
+    }
+
+    QCOMPARE(budget->activeJobs(), 0);
+    for (auto *fakeFolder : folders) {
+        QCOMPARE(fakeFolder->currentLocalState(), fakeFolder->currentRemoteState());
+    }
+}
+
 class TestSyncEngine : public QObject
 {
     Q_OBJECT
@@ -906,6 +954,231 @@ private slots:
 
         QCOMPARE(QFileInfo(fakeFolder.localPath() + "foo").lastModified(), datetime);
     }
+
+    // Check that the aggregator publishes every status change but rate limits the progress updates
+    void testProgressAggregator()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        FakeFolder fakeFolder(FileInfo {}, vfsMode, filesAreDehydrated);
+        fakeFolder.localModifier().mkdir(QStringLiteral("A"));
+        for (int i = 0; i < 200; ++i) {
+            fakeFolder.localModifier().insert(QStringLiteral("A/file%1").arg(i), 100);
+        }
+
+        ProgressAggregator aggregator;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::transmissionProgress, &aggregator, &ProgressAggregator::updateProgress);
+        QVector<ProgressSnapshot> snapshots;
+        connect(&aggregator, &ProgressAggregator::snapshotPublished, this, [&snapshots](const ProgressSnapshot &snapshot) {
+            snapshots.append(snapshot);
+        });
+
+        QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        QVERIFY(!snapshots.isEmpty());
+        QVERIFY(static_cast<quint64>(snapshots.size()) < aggregator.receivedUpdates());
+
+        QVector<ProgressInfo::Status> statusChanges;
+        for (int i = 0; i < snapshots.size(); ++i) {
+            if (i > 0) {
+                QCOMPARE(snapshots[i].version(), snapshots[i - 1].version() + 1);
+            }
+            if (statusChanges.isEmpty() || statusChanges.last() != snapshots[i].status()) {
+                statusChanges.append(snapshots[i].status());
+            }
+        }
+        const QVector<ProgressInfo::Status> expected = { ProgressInfo::Discovery, ProgressInfo::Reconcile, ProgressInfo::Propagation, ProgressInfo::Done };
+        QCOMPARE(statusChanges, expected);
+
+        const auto &done = snapshots.last();
+        QCOMPARE(done.status(), ProgressInfo::Done);
+        QCOMPARE(done.completedFiles(), done.totalFiles());
+        QCOMPARE(done.completedSize(), done.totalSize());
+        QCOMPARE(aggregator.snapshot().version(), done.version());
+    }
+
+    // Two syncs sharing a budget of one job must not run their transfers in parallel
+    void testSharedTransferBudget()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        auto budget = QSharedPointer<TransferBudget>::create(1);
+        FakeFolder fakeFolder1(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        FakeFolder fakeFolder2(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+
+        int maxActiveJobs = 0;
+        syncWithTransferBudget({ &fakeFolder1, &fakeFolder2 }, budget, 10, [&](int) {
+            maxActiveJobs = qMax(maxActiveJobs, budget->activeJobs());
+        });
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+        QCOMPARE(maxActiveJobs, 1);
+    }
+
+    // Syncs with the same server share the per host limit of the budget
+    void testTransferBudgetPerHost()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        auto budget = QSharedPointer<TransferBudget>::create(20);
+        budget->setMaximumActiveJobsPerHost(2);
+        FakeFolder fakeFolder1(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        FakeFolder fakeFolder2(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        const QString host = fakeFolder1.account()->url().host();
+
+        int maxActiveJobs = 0;
+        syncWithTransferBudget({ &fakeFolder1, &fakeFolder2 }, budget, 10, [&](int) {
+            maxActiveJobs = qMax(maxActiveJobs, budget->activeJobs(host));
+        });
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+        QCOMPARE(maxActiveJobs, 2);
+    }
+
+    // A saturated server doesn't hold back the syncs with other servers
+    void testTransferBudgetOtherHosts()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        auto budget = QSharedPointer<TransferBudget>::create(20);
+        budget->setMaximumActiveJobsPerHost(2);
+        FakeFolder fakeFolder1(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        FakeFolder fakeFolder2(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        FakeFolder otherHost1(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        FakeFolder otherHost2(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        // the fake server only looks at the path
+        otherHost1.account()->setUrl(QUrl(QStringLiteral("http://cloud1.example.com/owncloud")));
+        otherHost2.account()->setUrl(QUrl(QStringLiteral("http://cloud2.example.com/owncloud")));
+        const QStringList hosts = { fakeFolder1.account()->url().host(), fakeFolder2.account()->url().host(),
+            otherHost1.account()->url().host(), otherHost2.account()->url().host() };
+
+        QMap<QString, int> maxActiveJobs;
+        // the uploads to the other hosts that started while the first one was saturated
+        std::array<int, 2> startedBesideSaturated = { 0, 0 };
+        int maxTotalActiveJobs = 0;
+        syncWithTransferBudget({ &fakeFolder1, &fakeFolder2, &otherHost1, &otherHost2 }, budget, 10, [&](int index) {
+            const QString &host = hosts.at(index);
+            maxActiveJobs[host] = qMax(maxActiveJobs.value(host), budget->activeJobs(host));
+            maxTotalActiveJobs = qMax(maxTotalActiveJobs, budget->activeJobs());
+            if (index >= 2 && budget->activeJobs(hosts.at(0)) == 2) {
+                ++startedBesideSaturated[index - 2];
+            }
+        });
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+        QCOMPARE(maxActiveJobs.size(), 3);
+        for (auto it = maxActiveJobs.cbegin(); it != maxActiveJobs.cend(); ++it) {
+            QVERIFY2(it.value() <= 2, qPrintable(it.key()));
+        }
+        QVERIFY(startedBesideSaturated[0] > 0);
+        QVERIFY(startedBesideSaturated[1] > 0);
+        QVERIFY(maxTotalActiveJobs > 2);
+    }
+
+    // A sync with a higher weight gets more of the shared slots
+    void testTransferBudgetWeights()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        auto budget = QSharedPointer<TransferBudget>::create(4);
+        FakeFolder fakeFolder1(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        FakeFolder fakeFolder2(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        auto options = fakeFolder1.syncEngine().syncOptions();
+        options._transferWeight = 3;
+        fakeFolder1.syncEngine().setSyncOptions(options);
+
+        // the number of uploads each sync started
+        std::array<int, 2> started = { 0, 0 };
+        // the uploads of the second sync when the first one started its last upload
+        int startedByLighter = -1;
+        int maxActiveJobs = 0;
+        syncWithTransferBudget({ &fakeFolder1, &fakeFolder2 }, budget, 20, [&](int index) {
+            maxActiveJobs = qMax(maxActiveJobs, budget->activeJobs());
+            if (++started[index] == 20 && index == 0) {
+                startedByLighter = started[1];
+            }
+        });
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+
+        // with equal weights both would have started about the same number of uploads
+        QVERIFY(startedByLighter >= 0);
+        QVERIFY2(startedByLighter <= 12, qPrintable(QString::number(startedByLighter)));
+        QCOMPARE(started[1], 20);
+        QVERIFY(maxActiveJobs <= 4);
+    }
+
+    // A plan-only sync reports the operations without performing them
+    void testPlanOnly()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        FakeFolder fakeFolder(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        fakeFolder.remoteModifier().insert(QStringLiteral("A/a0"), 100);
+        fakeFolder.remoteModifier().mkdir(QStringLiteral("D"));
+        fakeFolder.localModifier().insert(QStringLiteral("B/b0"), 50);
+        fakeFolder.localModifier().remove(QStringLiteral("C/c1"));
+        QVERIFY(fakeFolder.applyLocalModificationsWithoutSync());
+        const auto localBefore = fakeFolder.currentLocalState();
+        const auto remoteBefore = fakeFolder.currentRemoteState();
+
+        SyncPlan plan;
+        QStringList plannedFiles;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::syncPlanReady, this, [&](const SyncPlan &p, const SyncFileItemSet &items) {
+            plan = p;
+            for (const auto &item : items) {
+                if (SyncPlan::isPlanned(*item)) {
+                    plannedFiles.append(item->_file);
+                }
+            }
+        });
+        ItemCompletedSpy completeSpy(fakeFolder);
+        int removeAllRequests = 0;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::aboutToRemoveAllFiles, this, [&] { ++removeAllRequests; });
+
+        fakeFolder.syncEngine().setPlanOnly(true);
+        QVERIFY(fakeFolder.syncOnce());
+
+        QVERIFY(completeSpy.isEmpty());
+        QCOMPARE(removeAllRequests, 0);
+        QCOMPARE(fakeFolder.currentLocalState(), localBefore);
+        QCOMPARE(fakeFolder.currentRemoteState(), remoteBefore);
+        SyncJournalFileRecord record;
+        QVERIFY(fakeFolder.syncJournal().getFileRecord(QStringLiteral("C/c1"), &record));
+        QVERIFY(record.isValid());
+
+        plannedFiles.sort();
+        QCOMPARE(plannedFiles, QStringList({ QStringLiteral("A/a0"), QStringLiteral("B/b0"), QStringLiteral("C/c1"), QStringLiteral("D") }));
+        QCOMPARE(plan.itemCount(), qint64(4));
+        QCOMPARE(plan.uploadBytes(), qint64(50));
+        QCOMPARE(plan.downloadBytes(), qint64(filesAreDehydrated ? 0 : 100));
+        const auto operations = plan.operations();
+        QCOMPARE(operations.value({ CSYNC_INSTRUCTION_NEW, SyncFileItem::Down }).count, qint64(2));
+        QCOMPARE(operations.value({ CSYNC_INSTRUCTION_NEW, SyncFileItem::Up }).count, qint64(1));
+        QCOMPARE(operations.value({ CSYNC_INSTRUCTION_REMOVE, SyncFileItem::Up }).count, qint64(1));
+
+        const auto json = plan.toJson();
+        QCOMPARE(json.value(QStringLiteral("items")).toInt(), 4);
+        QCOMPARE(json.value(QStringLiteral("operations")).toArray().size(), 3);
+
+        // the plan didn't interfere with the next sync
+        fakeFolder.syncEngine().setPlanOnly(false);
+        QVERIFY(fakeFolder.syncOnce());
+        QVERIFY(itemDidCompleteSuccessfully(completeSpy, QStringLiteral("A/a0")));
+        QVERIFY(itemDidCompleteSuccessfully(completeSpy, QStringLiteral("C/c1")));
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
 };
 
 QTEST_GUILESS_MAIN(TestSyncEngine)
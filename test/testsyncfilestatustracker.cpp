@@ -8,6 +8,7 @@
 #include <QtTest>
 #include "testutils/syncenginetestutils.h"
 #include "csync_exclude.h"
+#include "syncfilestatustree.h"
 
 using namespace OCC;
 
@@ -533,6 +534,71 @@ private slots:
         statusSpy.clear();
     }
 
+    void testStatusTree()
+    {
+        SyncFileStatusTree tree(Qt::CaseInsensitive);
+        tree.setProblem(QStringLiteral("A/B/error"), SyncFileStatus::StatusError);
+        tree.setProblem(QStringLiteral("A/excluded"), SyncFileStatus::StatusExcluded);
+        tree.setProblem(QStringLiteral("AB/error"), SyncFileStatus::StatusError);
+
+        QCOMPARE(tree.lookupProblem(QStringLiteral("a/b/ERROR")), SyncFileStatus::StatusError);
+        QCOMPARE(tree.lookupProblem(QStringLiteral("A/B")), SyncFileStatus::StatusWarning);
+        QCOMPARE(tree.lookupProblem(QStringLiteral("A")), SyncFileStatus::StatusWarning);
+        QCOMPARE(tree.lookupProblem(QString()), SyncFileStatus::StatusWarning);
+        QCOMPARE(tree.lookupProblem(QStringLiteral("A/excluded")), SyncFileStatus::StatusExcluded);
+        QCOMPARE(tree.lookupProblem(QStringLiteral("A/C")), SyncFileStatus::StatusNone);
+        QCOMPARE(tree.problem(QStringLiteral("A")), SyncFileStatus::StatusNone);
+
+        // excluded paths don't make their parents a warning
+        tree.removeProblem(QStringLiteral("A/B/error"));
+        QCOMPARE(tree.lookupProblem(QStringLiteral("A/B")), SyncFileStatus::StatusNone);
+        QCOMPARE(tree.lookupProblem(QStringLiteral("A")), SyncFileStatus::StatusNone);
+        QCOMPARE(tree.lookupProblem(QString()), SyncFileStatus::StatusWarning);
+
+        QCOMPARE(tree.incSyncCount(QStringLiteral("A/file")), 0);
+        QCOMPARE(tree.incSyncCount(QStringLiteral("a/FILE")), 1);
+        QCOMPARE(tree.syncCount(QStringLiteral("A/file")), 2);
+        QVERIFY(tree.hasSyncCounts());
+        QCOMPARE(tree.decSyncCount(QStringLiteral("A/file")), 1);
+        QCOMPARE(tree.takeSyncCounts(), QStringList { QStringLiteral("A/file") });
+        QVERIFY(!tree.hasSyncCounts());
+        QCOMPARE(tree.syncCount(QStringLiteral("A/file")), 0);
+
+        const auto problems = tree.takeProblems();
+        QCOMPARE(problems.size(), 2);
+        QCOMPARE(problems.value(QStringLiteral("A/excluded")), SyncFileStatus::StatusExcluded);
+        QCOMPARE(problems.value(QStringLiteral("AB/error")), SyncFileStatus::StatusError);
+        QCOMPARE(tree.lookupProblem(QString()), SyncFileStatus::StatusNone);
+    }
+
+    void benchmarkStatusTree()
+    {
+        // many errors and syncing files in a deep tree, the status of their parents is looked up
+        QStringList files;
+        for (int i = 0; i < 20; ++i) {
+            for (int j = 0; j < 1000; ++j) {
+                files << QStringLiteral("dir%1/sub/subsub/file%2").arg(QString::number(i), QString::number(j));
+            }
+        }
+
+        QBENCHMARK {
+            SyncFileStatusTree tree(Qt::CaseSensitive);
+            for (const auto &file : qAsConst(files)) {
+                tree.setProblem(file, SyncFileStatus::StatusError);
+                tree.incSyncCount(file);
+            }
+            for (const auto &file : qAsConst(files)) {
+                QCOMPARE(tree.lookupProblem(file.left(file.lastIndexOf(QLatin1Char('/')))), SyncFileStatus::StatusWarning);
+                QCOMPARE(tree.lookupProblem(QString()), SyncFileStatus::StatusWarning);
+            }
+            for (const auto &file : qAsConst(files)) {
+                tree.decSyncCount(file);
+                tree.removeProblem(file);
+            }
+            QVERIFY(!tree.hasSyncCounts());
+            QCOMPARE(tree.lookupProblem(QString()), SyncFileStatus::StatusNone);
+        }
+    }
 };
 
 QTEST_GUILESS_MAIN(TestSyncFileStatusTracker)
@@ -192,6 +192,45 @@ private slots:
         QVERIFY(!_db.conflictRecord(record.path).isValid());
     }
 
+    void testErrorBlacklist()
+    {
+        SyncJournalErrorBlacklistRecord record;
+        record._file = QStringLiteral("blacklisted");
+        record._errorString = QStringLiteral("error");
+        record._lastTryTime = 1;
+        record._ignoreDuration = 10;
+        record._retryCount = 1;
+        _db.setErrorBlacklistEntry(record);
+        _db.close();
+        _db.allowReopen();
+
+        // the paths are read on the first lookup, paths without an entry skip the query
+        QCOMPARE(_db.errorBlacklistEntry(QStringLiteral("blacklisted"))._errorString, QStringLiteral("error"));
+        QCOMPARE(_db.errorBlacklistQueriesSaved(), qint64(0));
+        QVERIFY(!_db.errorBlacklistEntry(QStringLiteral("other")).isValid());
+        QCOMPARE(_db.errorBlacklistQueriesSaved(), qint64(1));
+
+        // new entries are found
+        record._file = QStringLiteral("other");
+        _db.setErrorBlacklistEntry(record);
+        QVERIFY(_db.errorBlacklistEntry(QStringLiteral("other")).isValid());
+        QCOMPARE(_db.errorBlacklistQueriesSaved(), qint64(1));
+
+        _db.wipeErrorBlacklistEntry(QStringLiteral("other"));
+        QVERIFY(!_db.errorBlacklistEntry(QStringLiteral("other")).isValid());
+        QCOMPARE(_db.wipeErrorBlacklist(), 1);
+        QVERIFY(!_db.errorBlacklistEntry(QStringLiteral("blacklisted")).isValid());
+        QCOMPARE(_db.errorBlacklistQueriesSaved(), qint64(2));
+
+        // a new sync run starts counting again
+        _db.clearErrorBlacklistCache();
+        QCOMPARE(_db.errorBlacklistQueriesSaved(), qint64(0));
+        QVERIFY(!_db.errorBlacklistEntry(QStringLiteral("other")).isValid());
+        QCOMPARE(_db.errorBlacklistQueriesSaved(), qint64(1));
+        _db.close();
+        _db.allowReopen();
+    }
+
     void testAvoidReadFromDbOnNextSync()
     {
         auto invalidEtag = QByteArray("_invalid_");
@@ -312,6 +351,34 @@ private slots:
         QVERIFY(checkElements());
     }
 
+    void testListFilesInPathTable()
+    {
+        for (const auto &path : { "list", "list/a", "list/ä", "list/a/file", "list/b", "other/a" }) {
+            SyncJournalFileRecord record;
+            record._path = path;
+            record._remotePerm = RemotePermissions::fromDbValue("RW");
+            QVERIFY(_db.setFileRecord(record));
+        }
+
+        PathTable paths;
+        const auto dir = paths.intern(QStringLiteral("list"));
+        QStringList names;
+        QVERIFY(_db.listFilesInPath(paths, dir, [&](PathTable::Handle handle, const SyncJournalFileRecord &rec) {
+            QCOMPARE(paths.parent(handle), dir);
+            QCOMPARE(paths.pathUtf8(handle), rec._path);
+            names.append(paths.name(handle));
+        }));
+        names.sort();
+        QCOMPARE(names, QStringList({ QStringLiteral("a"), QStringLiteral("b"), QString::fromUtf8("ä") }));
+
+        // listing another directory shares the names
+        const auto nameCount = paths.nameCount();
+        QVERIFY(_db.listFilesInPath(paths, paths.intern(QStringLiteral("other")), [&](PathTable::Handle handle, const SyncJournalFileRecord &) {
+            QCOMPARE(paths.path(handle), QStringLiteral("other/a"));
+        }));
+        QCOMPARE(paths.nameCount(), nameCount + 1);
+    }
+
     void testPinState()
     {
         auto make = [&](const QByteArray &path, PinState state) {
@@ -10,6 +10,11 @@
 #include <QtTest>
 #include <syncengine.h>
 
+#ifndef Q_OS_WIN
+#include <unistd.h>
+#endif
+
+using namespace std::chrono_literals;
 using namespace OCC;
 
 bool itemSuccessful(const ItemCompletedSpy &spy, const QString &path, const SyncInstructions instr)
@@ -738,6 +743,124 @@ private slots:
         QVERIFY(fakeFolder.currentLocalState().equals(fakeFolder.currentRemoteState(), FileInfo::IgnoreLastModified));
     }
 
+    // New local files with the content of a synced file are copied on the server
+    void testLocalCopy()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        FakeFolder fakeFolder(FileInfo::A12_B12_C12_S12(), vfsMode, filesAreDehydrated);
+        fakeFolder.localModifier().insert(QStringLiteral("A/big"), 200_kb, 'B');
+        QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+
+        int nCOPY = 0;
+        int nPUT = 0;
+        bool failCopy = false;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (request.attribute(QNetworkRequest::CustomVerbAttribute) == QLatin1String("COPY")) {
+                ++nCOPY;
+                if (failCopy) {
+                    return new FakeErrorReply(op, request, this, 403);
+                }
+            } else if (op == QNetworkAccessManager::PutOperation) {
+                ++nPUT;
+            }
+            return nullptr;
+        });
+
+        const QString localPath = fakeFolder.localPath();
+        const auto mtime = FileSystem::getModTime(localPath + QStringLiteral("A/big"));
+        const auto copy = [&](const QString &destination, time_t destinationMTime) {
+            QVERIFY(QFile::copy(localPath + QStringLiteral("A/big"), localPath + destination));
+            QVERIFY(FileSystem::setModTime(localPath + destination, destinationMTime));
+        };
+
+        // a copy that kept the mtime is copied, another one is uploaded
+        copy(QStringLiteral("B/big"), mtime);
+        copy(QStringLiteral("C/big"), mtime - 100);
+#ifndef Q_OS_WIN
+        // hard links have the same inode
+        QCOMPARE(::link(QString(localPath + QStringLiteral("A/big")).toLocal8Bit().constData(), QString(localPath + QStringLiteral("A/big_link")).toLocal8Bit().constData()), 0);
+        const int expectedCopies = 2;
+#else
+        const int expectedCopies = 1;
+#endif
+        QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+        QCOMPARE(nCOPY, expectedCopies);
+        QCOMPARE(nPUT, 1);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QVERIFY(fakeFolder.currentRemoteState().find(QStringLiteral("B/big"))->fileId != fakeFolder.currentRemoteState().find(QStringLiteral("A/big"))->fileId);
+
+        // the copies are synced, nothing else happens
+        QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+        QCOMPARE(nCOPY, expectedCopies);
+        QCOMPARE(nPUT, 1);
+
+        // the file is uploaded if the copy fails
+        failCopy = true;
+        copy(QStringLiteral("C/big2"), mtime);
+        QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+        QCOMPARE(nCOPY, expectedCopies + 1);
+        QCOMPARE(nPUT, 2);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
+
+    // Deletes and moves of files are pipelined, each reply finishes its own item
+    void testPipelinedDeletesAndMoves()
+    {
+        QFETCH_GLOBAL(Vfs::Mode, vfsMode);
+        QFETCH_GLOBAL(bool, filesAreDehydrated);
+
+        FakeFolder fakeFolder(FileInfo {}, vfsMode, filesAreDehydrated);
+        fakeFolder.localModifier().mkdir(QStringLiteral("A"));
+        for (int i = 0; i < 10; ++i) {
+            fakeFolder.localModifier().insert(QStringLiteral("A/delete%1").arg(i));
+            fakeFolder.localModifier().insert(QStringLiteral("A/move%1").arg(i));
+        }
+        QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+
+        auto options = fakeFolder.syncEngine().syncOptions();
+        options._parallelNetworkJobs = 20;
+        fakeFolder.syncEngine().setSyncOptions(options);
+
+        int inFlight = 0;
+        int maxInFlight = 0;
+        QObject parent;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            const auto verb = request.attribute(QNetworkRequest::CustomVerbAttribute).toString();
+            QNetworkReply *reply = nullptr;
+            if (request.url().path().endsWith(QLatin1String("A/delete3"))) {
+                return new FakeErrorReply(op, request, &parent, 500);
+            } else if (op == QNetworkAccessManager::DeleteOperation) {
+                reply = new DelayedReply<FakeDeleteReply>(50ms, fakeFolder.remoteModifier(), op, request, &parent);
+            } else if (verb == QLatin1String("MOVE")) {
+                reply = new DelayedReply<FakeMoveReply>(50ms, fakeFolder.remoteModifier(), op, request, &parent);
+            } else {
+                return nullptr;
+            }
+            maxInFlight = qMax(maxInFlight, ++inFlight);
+            connect(reply, &QNetworkReply::finished, this, [&] { --inFlight; });
+            return reply;
+        });
+
+        for (int i = 0; i < 10; ++i) {
+            fakeFolder.localModifier().remove(QStringLiteral("A/delete%1").arg(i));
+            fakeFolder.localModifier().rename(QStringLiteral("A/move%1").arg(i), QStringLiteral("A/moved%1").arg(i));
+        }
+        ItemCompletedSpy completeSpy(fakeFolder);
+        QVERIFY(!fakeFolder.applyLocalModificationsAndSync());
+
+        // more requests than the three transfers plus three quick jobs of before
+        QVERIFY(maxInFlight > 6);
+        QVERIFY(maxInFlight <= 20);
+        QCOMPARE(completeSpy.findItem(QStringLiteral("A/delete3"))->_status, SyncFileItem::NormalError);
+        QCOMPARE(completeSpy.findItem(QStringLiteral("A/delete4"))->_status, SyncFileItem::Success);
+        QCOMPARE(completeSpy.findItem(QStringLiteral("A/moved4"))->_status, SyncFileItem::Success);
+        QVERIFY(fakeFolder.currentRemoteState().find(QStringLiteral("A/delete3")));
+        QVERIFY(!fakeFolder.currentRemoteState().find(QStringLiteral("A/delete4")));
+        QVERIFY(fakeFolder.currentRemoteState().find(QStringLiteral("A/moved9")));
+    }
+
     // Test for https://github.com/owncloud/client/issues/6694
     void testInvertFolderHierarchy()
     {
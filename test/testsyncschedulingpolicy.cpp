@@ -0,0 +1,108 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "syncschedulingpolicy.h"
+
+#include <QTest>
+
+using namespace std::chrono_literals;
+using namespace OCC;
+
+class TestSyncSchedulingPolicy : public QObject
+{
+    Q_OBJECT
+
+    using Clock = SyncSchedulingPolicy::Clock;
+
+    // simulate a tool writing rate changes per second for the given time
+    static Clock::time_point writeFiles(SyncSchedulingPolicy &policy, Clock::time_point start, int rate, std::chrono::seconds duration)
+    {
+        const auto step = std::chrono::duration_cast<Clock::duration>(1s) / rate;
+        auto now = start;
+        for (int i = 0; i < rate * duration.count(); ++i) {
+            now += step;
+            policy.addChange(now);
+            policy.requestSync(now);
+        }
+        return now;
+    }
+
+private slots:
+    void testCalmFolder()
+    {
+        SyncSchedulingPolicy policy(2s, 1min);
+        const auto start = Clock::now();
+        QVERIFY(!policy.hasPendingSync());
+
+        policy.addChange(start);
+        QVERIFY(policy.requestSync(start));
+        QVERIFY(policy.hasPendingSync());
+        QVERIFY(!policy.isBusy(start));
+        // a single change is synced after roughly the minimum file age
+        QVERIFY(policy.delay(start) >= 2s);
+        QVERIFY(policy.delay(start) < 3s);
+        QCOMPARE(policy.delay(start + 5s), 0ms);
+
+        // a second request is coalesced
+        QVERIFY(!policy.requestSync(start + 1s));
+        QCOMPARE(policy.avoidedSyncs(), qint64(1));
+
+        policy.syncScheduled();
+        QVERIFY(!policy.hasPendingSync());
+        policy.syncStarted(start + 3s);
+        QCOMPARE(policy.avoidedSyncs(), qint64(1));
+        QCOMPARE(policy.minimumSyncInterval(), 0ms);
+
+        // the rate decays
+        QVERIFY(policy.changeRate(start + 1min) < policy.changeRate(start) / 100);
+    }
+
+    void testBusyFolder()
+    {
+        SyncSchedulingPolicy policy(2s, 1min);
+        const auto start = Clock::now();
+
+        auto now = writeFiles(policy, start, 20, 10s);
+        QVERIFY(policy.isBusy(now));
+        QCOMPARE(policy.changeCount(), qint64(200));
+        QCOMPARE(policy.avoidedSyncs(), qint64(199));
+        // the folder keeps changing, wait for a longer quiet period
+        QVERIFY(policy.delay(now) > 10s);
+        QVERIFY(policy.delay(now) <= 50s);
+
+        // constant changes can't postpone the sync beyond the maximum delay
+        now = writeFiles(policy, now, 20, 1min);
+        QCOMPARE(policy.delay(now), 0ms);
+
+        // syncs that start while the folder is busy back off
+        policy.syncScheduled();
+        policy.syncStarted(now);
+        QVERIFY(policy.minimumSyncInterval() == 2s);
+        now = writeFiles(policy, now, 20, 5s);
+        policy.syncScheduled();
+        policy.syncStarted(now);
+        QVERIFY(policy.minimumSyncInterval() == 6s);
+
+        // changes right after the start of a sync respect the minimum interval
+        policy.addChange(now);
+        policy.requestSync(now);
+        QVERIFY(policy.delay(now) >= 6s);
+
+        // a sync started for a different reason satisfies the pending request
+        const auto avoided = policy.avoidedSyncs();
+        policy.syncStarted(now + 1s);
+        QVERIFY(!policy.hasPendingSync());
+        QCOMPARE(policy.avoidedSyncs(), avoided + 1);
+
+        // once the folder calmed down the backoff is reset
+        policy.syncStarted(now + 5min);
+        QCOMPARE(policy.minimumSyncInterval(), 0ms);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestSyncSchedulingPolicy)
+#include "testsyncschedulingpolicy.moc"
@@ -856,6 +856,75 @@ private slots:
         QCOMPARE(fakeFolder.currentRemoteState(), expectedRemoteState);
     }
 
+    // Pin changes are applied from the journal without a discovery
+    void testPinChangeWithoutDiscovery()
+    {
+        FakeFolder fakeFolder{ FileInfo::A12_B12_C12_S12() };
+        auto vfs = setupVfs(fakeFolder);
+        QVERIFY(fakeFolder.applyLocalModificationsAndSync());
+
+        int propfinds = 0;
+        int gets = 0;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (request.attribute(QNetworkRequest::CustomVerbAttribute) == "PROPFIND") {
+                ++propfinds;
+            } else if (op == QNetworkAccessManager::GetOperation) {
+                ++gets;
+            }
+            return nullptr;
+        });
+        ItemCompletedSpy completeSpy(fakeFolder);
+
+        auto isDehydrated = [&](const QString &path) {
+            QString placeholder = path + DVSUFFIX;
+            return !fakeFolder.currentLocalState().find(path)
+                && fakeFolder.currentLocalState().find(placeholder);
+        };
+
+        // dehydrate A, the locally changed file is left to the next sync
+        vfs->setPinState(QStringLiteral("A"), PinState::OnlineOnly);
+        fakeFolder.localModifier().appendByte(QStringLiteral("A/a2"));
+        QVERIFY(fakeFolder.applyLocalModificationsWithoutSync());
+        fakeFolder.syncEngine().setPinChangePaths({ QStringLiteral("A") });
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(propfinds, 0);
+        QVERIFY(isDehydrated(QStringLiteral("A/a1")));
+        QCOMPARE(completeSpy.findItem("A/a1" DVSUFFIX)->_type, ItemTypeVirtualFileDehydration);
+        QCOMPARE(dbRecord(fakeFolder, "A/a1" DVSUFFIX)._type, ItemTypeVirtualFile);
+        QVERIFY(!isDehydrated(QStringLiteral("A/a2")));
+        QVERIFY(!completeSpy.findItem("A/a2"));
+        QCOMPARE(fakeFolder.syncEngine().isAnotherSyncNeeded(), ImmediateFollowUp);
+        // other folders are untouched
+        QVERIFY(!isDehydrated(QStringLiteral("B/b1")));
+        QCOMPARE(completeSpy.size(), 1);
+
+        // the regular sync uploads the changed file
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentRemoteState().find("A/a2")->contentSize, 5);
+        completeSpy.clear();
+        propfinds = 0;
+        gets = 0;
+
+        // hydrate A again
+        vfs->setPinState(QStringLiteral("A"), PinState::AlwaysLocal);
+        fakeFolder.syncEngine().setPinChangePaths({ QStringLiteral("A") });
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(propfinds, 0);
+        QCOMPARE(gets, 1);
+        QVERIFY(fakeFolder.currentLocalState().find("A/a1"));
+        QVERIFY(!isDehydrated(QStringLiteral("A/a1")));
+        QCOMPARE(completeSpy.findItem("A/a1")->_type, ItemTypeVirtualFileDownload);
+        QCOMPARE(dbRecord(fakeFolder, "A/a1")._type, ItemTypeFile);
+        QVERIFY(!dbRecord(fakeFolder, "A/a1" DVSUFFIX).isValid());
+        QCOMPARE(fakeFolder.syncEngine().isAnotherSyncNeeded(), NoFollowUpSync);
+
+        // nothing is left for the regular sync
+        completeSpy.clear();
+        QVERIFY(fakeFolder.syncOnce());
+        QVERIFY(!completeSpy.findItem("A/a1"));
+        QVERIFY(!completeSpy.findItem("A/a2"));
+    }
+
     void testWipeVirtualSuffixFiles()
     {
         FakeFolder fakeFolder{ FileInfo{} };
@@ -346,14 +346,18 @@ FileInfo *FileInfo::findInvalidatingEtags(PathComponents pathComponents)
     return find(std::move(pathComponents), true);
 }
 
-FakePropfindReply::FakePropfindReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent)
+FakePropfindReply::FakePropfindReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent)
     : FakeReply { parent }
 {
     setRequest(request);
     setUrl(request.url());
     setOperation(op);
     open(QIODevice::ReadOnly);
+}
 
+FakePropfindReply::FakePropfindReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent, const QByteArray &syncToken)
+    : FakePropfindReply { op, request, parent }
+{
     QString fileName = getFilePathFromUrl(request.url());
     Q_ASSERT(!fileName.isNull()); // for root, it should be empty
     const FileInfo *fileInfo = remoteRootFileInfo.find(fileName);
@@ -364,51 +368,20 @@ FakePropfindReply::FakePropfindReply(FileInfo &remoteRootFileInfo, QNetworkAcces
     const QString prefix = request.url().path().left(request.url().path().size() - fileName.size());
 
     // Don't care about the request and just return a full propfind
-    const QString davUri { QStringLiteral("DAV:") };
-    const QString ocUri { QStringLiteral("http://owncloud.org/ns") };
     QBuffer buffer { &payload };
     buffer.open(QIODevice::WriteOnly);
     QXmlStreamWriter xml(&buffer);
-    xml.writeNamespace(davUri, QStringLiteral("d"));
-    xml.writeNamespace(ocUri, QStringLiteral("oc"));
+    xml.writeNamespace(QStringLiteral("DAV:"), QStringLiteral("d"));
+    xml.writeNamespace(QStringLiteral("http://owncloud.org/ns"), QStringLiteral("oc"));
     xml.writeStartDocument();
-    xml.writeStartElement(davUri, QStringLiteral("multistatus"));
-    auto writeFileResponse = [&](const FileInfo &fileInfo) {
-        xml.writeStartElement(davUri, QStringLiteral("response"));
-        const auto href = OCC::Utility::concatUrlPath(prefix, QString::fromUtf8(QUrl::toPercentEncoding(fileInfo.absolutePath(), "/"))).path();
-        xml.writeTextElement(davUri, QStringLiteral("href"), href);
-        xml.writeStartElement(davUri, QStringLiteral("propstat"));
-        xml.writeStartElement(davUri, QStringLiteral("prop"));
-
-        if (fileInfo.isDir) {
-            xml.writeStartElement(davUri, QStringLiteral("resourcetype"));
-            xml.writeEmptyElement(davUri, QStringLiteral("collection"));
-            xml.writeEndElement(); // resourcetype
-        } else
-            xml.writeEmptyElement(davUri, QStringLiteral("resourcetype"));
-
-        auto gmtDate = fileInfo.lastModifiedInUtc();
-        auto stringDate = QLocale::c().toString(gmtDate, QStringLiteral("ddd, dd MMM yyyy HH:mm:ss 'GMT'"));
-        xml.writeTextElement(davUri, QStringLiteral("getlastmodified"), stringDate);
-        xml.writeTextElement(davUri, QStringLiteral("getcontentlength"), QString::number(fileInfo.contentSize));
-        xml.writeTextElement(davUri, QStringLiteral("getetag"), QStringLiteral("\"%1\"").arg(QString::fromLatin1(fileInfo.etag)));
-        xml.writeTextElement(ocUri, QStringLiteral("permissions"), !fileInfo.permissions.isNull() ? QString(fileInfo.permissions.toString()) : fileInfo.isShared ? QStringLiteral("SRDNVCKW")
-                                                                                                                                                                 : QStringLiteral("RDNVCKW"));
-        xml.writeTextElement(ocUri, QStringLiteral("id"), QString::fromUtf8(fileInfo.fileId));
-        xml.writeTextElement(ocUri, QStringLiteral("checksums"), QString::fromUtf8(fileInfo.checksums));
-        buffer.write(fileInfo.extraDavProperties);
-        xml.writeEndElement(); // prop
-        xml.writeTextElement(davUri, QStringLiteral("status"), QStringLiteral("HTTP/1.1 200 OK"));
-        xml.writeEndElement(); // propstat
-        xml.writeEndElement(); // response
-    };
+    xml.writeStartElement(QStringLiteral("DAV:"), QStringLiteral("multistatus"));
 
-    writeFileResponse(*fileInfo);
+    writeFileResponse(xml, prefix, *fileInfo, syncToken);
 
     const int depth = request.rawHeader(QByteArrayLiteral("Depth")).toInt();
     if (depth > 0) {
         for (const FileInfo &childFileInfo : fileInfo->children) {
-            writeFileResponse(childFileInfo);
+            writeFileResponse(xml, prefix, childFileInfo);
         }
     }
     xml.writeEndElement(); // multistatus
@@ -417,6 +390,99 @@ FakePropfindReply::FakePropfindReply(FileInfo &remoteRootFileInfo, QNetworkAcces
     QMetaObject::invokeMethod(this, "respond", Qt::QueuedConnection);
 }
 
+void FakePropfindReply::writeFileResponse(QXmlStreamWriter &xml, const QString &prefix, const FileInfo &fileInfo, const QByteArray &syncToken)
+{
+    const QString davUri { QStringLiteral("DAV:") };
+    const QString ocUri { QStringLiteral("http://owncloud.org/ns") };
+    xml.writeStartElement(davUri, QStringLiteral("response"));
+    const auto href = OCC::Utility::concatUrlPath(prefix, QString::fromUtf8(QUrl::toPercentEncoding(fileInfo.absolutePath(), "/"))).path();
+    xml.writeTextElement(davUri, QStringLiteral("href"), href);
+    xml.writeStartElement(davUri, QStringLiteral("propstat"));
+    xml.writeStartElement(davUri, QStringLiteral("prop"));
+
+    if (fileInfo.isDir) {
+        xml.writeStartElement(davUri, QStringLiteral("resourcetype"));
+        xml.writeEmptyElement(davUri, QStringLiteral("collection"));
+        xml.writeEndElement(); // resourcetype
+    } else
+        xml.writeEmptyElement(davUri, QStringLiteral("resourcetype"));
+
+    auto gmtDate = fileInfo.lastModifiedInUtc();
+    auto stringDate = QLocale::c().toString(gmtDate, QStringLiteral("ddd, dd MMM yyyy HH:mm:ss 'GMT'"));
+    xml.writeTextElement(davUri, QStringLiteral("getlastmodified"), stringDate);
+    xml.writeTextElement(davUri, QStringLiteral("getcontentlength"), QString::number(fileInfo.contentSize));
+    xml.writeTextElement(davUri, QStringLiteral("getetag"), QStringLiteral("\"%1\"").arg(QString::fromLatin1(fileInfo.etag)));
+    xml.writeTextElement(ocUri, QStringLiteral("permissions"), !fileInfo.permissions.isNull() ? QString(fileInfo.permissions.toString()) : fileInfo.isShared ? QStringLiteral("SRDNVCKW")
+                                                                                                                                                             : QStringLiteral("RDNVCKW"));
+    xml.writeTextElement(ocUri, QStringLiteral("id"), QString::fromUtf8(fileInfo.fileId));
+    xml.writeTextElement(ocUri, QStringLiteral("checksums"), QString::fromUtf8(fileInfo.checksums));
+    if (!syncToken.isEmpty()) {
+        xml.writeTextElement(davUri, QStringLiteral("sync-token"), QString::fromUtf8(syncToken));
+    }
+    xml.device()->write(fileInfo.extraDavProperties);
+    xml.writeEndElement(); // prop
+    xml.writeTextElement(davUri, QStringLiteral("status"), QStringLiteral("HTTP/1.1 200 OK"));
+    xml.writeEndElement(); // propstat
+    xml.writeEndElement(); // response
+}
+
+FakeSyncCollectionReply::FakeSyncCollectionReply(FileInfo &snapshot, FileInfo &remoteRootFileInfo, const QByteArray &newSyncToken,
+    QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent)
+    : FakePropfindReply { op, request, parent }
+{
+    const QString fileName = getFilePathFromUrl(request.url());
+    Q_ASSERT(!fileName.isNull());
+    const FileInfo *oldCollection = snapshot.find(fileName);
+    const FileInfo *collection = remoteRootFileInfo.find(fileName);
+    if (!oldCollection || !collection) {
+        QMetaObject::invokeMethod(this, "respond404", Qt::QueuedConnection);
+        return;
+    }
+    const QString prefix = request.url().path().left(request.url().path().size() - fileName.size());
+    const QString davUri { QStringLiteral("DAV:") };
+
+    QBuffer buffer { &payload };
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter xml(&buffer);
+    xml.writeNamespace(davUri, QStringLiteral("d"));
+    xml.writeNamespace(QStringLiteral("http://owncloud.org/ns"), QStringLiteral("oc"));
+    xml.writeStartDocument();
+    xml.writeStartElement(davUri, QStringLiteral("multistatus"));
+
+    // new and changed entries
+    std::function<void(const FileInfo &)> writeChanged = [&](const FileInfo &dir) {
+        for (const FileInfo &child : dir.children) {
+            const FileInfo *old = snapshot.find(child.path());
+            if (!old || old->etag != child.etag || old->fileId != child.fileId || old->isDir != child.isDir || old->permissions != child.permissions) {
+                writeFileResponse(xml, prefix, child);
+            }
+            writeChanged(child);
+        }
+    };
+    writeChanged(*collection);
+
+    // removed entries
+    std::function<void(const FileInfo &)> writeRemoved = [&](const FileInfo &dir) {
+        for (const FileInfo &child : dir.children) {
+            if (!remoteRootFileInfo.find(child.path())) {
+                xml.writeStartElement(davUri, QStringLiteral("response"));
+                const auto href = OCC::Utility::concatUrlPath(prefix, QString::fromUtf8(QUrl::toPercentEncoding(child.absolutePath(), "/"))).path();
+                xml.writeTextElement(davUri, QStringLiteral("href"), href);
+                xml.writeTextElement(davUri, QStringLiteral("status"), QStringLiteral("HTTP/1.1 404 Not Found"));
+                xml.writeEndElement(); // response
+            }
+            writeRemoved(child);
+        }
+    };
+    writeRemoved(*oldCollection);
+
+    xml.writeTextElement(davUri, QStringLiteral("sync-token"), QString::fromUtf8(newSyncToken));
+    xml.writeEndElement(); // multistatus
+    xml.writeEndDocument();
+
+    QMetaObject::invokeMethod(this, "respond", Qt::QueuedConnection);
+}
+
 void FakePropfindReply::respond()
 {
     setHeader(QNetworkRequest::ContentLengthHeader, payload.size());
@@ -568,6 +634,35 @@ void FakeMoveReply::respond()
     emit finished();
 }
 
+FakeCopyReply::FakeCopyReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent)
+    : FakeReply { parent }
+{
+    setRequest(request);
+    setUrl(request.url());
+    setOperation(op);
+    open(QIODevice::ReadOnly);
+
+    QString fileName = getFilePathFromUrl(request.url());
+    Q_ASSERT(!fileName.isEmpty());
+    QString dest = getFilePathFromUrl(QUrl::fromEncoded(request.rawHeader("Destination")));
+    Q_ASSERT(!dest.isEmpty());
+    const FileInfo source = *remoteRootFileInfo.find(fileName);
+    Q_ASSERT(!source.isDir);
+    fileInfo = remoteRootFileInfo.create(dest, source.fileSize, source.contentChar);
+    fileInfo->contentSize = source.contentSize;
+    fileInfo->checksums = source.checksums;
+    fileInfo->setLastModifiedFromSecondsUTC(source.lastModifiedInSecondsUTC());
+    QMetaObject::invokeMethod(this, "respond", Qt::QueuedConnection);
+}
+
+void FakeCopyReply::respond()
+{
+    setRawHeader("OC-FileId", fileInfo->fileId);
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 201);
+    emit metaDataChanged();
+    emit finished();
+}
+
 FakeGetReply::FakeGetReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent)
     : FakeReply { parent }
     , _range(parseRange(request))
@@ -896,10 +991,21 @@ QNetworkReply *FakeAM::createRequest(QNetworkAccessManager::Operation op, const
         FileInfo &info = isUpload ? _uploadFileInfo : _remoteRootFileInfo;
 
         auto verb = newRequest.attribute(QNetworkRequest::CustomVerbAttribute);
-        if (verb == QLatin1String("PROPFIND"))
+        if (verb == QLatin1String("PROPFIND")) {
             // Ignore outgoingData always returning somethign good enough, works for now.
-            reply = new FakePropfindReply { info, op, newRequest, this };
-        else if (verb == QLatin1String("GET") || op == QNetworkAccessManager::GetOperation)
+            const bool reportSyncToken = _syncCollectionEnabled && !isUpload && getFilePathFromUrl(newRequest.url()).isEmpty();
+            reply = new FakePropfindReply { info, op, newRequest, this, reportSyncToken ? createSyncToken() : QByteArray() };
+        } else if (verb == QLatin1String("REPORT") && _syncCollectionEnabled) {
+            static const QRegularExpression tokenRx(QStringLiteral("<d:sync-token>(.*)</d:sync-token>"));
+            const auto token = tokenRx.match(QString::fromUtf8(outgoingData->readAll())).captured(1).toUtf8();
+            if (!_syncTokenSnapshots.contains(token)) {
+                // the server doesn't know the token (anymore)
+                reply = new FakeErrorReply { op, newRequest, this, 403 };
+            } else {
+                const auto newToken = createSyncToken();
+                reply = new FakeSyncCollectionReply { _syncTokenSnapshots[token], info, newToken, op, newRequest, this };
+            }
+        } else if (verb == QLatin1String("GET") || op == QNetworkAccessManager::GetOperation)
             reply = new FakeGetReply { info, op, newRequest, this };
         else if (verb == QLatin1String("PUT") || op == QNetworkAccessManager::PutOperation)
             reply = new FakePutReply { info, op, newRequest, outgoingData->readAll(), this };
@@ -911,6 +1017,19 @@ QNetworkReply *FakeAM::createRequest(QNetworkAccessManager::Operation op, const
             reply = new FakeMoveReply { info, op, newRequest, this };
         else if (verb == QLatin1String("MOVE") && isUpload)
             reply = new FakeChunkMoveReply { info, _remoteRootFileInfo, op, newRequest, this };
+        else if (verb == QLatin1String("COPY")) {
+            const FileInfo *source = info.find(getFilePathFromUrl(newRequest.url()));
+            const QByteArray ifMatch = newRequest.rawHeader("If-Match");
+            const bool overwrite = newRequest.rawHeader("Overwrite") != "F";
+            if (!source) {
+                reply = new FakeErrorReply { op, newRequest, this, 404 };
+            } else if ((!ifMatch.isEmpty() && ifMatch != '"' + source->etag + '"')
+                || (!overwrite && info.find(getFilePathFromUrl(QUrl::fromEncoded(newRequest.rawHeader("Destination")))))) {
+                reply = new FakeErrorReply { op, newRequest, this, 412 };
+            } else {
+                reply = new FakeCopyReply { info, op, newRequest, this };
+            }
+        }
         else {
             qDebug() << verb << outgoingData;
             Q_UNREACHABLE();
@@ -926,6 +1045,13 @@ QNetworkReply *FakeAM::createRequest(QNetworkAccessManager::Operation op, const
     return reply;
 }
 
+QByteArray FakeAM::createSyncToken()
+{
+    const QByteArray token = QByteArrayLiteral("fake-sync-token-") + QByteArray::number(_syncTokenSnapshots.size());
+    _syncTokenSnapshots.insert(token, _remoteRootFileInfo);
+    return token;
+}
+
 FakeFolder::FakeFolder(const FileInfo &fileTemplate, OCC::Vfs::Mode vfsMode, bool filesAreDehydrated)
     : _localModifier(_tempDir.path())
 {
@@ -977,6 +1103,16 @@ FakeFolder::FakeFolder(const FileInfo &fileTemplate, OCC::Vfs::Mode vfsMode, boo
     OC_ENFORCE(syncOnce())
 }
 
+void FakeFolder::enableSyncCollection()
+{
+    auto cap = OCC::TestUtils::testCapabilities();
+    auto dav = cap.value(QStringLiteral("dav")).toMap();
+    dav.insert(QStringLiteral("reports"), QStringList { QStringLiteral("search-files"), QStringLiteral("sync-collection") });
+    cap.insert(QStringLiteral("dav"), dav);
+    _account->setCapabilities(cap);
+    _fakeAm->setSyncCollectionEnabled(true);
+}
+
 void FakeFolder::switchToVfs(QSharedPointer<OCC::Vfs> vfs)
 {
     auto opts = _syncEngine->syncOptions();
@@ -24,6 +24,7 @@
 #include <QMap>
 #include <QNetworkReply>
 #include <QTimer>
+#include <QXmlStreamWriter>
 #include <QtTest>
 #include <cookiejar.h>
 
@@ -331,7 +332,8 @@ class FakePropfindReply : public FakeReply
 public:
     QByteArray payload;
 
-    FakePropfindReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent);
+    /// A non empty syncToken is reported as property of the requested collection
+    FakePropfindReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent, const QByteArray &syncToken = QByteArray());
 
     Q_INVOKABLE void respond();
 
@@ -341,6 +343,24 @@ public:
 
     qint64 bytesAvailable() const override;
     qint64 readData(char *data, qint64 maxlen) override;
+
+protected:
+    FakePropfindReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent);
+
+    static void writeFileResponse(QXmlStreamWriter &xml, const QString &prefix, const FileInfo &fileInfo, const QByteArray &syncToken = QByteArray());
+};
+
+/**
+ * Answers a sync-collection REPORT with the difference between the remote
+ * state at the time the sync token was handed out and the current state.
+ */
+class FakeSyncCollectionReply : public FakePropfindReply
+{
+    Q_OBJECT
+
+public:
+    FakeSyncCollectionReply(FileInfo &snapshot, FileInfo &remoteRootFileInfo, const QByteArray &newSyncToken,
+        QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent);
 };
 
 class FakePutReply : public FakeReply
@@ -384,7 +404,7 @@ class FakeDeleteReply : public FakeReply
 public:
     FakeDeleteReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent);
 
-    Q_INVOKABLE void respond();
+    Q_INVOKABLE virtual void respond();
 
     void abort() override { }
     qint64 readData(char *, qint64) override { return 0; }
@@ -397,10 +417,25 @@ class FakeMoveReply : public FakeReply
 public:
     FakeMoveReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent);
 
+    Q_INVOKABLE virtual void respond();
+
+    void abort() override { }
+    qint64 readData(char *, qint64) override { return 0; }
+};
+
+class FakeCopyReply : public FakeReply
+{
+    Q_OBJECT
+
+public:
+    FakeCopyReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent);
+
     Q_INVOKABLE void respond();
 
     void abort() override { }
     qint64 readData(char *, qint64) override { return 0; }
+
+    FileInfo *fileInfo;
 };
 
 class FakeGetReply : public FakeReply
@@ -538,6 +573,9 @@ private:
     QHash<QString, int> _errorPaths;
     // monitor requests and optionally provide custom replies
     Override _override;
+    // the remote state for each sync token that was handed out
+    QHash<QByteArray, FileInfo> _syncTokenSnapshots;
+    bool _syncCollectionEnabled = false;
 
 public:
     FakeAM(FileInfo initialRoot);
@@ -548,6 +586,14 @@ public:
 
     void setOverride(const Override &override) { _override = override; }
 
+    /// Report sync tokens on the root and answer sync-collection REPORTs
+    void setSyncCollectionEnabled(bool enabled) { _syncCollectionEnabled = enabled; }
+    /// Forget all sync tokens that were handed out, like a server would after a while
+    void expireSyncTokens() { _syncTokenSnapshots.clear(); }
+
+    /// Remember the current remote state and return a token for it
+    QByteArray createSyncToken();
+
 protected:
     QNetworkReply *createRequest(Operation op, const QNetworkRequest &request,
         QIODevice *outgoingData = nullptr) override;
@@ -615,6 +661,10 @@ public:
     ErrorList serverErrorPaths() { return { _fakeAm }; }
     void setServerOverride(const FakeAM::Override &override) { _fakeAm->setOverride(override); }
 
+    /// Let the server announce and answer sync-collection REPORTs, resets the capabilities
+    void enableSyncCollection();
+    void expireSyncTokens() { _fakeAm->expireSyncTokens(); }
+
     QString localPath() const;
 
     void scheduleSync();
@@ -123,6 +123,79 @@ private slots:
         QVERIFY(_subdirs.size() == 1);
     }
 
+    void testParserChunked_data()
+    {
+        QTest::addColumn<int>("chunkSize");
+        for (int chunkSize : { 1, 7, 64, 1000 }) {
+            QTest::newRow(QByteArray::number(chunkSize).constData()) << chunkSize;
+        }
+    }
+
+    void testParserChunked() {
+        QFETCH(int, chunkSize);
+        const QByteArray testXml = "<?xml version='1.0' encoding='utf-8'?>"
+              "<d:multistatus xmlns:d=\"DAV:\" xmlns:oc=\"http://owncloud.org/ns\">"
+              "<d:response>"
+              "<d:href>/oc/remote.php/webdav/sharefolder/</d:href>"
+              "<d:propstat>"
+              "<d:prop>"
+              "<oc:size>121780</oc:size>"
+              "<d:getetag>\"5527beb0400b0\"</d:getetag>"
+              "<d:resourcetype><d:collection/></d:resourcetype>"
+              "</d:prop>"
+              "<d:status>HTTP/1.1 200 OK</d:status>"
+              "</d:propstat>"
+              "</d:response>"
+              "<d:response>"
+              "<d:href>/oc/remote.php/webdav/sharefolder/response>.pdf</d:href>"
+              "<d:propstat>"
+              "<d:prop>"
+              "<d:getetag>\"2fa2f0d9ed49ea0c3e409d49e652dea0\"</d:getetag>"
+              "<d:resourcetype/>"
+              "<d:getcontentlength>121780</d:getcontentlength>"
+              "</d:prop>"
+              "<d:status>HTTP/1.1 200 OK</d:status>"
+              "</d:propstat>"
+              "</d:response>"
+              "<response xmlns=\"DAV:\">"
+              "<href>/oc/remote.php/webdav/sharefolder/sub</href>"
+              "<propstat>"
+              "<prop>"
+              "<getetag>\"5527beb0400b1\"</getetag>"
+              "<resourcetype><collection/></resourcetype>"
+              "</prop>"
+              "<status>HTTP/1.1 200 OK</status>"
+              "</propstat>"
+              "</response>"
+              "</d:multistatus>";
+
+        LsColXMLParser parser;
+
+        connect(&parser, &LsColXMLParser::directoryListingSubfolders,
+            this, &TestXmlParse::slotDirectoryListingSubFolders);
+        connect(&parser, &LsColXMLParser::directoryListingIterated,
+            this, &TestXmlParse::slotDirectoryListingIterated);
+        connect(&parser, &LsColXMLParser::finishedWithoutError,
+            this, &TestXmlParse::slotFinishedSuccessfully);
+
+        QHash <QString, qint64> sizes;
+        parser.begin(&sizes, "/oc/remote.php/webdav/sharefolder");
+        for (int i = 0; i < testXml.size(); i += chunkSize) {
+            QVERIFY(parser.addData(testXml.mid(i, chunkSize)));
+            // entries are reported before the document is complete
+            if (i > testXml.indexOf("</d:response>") + 13) {
+                QVERIFY(!_items.isEmpty());
+            }
+        }
+        QVERIFY(!_success);
+        QVERIFY(parser.finish());
+
+        QVERIFY(_success);
+        QCOMPARE(sizes.size(), 1);
+        QCOMPARE(_items, QStringList({ "/oc/remote.php/webdav/sharefolder", "/oc/remote.php/webdav/sharefolder/response>.pdf", "/oc/remote.php/webdav/sharefolder/sub" }));
+        QCOMPARE(_subdirs, QStringList({ "/oc/remote.php/webdav/sharefolder/", "/oc/remote.php/webdav/sharefolder/sub" }));
+    }
+
     void testParserBrokenXml() {
         const QByteArray testXml = "X<?xml version='1.0' encoding='utf-8'?>"
               "<d:multistatus xmlns:d=\"DAV:\" xmlns:s=\"http://sabredav.org/ns\" xmlns:oc=\"http://owncloud.org/ns\">"